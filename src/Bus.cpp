@@ -1,29 +1,66 @@
 #include "Bus.h"
 #include "Cache.h"
-#include "Simulator.h"
+#include "MemoryController.h"
+#include "Trace.h"
+#include "Checkpoint.h"
+#include "LatencyHistogram.h"
 #include <iostream>
 #include <iomanip>
 #include <vector>
 #include <algorithm>
 
-Bus::Bus(int blockSize) : 
-    busy(false), 
-    busyUntilCycle(0), 
+Bus::Bus(int blockSize, int numSlices, SliceHashFunction hash) : 
+    Interconnect(blockSize),
+    sliceHash(hash),
     roundRobinArbiter(0), // This is no longer used for arbitration, but keeping for compatibility
-    blockSizeBytes(1 << blockSize),
-    totalDataTrafficBytes(0),
-    totalBusTransactions(0) {
-    DEBUG_PRINT("Bus initialized with block size: " << blockSizeBytes << " bytes");
-    DEBUG_PRINT("Memory latency set to: " << memoryLatency << " cycles");
-    DEBUG_PRINT("Using fixed priority arbitration (Core 0 highest, Core 3 lowest)");
+    coalesceReads(false),
+    coalescedRequests(0),
+    coalescingCyclesSaved(0),
+    memoryFillPolicy(FillPolicy::Full),
+    cacheFillPolicy(FillPolicy::Full),
+    memoryEarlyRestarts(0),
+    memoryEarlyRestartCyclesSaved(0),
+    cacheEarlyRestarts(0),
+    cacheEarlyRestartCyclesSaved(0) {
+    if (numSlices < 1) {
+        numSlices = 1;
+    }
+    
+    // Value-initialized slices start idle with zeroed statistics
+    slices.assign(numSlices, BusSlice());
+    
+    TRACE(BusInit, blockSizeBytes);
+    TRACE(BusMemoryLatency, memoryLatency);
+    TRACE(BusArbitration);
+    TRACE(BusSliceSetup, numSlices, sliceHash == SliceHashFunction::XorFold ? "xor-fold" : "modulo");
 }
 
-void Bus::addCache(Cache* cache) {
-    caches.push_back(cache);
-    DEBUG_PRINT("Added cache " << cache->getId() << " to bus");
+void Bus::setReadCoalescing(bool enabled) {
+    coalesceReads = enabled;
 }
 
-void Bus::pushRequest(int requesterId, BusRequestType type, address_t address, cycle_t currentCycle) {
+void Bus::setFillPolicy(FillPolicy memoryPolicy, FillPolicy cachePolicy) {
+    memoryFillPolicy = memoryPolicy;
+    cacheFillPolicy = cachePolicy;
+}
+
+void Bus::enqueueRequest(int requesterId, BusRequestType type, address_t address, cycle_t currentCycle) {
+    int sliceIndex = getSliceIndex(address);
+    BusSlice& slice = slices[sliceIndex];
+    
+    // A read of a block that is already being read picks up the same response
+    GrantedTransaction* read = type == BusRequestType::BusRd ?
+        findReadToJoin(slice, requesterId, address, currentCycle) : nullptr;
+    if (read != nullptr) {
+        read->coalescedRequesters.push_back(requesterId);
+        markGranted(requesterId, read->transaction);
+        coalescedRequests++;
+        coalescingCyclesSaved += 2 * (blockSizeBytes / 4);
+        
+        TRACE(BusReadJoined, currentCycle, requesterId, address, read->transaction.requesterId);
+        return;
+    }
+    
     // Create a new transaction and add it to the queue
     // This should always add to the queue, even if the bus is busy
     BusTransaction transaction;
@@ -34,153 +71,457 @@ void Bus::pushRequest(int requesterId, BusRequestType type, address_t address, c
     transaction.completionCycle = 0; // Will be calculated later
     transaction.dataReady = false;
     transaction.servedByCache = false;
+    transaction.priority = BusRequestPriority::NORMAL;
 
-    requestQueue.push_back(transaction);
+    // Route the request to the slice that owns this block
+    slice.requestQueue.push_back(transaction);
+    if (type != BusRequestType::WriteBack) {
+        requestProgress[requesterId].resource = sliceIndex;
+    }
     
-    DEBUG_PRINT("Cycle " << currentCycle << ": Core " << requesterId 
-                << " pushed " << getBusRequestTypeString(type) << " request for address 0x" 
-                << std::hex << address << std::dec 
-                << " to bus queue (queue size: " << requestQueue.size() << ")");
+    TRACE(BusRequestQueued, currentCycle, requesterId, type, address, getSliceIndex(address),
+          slice.requestQueue.size());
 }
 
-size_t Bus::getQueueSize() const {
-    return requestQueue.size();
+bool Bus::isBehindWriteBack(int resource, int requesterId) const {
+    const BusSlice& slice = slices[resource];
+    if (slice.busy) {
+        return slice.current.transaction.type == BusRequestType::WriteBack &&
+               slice.current.transaction.requesterId != requesterId;
+    }
+    
+    // On the split-transaction slice, the request waits while its block is written back to DRAM
+    for (const BusTransaction& pending : slice.requestQueue) {
+        if (pending.requesterId != requesterId || pending.type == BusRequestType::WriteBack) {
+            continue;
+        }
+        for (const GrantedTransaction& access : slice.memoryAccesses) {
+            if (access.transaction.type == BusRequestType::WriteBack &&
+                access.transaction.requesterId != requesterId && isSameBlock(access.transaction.address, pending.address)) {
+                return true;
+            }
+        }
+        return false;
+    }
+    return false;
 }
 
-size_t Bus::findHighestPriorityRequest() const {
-    // Skip this if there's only one request in the queue
-    if (requestQueue.size() == 1) {
-        return 0;
+bool Bus::hasMemoryAccess(const BusSlice& slice, address_t address) const {
+    for (const GrantedTransaction& access : slice.memoryAccesses) {
+        if (isSameBlock(access.transaction.address, address)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Bus::isSameBlock(address_t a, address_t b) const {
+    return (a >> blockOffsetBits) == (b >> blockOffsetBits);
+}
+
+Bus::GrantedTransaction* Bus::findReadToJoin(BusSlice& slice, int requesterId, address_t address,
+                                             cycle_t currentCycle) {
+    if (!coalesceReads) {
+        return nullptr;
+    }
+    if (slice.busy && canJoinRead(slice, slice.current, requesterId, address, currentCycle)) {
+        return &slice.current;
+    }
+    for (GrantedTransaction& access : slice.memoryAccesses) {
+        if (canJoinRead(slice, access, requesterId, address, currentCycle)) {
+            return &access;
+        }
+    }
+    return nullptr;
+}
+
+bool Bus::canJoinRead(const BusSlice& slice, const GrantedTransaction& granted, int requesterId,
+                      address_t address, cycle_t currentCycle) const {
+    const BusTransaction& current = granted.transaction;
+    if (current.type != BusRequestType::BusRd || current.requesterId == requesterId ||
+        !isSameBlock(current.address, address)) {
+        return false;
     }
     
-    // Phase 1: Group requests by type and find highest priority type
-    BusRequestType highestPriority = BusRequestType::None;
-    for (const auto& req : requestQueue) {
-        if (static_cast<int>(req.type) > static_cast<int>(highestPriority)) {
-            highestPriority = req.type;
+    // The reader can only pick up the block before it starts streaming on the bus:
+    // a cache-to-cache transfer starts at grant, a memory response in its last 2N cycles
+    if (!granted.waitingForMemory) {
+        cycle_t transferCycles = 2 * (blockSizeBytes / 4);
+        if (current.servedByCache || currentCycle + transferCycles > current.completionCycle) {
+            return false;
         }
     }
     
-    // Phase 2: Collect all request indices with the highest priority type
-    std::vector<size_t> sameTypeIndices;
-    for (size_t i = 0; i < requestQueue.size(); i++) {
-        if (requestQueue[i].type == highestPriority) {
-            sameTypeIndices.push_back(i);
+    // A queued write to the block must be ordered before any later read of it
+    for (const BusTransaction& pending : slice.requestQueue) {
+        if ((pending.type == BusRequestType::BusRdX || pending.type == BusRequestType::InvalidateSig) &&
+            isSameBlock(pending.address, address)) {
+            return false;
         }
     }
     
-    // If only one request of highest priority, return its index
-    if (sameTypeIndices.size() == 1) {
-        return sameTypeIndices[0];
+    return true;
+}
+
+void Bus::coalesceQueuedReads(cycle_t currentCycle, BusSlice& slice) {
+    // Arbitration only grants a BusRd when no BusRdX/InvalidateSig is queued on the slice,
+    // so every queued BusRd for the block can share this response without reordering a write
+    const BusTransaction& current = slice.current.transaction;
+    for (size_t i = 0; i < slice.requestQueue.size(); ) {
+        const BusTransaction& pending = slice.requestQueue[i];
+        if (pending.type == BusRequestType::BusRd && isSameBlock(pending.address, current.address)) {
+            slice.current.coalescedRequesters.push_back(pending.requesterId);
+            coalescedRequests++;
+            coalescingCyclesSaved += 2 * (blockSizeBytes / 4);
+            
+            TRACE(BusQueuedReadCoalesced, currentCycle, pending.requesterId, pending.address,
+                  current.requesterId);
+            
+            slice.requestQueue.erase(slice.requestQueue.begin() + i);
+        } else {
+            i++;
+        }
+    }
+}
+
+void Bus::scheduleEarlyRestart(cycle_t currentCycle, GrantedTransaction& granted) {
+    const BusTransaction& transaction = granted.transaction;
+    if (transaction.type != BusRequestType::BusRd && transaction.type != BusRequestType::BusRdX) {
+        return;
     }
     
-    // Phase 3: Apply fixed priority scheme - lower core ID always gets higher priority
+    FillPolicy policy = transaction.servedByCache ? cacheFillPolicy : memoryFillPolicy;
+    if (policy == FillPolicy::Full) {
+        return;
+    }
+    
+    // Position of the requested word in the transfer order; the last word arrives at completion
+    int wordsPerBlock = std::max(1, blockSizeBytes / 4);
+    int word = static_cast<int>(transaction.address & (blockSizeBytes - 1)) / 4;
+    int position = (policy == FillPolicy::CriticalWordFirst) ? 0 : word;
+    cycle_t arrivalCycle = transaction.completionCycle - 2 * (wordsPerBlock - 1 - position);
+    
+    if (arrivalCycle < transaction.completionCycle) {
+        granted.earlyRestartCycle = std::max(arrivalCycle, currentCycle);
+    }
+}
+
+void Bus::notifyRequesterEarly(cycle_t currentCycle, GrantedTransaction& granted) {
+    const BusTransaction& transaction = granted.transaction;
     
-    // Store requester IDs and their corresponding queue indices
-    std::vector<std::pair<int, size_t>> requesterIndices;
-    for (size_t i = 0; i < sameTypeIndices.size(); i++) {
-        size_t queueIdx = sameTypeIndices[i];
-        requesterIndices.push_back({requestQueue[queueIdx].requesterId, queueIdx});
+    // Same final state as at completion (coalesced readers join before the transfer starts)
+    CacheLineState newState;
+    if (transaction.type == BusRequestType::BusRdX) {
+        newState = CacheLineState::MODIFIED;
+    } else if (transaction.servedByCache || !granted.coalescedRequesters.empty()) {
+        newState = CacheLineState::SHARED;
+    } else {
+        newState = CacheLineState::EXCLUSIVE;
     }
     
-    // Sort by requester ID to get the lowest core ID (highest priority)
-    std::sort(requesterIndices.begin(), requesterIndices.end());
+    FillPolicy policy = transaction.servedByCache ? cacheFillPolicy : memoryFillPolicy;
+    caches[transaction.requesterId]->notifyEarlyRestart(currentCycle, transaction.address, newState,
+        transaction.completionCycle, policy == FillPolicy::CriticalWordFirst);
+    granted.requesterNotified = true;
+    
+    cycle_t saved = transaction.completionCycle - currentCycle;
+    if (transaction.servedByCache) {
+        cacheEarlyRestarts++;
+        cacheEarlyRestartCyclesSaved += saved;
+    } else {
+        memoryEarlyRestarts++;
+        memoryEarlyRestartCyclesSaved += saved;
+    }
     
-    // Return the index of the request from the core with the lowest ID
-    return requesterIndices[0].second;
+    TRACE(BusEarlyRestart, currentCycle, transaction.requesterId, transaction.address, saved);
 }
 
-void Bus::tick(cycle_t currentCycle) {
-    // If there's an ongoing transaction, check if it's complete
-    if (busy && currentCycle >= busyUntilCycle) {
-        DEBUG_PRINT("Cycle " << currentCycle << ": Bus transaction completed for Core " 
-                    << currentTransaction.requesterId << ", addr: 0x" 
-                    << std::hex << currentTransaction.address << std::dec 
-                    << ", type: " << getBusRequestTypeString(currentTransaction.type) 
-                    << ", served by cache: " << (currentTransaction.servedByCache ? "yes" : "no"));
-                  
-        // Current transaction is complete
-        notifyRequester(currentCycle, currentTransaction);
-        busy = false;
-    }
-    
-    // If bus is free and there are pending requests, start a new transaction
-    if (!busy && !requestQueue.empty()) {
-        // Find highest priority request
-        size_t bestIndex = findHighestPriorityRequest();
-        
-        // Process that request
-        currentTransaction = requestQueue[bestIndex];
-        requestQueue.erase(requestQueue.begin() + bestIndex);
-        
-        // Broadcast to all caches except requester
-        bool suppliedByCache = broadcastSnoop(currentCycle, currentTransaction);
-        
-        // Calculate completion time
-        cycle_t completionCycle = calculateCompletionTime(currentCycle, currentTransaction, suppliedByCache);
-        
-        currentTransaction.completionCycle = completionCycle;
-        currentTransaction.servedByCache = suppliedByCache;
-        
-        // Set bus state
-        busy = true;
-        busyUntilCycle = completionCycle;
-        // Only count non-WriteBack operations as bus transactions
-        if (currentTransaction.type != BusRequestType::WriteBack) {
-            totalBusTransactions++;
+void Bus::saveState(CheckpointWriter& writer) const {
+    Interconnect::saveState(writer);
+    writer.write(roundRobinArbiter);
+    writer.write(coalescedRequests);
+    writer.write(coalescingCyclesSaved);
+    writer.write(memoryEarlyRestarts);
+    writer.write(memoryEarlyRestartCyclesSaved);
+    writer.write(cacheEarlyRestarts);
+    writer.write(cacheEarlyRestartCyclesSaved);
+    
+    writer.write<uint64_t>(slices.size());
+    for (const BusSlice& slice : slices) {
+        writer.writeTransactions(slice.requestQueue);
+        writer.write(slice.busy);
+        saveGranted(writer, slice.current);
+        writer.write<uint64_t>(slice.memoryAccesses.size());
+        for (const GrantedTransaction& access : slice.memoryAccesses) {
+            saveGranted(writer, access);
         }
-        
-        // Update data traffic statistics
-        // All transactions that involve data transfers should be counted:
-        // 1. BusRd: Data transfer from memory or another cache
-        // 2. BusRdX: Data transfer from memory or another cache 
-        // 3. WriteBack: Data transfer from cache to memory
-        if (currentTransaction.type == BusRequestType::BusRd ||
-            currentTransaction.type == BusRequestType::BusRdX ||
-            currentTransaction.type == BusRequestType::WriteBack) {
-            totalDataTrafficBytes += blockSizeBytes;
-            
-            DEBUG_PRINT("Cycle " << currentCycle << ": Incrementing data traffic by " 
-                        << blockSizeBytes << " bytes for " 
-                        << getBusRequestTypeString(currentTransaction.type)
-                        << ", total now: " << totalDataTrafficBytes << " bytes");
+        writer.write(slice.busyCycles);
+        writer.write(slice.transactions);
+        writer.write(slice.dataTrafficBytes);
+    }
+}
+
+void Bus::loadState(CheckpointReader& reader) {
+    Interconnect::loadState(reader);
+    reader.read(roundRobinArbiter);
+    reader.read(coalescedRequests);
+    reader.read(coalescingCyclesSaved);
+    reader.read(memoryEarlyRestarts);
+    reader.read(memoryEarlyRestartCyclesSaved);
+    reader.read(cacheEarlyRestarts);
+    reader.read(cacheEarlyRestartCyclesSaved);
+    
+    reader.expect<uint64_t>(slices.size(), "number of bus slices");
+    for (BusSlice& slice : slices) {
+        reader.readTransactions(slice.requestQueue);
+        reader.read(slice.busy);
+        loadGranted(reader, slice.current);
+        slice.memoryAccesses.resize(reader.readSize());
+        for (GrantedTransaction& access : slice.memoryAccesses) {
+            loadGranted(reader, access);
         }
-        
-        DEBUG_PRINT("Cycle " << currentCycle << ": Bus started transaction for Core " 
-                    << currentTransaction.requesterId << ", addr: 0x" 
-                    << std::hex << currentTransaction.address << std::dec 
-                    << ", type: " << getBusRequestTypeString(currentTransaction.type) 
-                    << ", will complete at cycle " << completionCycle 
-                    << " (latency: " << (completionCycle - currentCycle) << " cycles)"
-                    << ", served by cache: " << (suppliedByCache ? "yes" : "no"));
+        reader.read(slice.busyCycles);
+        reader.read(slice.transactions);
+        reader.read(slice.dataTrafficBytes);
     }
 }
 
-bool Bus::broadcastSnoop(cycle_t currentCycle, const BusTransaction& transaction) {
-    bool suppliedByCache = false;
+void Bus::saveGranted(CheckpointWriter& writer, const GrantedTransaction& granted) const {
+    writer.writeTransaction(granted.transaction);
+    writer.write(granted.grantCycle);
+    writer.write(granted.waitingForMemory);
+    writer.write(granted.memoryTicket);
+    writer.writeVector(granted.coalescedRequesters);
+    writer.write(granted.earlyRestartCycle);
+    writer.write(granted.requesterNotified);
+    writer.writeVector(granted.loggedChanges);
+}
+
+void Bus::loadGranted(CheckpointReader& reader, GrantedTransaction& granted) {
+    granted.transaction = reader.readTransaction();
+    reader.read(granted.grantCycle);
+    reader.read(granted.waitingForMemory);
+    reader.read(granted.memoryTicket);
+    reader.readVector(granted.coalescedRequesters);
+    reader.read(granted.earlyRestartCycle);
+    reader.read(granted.requesterNotified);
+    reader.readVector(granted.loggedChanges);
+}
+
+size_t Bus::getQueueSize() const {
+    size_t total = 0;
+    for (const BusSlice& slice : slices) {
+        total += slice.requestQueue.size();
+    }
+    return total;
+}
+
+int Bus::getSliceIndex(address_t address) const {
+    int numSlices = static_cast<int>(slices.size());
+    if (numSlices == 1) {
+        return 0;
+    }
     
-    DEBUG_PRINT("Cycle " << currentCycle << ": Broadcasting snoop for addr 0x" 
-                << std::hex << transaction.address << std::dec 
-                << ", type: " << getBusRequestTypeString(transaction.type));
+    address_t blockAddress = address >> blockOffsetBits;
     
-    // Send snoop to all caches except requester
-    for (size_t i = 0; i < caches.size(); i++) {
-        if (static_cast<int>(i) != transaction.requesterId) {
-            bool responded = caches[i]->snoop(currentCycle, transaction.type, transaction.address);
+    if (sliceHash == SliceHashFunction::XorFold) {
+        // Fold the block address into log2(numSlices) bits by XORing successive fields.
+        // Falls back to modulo for non power-of-two slice counts.
+        int foldBits = 0;
+        while ((1 << foldBits) < numSlices) {
+            foldBits++;
+        }
+        if ((1 << foldBits) == numSlices) {
+            address_t folded = 0;
+            while (blockAddress != 0) {
+                folded ^= blockAddress & (numSlices - 1);
+                blockAddress >>= foldBits;
+            }
+            return static_cast<int>(folded);
+        }
+    }
+    
+    return static_cast<int>(blockAddress % numSlices);
+}
+
+size_t Bus::findHighestPriorityRequest(const BusSlice& slice) const {
+    const std::deque<BusTransaction>& requestQueue = slice.requestQueue;
+    
+    // Single pass: highest request type first, then the lowest core ID (fixed priority).
+    // Keeps arbitration linear in the queue length however many cores are attached.
+    // A block whose DRAM access is still in flight stays ordered behind it.
+    size_t bestIndex = requestQueue.size();
+    for (size_t i = 0; i < requestQueue.size(); i++) {
+        const BusTransaction& candidate = requestQueue[i];
+        if (!slice.memoryAccesses.empty() && hasMemoryAccess(slice, candidate.address)) {
+            continue;
+        }
+        if (bestIndex == requestQueue.size()) {
+            bestIndex = i;
+            continue;
+        }
+        const BusTransaction& best = requestQueue[bestIndex];
+        int candidateType = static_cast<int>(candidate.type);
+        int bestType = static_cast<int>(best.type);
+        
+        if (candidateType > bestType ||
+            (candidateType == bestType && candidate.requesterId < best.requesterId)) {
+            bestIndex = i;
+        }
+    }
+    
+    return bestIndex;
+}
+
+void Bus::tick(cycle_t currentCycle) {
+    // The shared DRAM controller schedules requests granted in earlier cycles
+    if (memoryController != nullptr) {
+        memoryController->tick(currentCycle);
+    }
+    
+    // Slices are independent: each one completes and grants its own transactions
+    for (BusSlice& slice : slices) {
+        tickSlice(currentCycle, slice);
+    }
+}
+
+void Bus::tickSlice(cycle_t currentCycle, BusSlice& slice) {
+    // Released DRAM accesses finish once the controller has scheduled their data (in grant order)
+    if (!slice.memoryAccesses.empty()) {
+        size_t kept = 0;
+        for (size_t i = 0; i < slice.memoryAccesses.size(); i++) {
+            GrantedTransaction& access = slice.memoryAccesses[i];
+            cycle_t memoryDoneCycle = 0;
+            if (access.waitingForMemory && memoryController->takeCompletion(access.memoryTicket, memoryDoneCycle)) {
+                access.waitingForMemory = false;
+                access.transaction.completionCycle = memoryDoneCycle;
+                scheduleEarlyRestart(currentCycle, access);
+            }
             
-            // Set suppliedByCache to true only for BusRd requests when another cache supplies the data
-            // BusRdX should not get data directly from other caches
-            if (responded && transaction.type == BusRequestType::BusRd) {
-                suppliedByCache = true;
-                DEBUG_PRINT("Cycle " << currentCycle << ": Cache " << i 
-                            << " responded to snoop");
-                // In real hardware, we would break here since only one cache can respond,
-                // but for simulation correctness, we want to make sure all caches update their state
+            if (!access.waitingForMemory && advanceFill(currentCycle, access)) {
+                completeTransaction(currentCycle, access);
+            } else if (kept++ != i) {
+                slice.memoryAccesses[kept - 1] = std::move(access);
             }
         }
+        slice.memoryAccesses.resize(kept);
+    }
+    
+    // If there's an ongoing transaction, check if it's complete
+    if (slice.busy && advanceFill(currentCycle, slice.current)) {
+        completeTransaction(currentCycle, slice.current);
+        slice.busy = false;
+    }
+    
+    // If slice is free and there are pending requests, start a new transaction
+    if (slice.busy || slice.requestQueue.empty()) {
+        return;
+    }
+    
+    // Find highest priority request
+    size_t bestIndex = findHighestPriorityRequest(slice);
+    if (bestIndex == slice.requestQueue.size()) {
+        return; // Every queued block waits for its DRAM access
+    }
+    
+    // Process that request
+    GrantedTransaction& granted = slice.current;
+    BusTransaction& currentTransaction = granted.transaction;
+    currentTransaction = slice.requestQueue[bestIndex];
+    slice.requestQueue.erase(slice.requestQueue.begin() + bestIndex);
+    
+    if (coalesceReads && currentTransaction.type == BusRequestType::BusRd) {
+        coalesceQueuedReads(currentCycle, slice);
+    }
+    
+    // Broadcast to all caches except requester
+    bool suppliedByCache = broadcastSnoop(currentCycle, currentTransaction);
+    if (eventLog != nullptr) {
+        granted.loggedChanges.swap(snoopChanges);
     }
     
-    return suppliedByCache;
+    currentTransaction.servedByCache = suppliedByCache;
+    if (currentTransaction.type != BusRequestType::WriteBack) {
+        markGranted(currentTransaction.requesterId, currentTransaction);
+    }
+    for (int requesterId : granted.coalescedRequesters) {
+        markGranted(requesterId, currentTransaction);
+    }
+    granted.grantCycle = currentCycle;
+    granted.earlyRestartCycle = 0;
+    granted.requesterNotified = false;
+    
+    cycle_t completionCycle;
+    if (memoryController != nullptr && needsMemoryAccess(currentTransaction, suppliedByCache)) {
+        // Banked DRAM: the request is handed to the controller and the slice is free again next cycle
+        granted.memoryTicket = memoryController->enqueue(currentTransaction.address,
+            currentTransaction.type == BusRequestType::WriteBack, currentCycle);
+        granted.waitingForMemory = true;
+        completionCycle = currentCycle; // Unknown until the controller issues the request
+        slice.busyCycles++;
+    } else {
+        // Calculate completion time
+        granted.waitingForMemory = false;
+        completionCycle = calculateCompletionTime(currentCycle, currentTransaction, suppliedByCache);
+        slice.busy = true;
+        slice.busyCycles += completionCycle - currentCycle;
+    }
+    currentTransaction.completionCycle = completionCycle;
+    if (!granted.waitingForMemory) {
+        scheduleEarlyRestart(currentCycle, granted);
+    }
+    
+    slice.transactions++;
+    slice.dataTrafficBytes += recordTransaction(currentCycle, currentTransaction);
+    
+    TRACE(BusTransactionStart, currentCycle, currentTransaction.requesterId, currentTransaction.address,
+          currentTransaction.type, granted.waitingForMemory ? ", waiting for DRAM" : "", completionCycle,
+          completionCycle - currentCycle, suppliedByCache ? "yes" : "no");
+    
+    if (granted.waitingForMemory) {
+        slice.memoryAccesses.push_back(std::move(granted));
+        granted.coalescedRequesters.clear();
+        granted.loggedChanges.clear();
+    }
+}
+
+bool Bus::advanceFill(cycle_t currentCycle, GrantedTransaction& granted) {
+    // Restart the requester once its word has arrived; the fill goes on until the last word
+    if (!granted.requesterNotified && granted.earlyRestartCycle != 0 &&
+        currentCycle >= granted.earlyRestartCycle && currentCycle < granted.transaction.completionCycle) {
+        notifyRequesterEarly(currentCycle, granted);
+    }
+    return currentCycle >= granted.transaction.completionCycle;
+}
+
+void Bus::completeTransaction(cycle_t currentCycle, GrantedTransaction& granted) {
+    const BusTransaction& transaction = granted.transaction;
+    TRACE(BusTransactionComplete, currentCycle, transaction.requesterId, transaction.address, transaction.type,
+          transaction.servedByCache ? "yes" : "no");
+    
+    if (eventLog != nullptr) {
+        logTransaction(transaction, granted.grantCycle, granted.loggedChanges, granted.coalescedRequesters);
+    }
+    if (latencyStats != nullptr) {
+        latencyStats->record(transaction, granted.grantCycle);
+    }
+    
+    if (granted.requesterNotified) {
+        // Requester restarted early; only coalesced readers are still waiting
+        for (int requesterId : granted.coalescedRequesters) {
+            caches[requesterId]->notifyTransactionComplete(currentCycle, transaction.address, CacheLineState::SHARED);
+        }
+    } else if (granted.coalescedRequesters.empty()) {
+        notifyRequester(currentCycle, transaction);
+    } else {
+        // Every reader of a coalesced response ends up with a shared copy
+        caches[transaction.requesterId]->notifyTransactionComplete(
+            currentCycle, transaction.address, CacheLineState::SHARED);
+        for (int requesterId : granted.coalescedRequesters) {
+            caches[requesterId]->notifyTransactionComplete(currentCycle, transaction.address, CacheLineState::SHARED);
+        }
+    }
+    granted.coalescedRequesters.clear();
 }
 
 cycle_t Bus::calculateCompletionTime(cycle_t currentCycle, const BusTransaction& transaction, bool suppliedByCache) {
@@ -192,119 +533,143 @@ cycle_t Bus::calculateCompletionTime(cycle_t currentCycle, const BusTransaction&
             // Cache-to-cache transfer: 2N cycles (N words per block)
             int wordsPerBlock = blockSizeBytes / 4; // 4 bytes per word
             latency = 2 * wordsPerBlock;
-            DEBUG_PRINT("Cache-to-cache transfer latency: " << latency 
-                        << " cycles (block size: " << blockSizeBytes 
-                        << " bytes, " << wordsPerBlock << " words)");
+            TRACE(BusCacheTransferLatency, latency, blockSizeBytes, wordsPerBlock);
         } else {
             // Memory access: 100 cycles
             latency = memoryLatency;
-            DEBUG_PRINT("Memory access latency: " << latency << " cycles");
+            TRACE(BusMemoryAccessLatency, latency);
         }
     } else if (transaction.type == BusRequestType::BusRdX) {
         // For BusRdX, always go to memory regardless of whether another cache had it
         // This enforces the protocol rule that write misses always go to memory
         latency = memoryLatency;
-        DEBUG_PRINT("Memory access latency (BusRdX): " << latency << " cycles");
+        TRACE(BusReadExclusiveLatency, latency);
     } else if (transaction.type == BusRequestType::WriteBack) {
         // Writeback to memory: 100 cycles
         latency = memoryLatency;
-        DEBUG_PRINT("WriteBack latency: " << latency << " cycles");
+        TRACE(BusWriteBackLatency, latency);
     } else if (transaction.type == BusRequestType::InvalidateSig) {
         // Invalidation signal: Fixed latency of 10 cycles
         latency = 10;
-        DEBUG_PRINT("InvalidateSig latency: " << latency << " cycles");
+        TRACE(BusInvalidateLatency, latency);
     }
     
     return currentCycle + latency;
 }
 
-void Bus::notifyRequester(cycle_t currentCycle, const BusTransaction& transaction) {
-    // Handle WriteBack case first
-    if (transaction.type == BusRequestType::WriteBack) {
-        // For WriteBack, just need to notify cache that writeback is complete
-        DEBUG_PRINT("Cycle " << currentCycle << ": WriteBack completed for Core " 
-                    << transaction.requesterId);
-                  
-        // For a writeback, we set the state to INVALID to indicate this was a writeback completion
-        // This is a convention between the Bus and Cache classes - writebacks don't update any line's state
-        // but we need to distinguish them from other transactions
-        caches[transaction.requesterId]->notifyTransactionComplete(
-            currentCycle, transaction.address, CacheLineState::INVALID);
-        return;
-    } else if (transaction.type == BusRequestType::InvalidateSig) {
-        // For InvalidateSig, no need to allocate a block or update state
-        // This is a write hit to a shared line, so the state should be modified
-        DEBUG_PRINT("Cycle " << currentCycle << ": InvalidateSig completed for Core "
-                    << transaction.requesterId);
-                    
-        // Set state to MODIFIED since this was a write hit to a shared line
-        caches[transaction.requesterId]->notifyTransactionComplete(
-            currentCycle, transaction.address, CacheLineState::MODIFIED);
-        return;
+std::string Bus::getFillPolicyString(FillPolicy policy) const {
+    switch (policy) {
+        case FillPolicy::Full: return "full block";
+        case FillPolicy::EarlyRestart: return "early restart";
+        case FillPolicy::CriticalWordFirst: return "critical word first";
+        default: return "unknown";
     }
-    
-    // For read/write requests, determine the appropriate new state for the block
-    CacheLineState newState;
-    
-    if (transaction.type == BusRequestType::BusRd) {
-        // If another cache has the block, it goes to Shared
-        // Otherwise, it goes to Exclusive
-        newState = transaction.servedByCache ? 
-            CacheLineState::SHARED : CacheLineState::EXCLUSIVE;
-            
-        DEBUG_PRINT("Cycle " << currentCycle << ": BusRd completed for Core " 
-                    << transaction.requesterId << ", served by cache: " 
-                    << (transaction.servedByCache ? "yes" : "no")
-                    << ", new state: " << getCacheLineStateString(newState));
-    } else if (transaction.type == BusRequestType::BusRdX) {
-        // Always goes to Modified for BusRdX, regardless of whether another cache had it
-        newState = CacheLineState::MODIFIED;
-        
-        DEBUG_PRINT("Cycle " << currentCycle << ": BusRdX completed for Core " 
-                    << transaction.requesterId 
-                    << ", new state: " << getCacheLineStateString(newState));
-    } else {
-        std::cerr << "ERROR: Invalid transaction type in notifyRequester: " 
-                  << static_cast<int>(transaction.type) << std::endl;
-        return;
-    }
-    
-    // Notify the requesting cache
-    caches[transaction.requesterId]->notifyTransactionComplete(
-        currentCycle, transaction.address, newState);
 }
 
-uint64_t Bus::getTotalDataTrafficBytes() const {
-    return totalDataTrafficBytes;
+int Bus::getNumSlices() const {
+    return static_cast<int>(slices.size());
+}
+
+SliceHashFunction Bus::getSliceHash() const {
+    return sliceHash;
+}
+
+uint64_t Bus::getSliceBusyCycles(int slice) const {
+    return slices[slice].busyCycles;
 }
 
-uint64_t Bus::getTotalBusTransactions() const {
-    return totalBusTransactions;
+uint64_t Bus::getSliceTransactions(int slice) const {
+    return slices[slice].transactions;
 }
 
-int Bus::getBlockSizeBytes() const {
-    return blockSizeBytes;
+uint64_t Bus::getSliceDataTrafficBytes(int slice) const {
+    return slices[slice].dataTrafficBytes;
 }
 
-// Helper for debugging
-std::string Bus::getBusRequestTypeString(BusRequestType type) const {
-    switch (type) {
-        case BusRequestType::BusRd: return "BusRd";
-        case BusRequestType::BusRdX: return "BusRdX";
-        case BusRequestType::WriteBack: return "WriteBack";
-        case BusRequestType::InvalidateSig: return "InvalidateSig";
-        case BusRequestType::None: return "None";
-        default: return "Unknown";
+uint64_t Bus::getCoalescedRequests() const {
+    return coalescedRequests;
+}
+
+uint64_t Bus::getCoalescingCyclesSaved() const {
+    return coalescingCyclesSaved;
+}
+
+uint64_t Bus::getEarlyRestartCyclesSaved() const {
+    return memoryEarlyRestartCyclesSaved + cacheEarlyRestartCyclesSaved;
+}
+
+void Bus::printParameters(std::ostream& out) const {
+    out << "Bus Arbitration: Fixed Priority (Core 0 highest, Core " << (caches.size() - 1)
+        << " lowest) with Transaction Priority (BusRdX > BusRd > WriteBack)" << std::endl;
+    if (memoryController == nullptr) {
+        out << "Memory Latency: " << memoryLatency << " cycles" << std::endl;
+    }
+    if (getNumSlices() > 1) {
+        out << "Bus Slices: " << getNumSlices() << " ("
+            << (sliceHash == SliceHashFunction::XorFold ? "XOR-fold" : "modulo")
+            << " hash of block address)" << std::endl;
+    }
+    if (coalesceReads) {
+        out << "Read Coalescing: Enabled" << std::endl;
+    }
+    if (memoryFillPolicy != FillPolicy::Full || cacheFillPolicy != FillPolicy::Full) {
+        out << "Miss Restart (memory / cache-to-cache): " << getFillPolicyString(memoryFillPolicy)
+            << " / " << getFillPolicyString(cacheFillPolicy) << std::endl;
     }
 }
 
-// Helper for debugging
-std::string Bus::getCacheLineStateString(CacheLineState state) const {
-    switch (state) {
-        case CacheLineState::MODIFIED: return "Modified";
-        case CacheLineState::EXCLUSIVE: return "Exclusive";
-        case CacheLineState::SHARED: return "Shared";
-        case CacheLineState::INVALID: return "Invalid";
-        default: return "Unknown";
+void Bus::printStats(std::ostream& out, cycle_t totalCycles) const {
+    if (coalesceReads) {
+        out << std::endl << "Request Coalescing Summary:" << std::endl;
+        out << "Coalesced Read Requests: " << coalescedRequests << std::endl;
+        out << "Coalescing Bus Cycles Saved: " << coalescingCyclesSaved << std::endl;
     }
-} 
+    
+    if (memoryFillPolicy != FillPolicy::Full || cacheFillPolicy != FillPolicy::Full) {
+        uint64_t stalls = 0;
+        uint64_t stallCycles = 0;
+        for (const Cache* cache : caches) {
+            stalls += cache->getPartialFillStalls();
+            stallCycles += cache->getPartialFillStallCycles();
+        }
+        
+        out << std::endl << "Early Restart Summary:" << std::endl;
+        out << "Early Restarts (memory): " << memoryEarlyRestarts << std::endl;
+        out << "Early Restart Cycles Saved (memory): " << memoryEarlyRestartCyclesSaved << std::endl;
+        out << "Early Restarts (cache-to-cache): " << cacheEarlyRestarts << std::endl;
+        out << "Early Restart Cycles Saved (cache-to-cache): " << cacheEarlyRestartCyclesSaved << std::endl;
+        out << "Partial Fill Stalls: " << stalls << std::endl;
+        out << "Partial Fill Stall Cycles: " << stallCycles << std::endl;
+        out << "Net Cycles Saved: " << (static_cast<int64_t>(getEarlyRestartCyclesSaved()) -
+                                        static_cast<int64_t>(stallCycles)) << std::endl;
+    }
+    
+    // Per-slice utilization and load balance for the interleaved interconnect
+    if (getNumSlices() <= 1) {
+        return;
+    }
+    
+    uint64_t maxSliceTransactions = 0;
+    uint64_t sumSliceTransactions = 0;
+    
+    for (int i = 0; i < getNumSlices(); i++) {
+        const BusSlice& slice = slices[i];
+        double utilization = totalCycles == 0 ? 0.0 :
+            std::min(1.0, static_cast<double>(slice.busyCycles) / totalCycles);
+        
+        out << std::endl << "Bus Slice " << i << " Statistics:" << std::endl;
+        out << "Transactions: " << slice.transactions << std::endl;
+        out << "Busy Cycles: " << slice.busyCycles << std::endl;
+        out << "Utilization: " << std::fixed << std::setprecision(2)
+            << (utilization * 100.0) << "%" << std::endl;
+        out << "Data Traffic (Bytes): " << slice.dataTrafficBytes << std::endl;
+        
+        maxSliceTransactions = std::max(maxSliceTransactions, slice.transactions);
+        sumSliceTransactions += slice.transactions;
+    }
+    
+    // Imbalance: busiest slice relative to a perfectly even spread (1.00 = balanced)
+    double meanSliceTransactions = sumSliceTransactions / static_cast<double>(getNumSlices());
+    out << std::endl << "Bus Slice Imbalance (max/mean transactions): " << std::fixed << std::setprecision(2)
+        << (meanSliceTransactions > 0 ? maxSliceTransactions / meanSliceTransactions : 0.0) << std::endl;
+}
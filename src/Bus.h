@@ -5,73 +5,149 @@
 #include <deque>
 #include <string>
 #include "Types.h"
+#include "Interconnect.h"
 
-// Forward declaration of Cache class to avoid circular dependencies
-class Cache;
+// Hash used to map a block address onto a bus slice
+enum class SliceHashFunction {
+    Modulo,  // Low-order block address bits (block address % numSlices)
+    XorFold  // XOR of all block address bit-fields of width log2(numSlices)
+};
+
+// How the requesting core is restarted while a block is transferred.
+// A block streams onto the bus 2 cycles per word, ending at the transaction's completion.
+enum class FillPolicy {
+    Full,              // Restart once the whole block has arrived
+    EarlyRestart,      // Words arrive in order; restart as soon as the requested word arrives
+    CriticalWordFirst  // The requested word is sent first, then the rest wraps around
+};
 
 // Bus class for shared communication between caches
-class Bus {
+class Bus : public Interconnect {
 private:
-    // Transaction structure for bus requests
-    struct BusTransaction {
-        int requesterId;               // ID of requesting cache
-        BusRequestType type;           // Type of request
-        address_t address;             // Memory address
-        cycle_t startCycle;            // Cycle when transaction started
-        cycle_t completionCycle;       // Cycle when transaction will complete
-        bool dataReady;                // Is data ready for the requester?
-        bool servedByCache;            // Was this request served by another cache?
+    // A granted transaction, from its grant until its last word has arrived
+    struct GrantedTransaction {
+        BusTransaction transaction;              // completionCycle: cycle the last word arrives
+        cycle_t grantCycle;                      // Cycle the transaction was granted
+        bool waitingForMemory;                   // Waiting for the DRAM controller to schedule it
+        uint64_t memoryTicket;                   // DRAM request of the transaction
+        std::vector<int> coalescedRequesters;    // Readers sharing the response of a BusRd
+        cycle_t earlyRestartCycle;               // Cycle the requested word arrives (0 = no early restart)
+        bool requesterNotified;                  // Requester already restarted before completion
+        std::vector<uint32_t> loggedChanges;     // Snoop state changes of the transaction (event log)
     };
 
-    std::vector<Cache*> caches;        // Connected caches
-    std::deque<BusTransaction> requestQueue; // Pending requests
-    BusTransaction currentTransaction; // Transaction being processed
-    
-    bool busy;                         // Is bus currently handling a transaction?
-    cycle_t busyUntilCycle;            // Cycle when bus will be free
+    // An independent bus slice with its own queue and arbiter.
+    // Blocks are interleaved across slices by a hash of the block address,
+    // so all traffic for one block is always serialized on the same slice.
+    // With DRAM the slice is split-transaction: a memory access releases it once
+    // handed to the controller, and the fill completes when the controller has scheduled it.
+    struct BusSlice {
+        std::deque<BusTransaction> requestQueue; // Pending requests
+        GrantedTransaction current;              // Transaction holding the slice
+        bool busy;                               // Is slice currently handling a transaction?
+        std::vector<GrantedTransaction> memoryAccesses; // Released DRAM accesses (grant order)
+        
+        // Per-slice statistics
+        uint64_t busyCycles;                     // Cycles spent serving transactions
+        uint64_t transactions;                   // Transactions granted on this slice
+        uint64_t dataTrafficBytes;               // Data transferred on this slice (bytes)
+    };
+
+    std::vector<BusSlice> slices;      // Bus slices (a single slice models the classic shared bus)
+    SliceHashFunction sliceHash;       // Block address to slice mapping
     int roundRobinArbiter;             // Simple arbitration state
+    bool coalesceReads;                // Merge BusRd requests for a block that is already being read
     
-    const int memoryLatency = 100;  // Memory access latency in cycles
-
-    int blockSizeBytes;                // Size of cache block in bytes
+    // Coalescing statistics
+    uint64_t coalescedRequests;        // BusRd requests that piggybacked on another read
+    uint64_t coalescingCyclesSaved;    // Bus cycles the merged requests would have occupied
     
-    // Statistics
-    uint64_t totalDataTrafficBytes;    // Total data transferred on bus (bytes)
-    uint64_t totalBusTransactions;     // Total number of bus transactions
+    // Critical-word-first / early restart, configured per data source
+    FillPolicy memoryFillPolicy;
+    FillPolicy cacheFillPolicy;
+    uint64_t memoryEarlyRestarts;
+    uint64_t memoryEarlyRestartCyclesSaved;
+    uint64_t cacheEarlyRestarts;
+    uint64_t cacheEarlyRestartCyclesSaved;
     
     // Helper methods
-    bool broadcastSnoop(cycle_t currentCycle, const BusTransaction& transaction);
+    void tickSlice(cycle_t currentCycle, BusSlice& slice);
     cycle_t calculateCompletionTime(cycle_t currentCycle, const BusTransaction& transaction, bool suppliedByCache);
-    void notifyRequester(cycle_t currentCycle, const BusTransaction& transaction);
+    
+    // Restart the requester early if its word has arrived; returns true once the last word has arrived
+    bool advanceFill(cycle_t currentCycle, GrantedTransaction& granted);
+    void completeTransaction(cycle_t currentCycle, GrantedTransaction& granted);
+    
+    // Is a released DRAM access of the block still in flight?
+    bool hasMemoryAccess(const BusSlice& slice, address_t address) const;
+    
+    // Request coalescing helpers
+    bool isSameBlock(address_t a, address_t b) const;
+    bool canJoinRead(const BusSlice& slice, const GrantedTransaction& granted, int requesterId,
+                     address_t address, cycle_t currentCycle) const;
+    GrantedTransaction* findReadToJoin(BusSlice& slice, int requesterId, address_t address, cycle_t currentCycle);
+    void coalesceQueuedReads(cycle_t currentCycle, BusSlice& slice);
+    
+    // Early restart helpers
+    void scheduleEarlyRestart(cycle_t currentCycle, GrantedTransaction& granted);
+    void notifyRequesterEarly(cycle_t currentCycle, GrantedTransaction& granted);
+    std::string getFillPolicyString(FillPolicy policy) const;
 
-    size_t findHighestPriorityRequest() const; // Find the highest priority request in the queue
+    // Find the highest priority request in a slice queue; returns the queue size if none can be granted
+    size_t findHighestPriorityRequest(const BusSlice& slice) const;
+    
+    // Checkpointing of one granted transaction
+    void saveGranted(CheckpointWriter& writer, const GrantedTransaction& granted) const;
+    void loadGranted(CheckpointReader& reader, GrantedTransaction& granted);
     
-    // Debug helpers
-    std::string getBusRequestTypeString(BusRequestType type) const;
-    std::string getCacheLineStateString(CacheLineState state) const;
+    // Push a new request to the queue of the slice that owns the block
+    void enqueueRequest(int requesterId, BusRequestType type, address_t address, cycle_t currentCycle) override;
+    
+    // Is the slice, or the block's DRAM access, serving another core's writeback?
+    bool isBehindWriteBack(int resource, int requesterId) const override;
 
 public:
-    // Constructor takes block size in bytes
-    Bus(int blockSize);
+    static const int maxSlices = 64;   // Largest number of slices accepted by --bus-slices
+
+    // Constructor takes block size bits, the number of bus slices and the slice hash
+    Bus(int blockSize, int numSlices = 1, SliceHashFunction hash = SliceHashFunction::Modulo);
     
-    // Register a cache to the bus
-    void addCache(Cache* cache);
+    // Let BusRd requests share the response of an in-flight read of the same block
+    void setReadCoalescing(bool enabled);
     
-    // Push a new request to the bus queue
-    void pushRequest(int requesterId, BusRequestType type, address_t address, cycle_t currentCycle);
+    // Restart policy for blocks supplied by memory and by a peer cache
+    void setFillPolicy(FillPolicy memoryPolicy, FillPolicy cachePolicy);
     
     // Process one cycle of bus activity
-    void tick(cycle_t currentCycle);
+    void tick(cycle_t currentCycle) override;
+    
+    // Get size of request queue (summed over all slices)
+    size_t getQueueSize() const override;
+    
+    // Checkpointing: every slice's queue and current transaction, the arbiter and the statistics
+    void saveState(CheckpointWriter& writer) const override;
+    void loadState(CheckpointReader& reader) override;
+    
+    // Stats output
+    void printParameters(std::ostream& out) const override;
+    void printStats(std::ostream& out, cycle_t totalCycles) const override;
+    
+    // Slice routing: index of the slice that serves the given address
+    int getSliceIndex(address_t address) const;
+    int getNumSlices() const;
+    SliceHashFunction getSliceHash() const;
     
-    // Get size of request queue
-    size_t getQueueSize() const;
+    // Per-slice statistics
+    uint64_t getSliceBusyCycles(int slice) const;
+    uint64_t getSliceTransactions(int slice) const;
+    uint64_t getSliceDataTrafficBytes(int slice) const;
     
-    // Get statistics
-    uint64_t getTotalDataTrafficBytes() const;
-    uint64_t getTotalBusTransactions() const;
+    // Coalescing statistics
+    uint64_t getCoalescedRequests() const;
+    uint64_t getCoalescingCyclesSaved() const;
     
-    // Get block size
-    int getBlockSizeBytes() const;
+    // Early restart statistics
+    uint64_t getEarlyRestartCyclesSaved() const;
 };
 
 #endif // BUS_H 
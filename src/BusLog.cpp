@@ -0,0 +1,241 @@
+#include "BusLog.h"
+#include <cstring>
+#include <stdexcept>
+
+const int BusLogSummary::types;
+const uint64_t BusLog::fileMagic;
+const uint32_t BusLog::fileVersion;
+
+static const size_t bufferBytes = 1 << 16;
+static const size_t fileHeaderBytes = 28;
+static const size_t recordHeaderBytes = 37;
+
+void BusLogSummary::add(const BusLogRecord& record) {
+    int type = static_cast<int>(record.type);
+    if (type < 0 || type >= types) {
+        return;
+    }
+    transactions[type]++;
+    waitCycles[type] += record.grantCycle - record.startCycle;
+    serviceCycles[type] += record.completionCycle - record.grantCycle;
+    servedByCache += record.servedByCache;
+    stateChanges += record.changes.size() - record.joinedReaders;
+    joinedReaders += record.joinedReaders;
+    if (record.completionCycle > lastCompletion) {
+        lastCompletion = record.completionCycle;
+    }
+}
+
+uint64_t BusLogSummary::getTransactions() const {
+    uint64_t total = 0;
+    for (int type = 0; type < types; type++) {
+        total += transactions[type];
+    }
+    return total;
+}
+
+const char* BusLog::getTypeName(BusRequestType type) {
+    switch (type) {
+        case BusRequestType::BusRd: return "BusRd";
+        case BusRequestType::BusRdX: return "BusRdX";
+        case BusRequestType::WriteBack: return "WriteBack";
+        case BusRequestType::InvalidateSig: return "InvalidateSig";
+        case BusRequestType::None: return "None";
+        default: return "Unknown";
+    }
+}
+
+const char* BusLog::getStateName(CacheLineState state) {
+    switch (state) {
+        case CacheLineState::MODIFIED: return "Modified";
+        case CacheLineState::EXCLUSIVE: return "Exclusive";
+        case CacheLineState::SHARED: return "Shared";
+        case CacheLineState::INVALID: return "Invalid";
+        default: return "Unknown";
+    }
+}
+
+// Append a value to a byte buffer in host byte order
+template <typename T>
+static void put(char*& out, T value) {
+    std::memcpy(out, &value, sizeof(value));
+    out += sizeof(value);
+}
+
+template <typename T>
+static T get(const char*& in) {
+    T value;
+    std::memcpy(&value, in, sizeof(value));
+    in += sizeof(value);
+    return value;
+}
+
+BusLogWriter::BusLogWriter() : used(0), records(0), listener(nullptr) {
+}
+
+BusLogWriter::~BusLogWriter() {
+    close();
+}
+
+bool BusLogWriter::open(const std::string& name, int numCores, int s, int E, int b) {
+    close();
+    file.open(name, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        return false;
+    }
+    fileName = name;
+    buffer.assign(bufferBytes, 0);
+    used = 0;
+    records = 0;
+    summary = BusLogSummary();
+
+    char header[fileHeaderBytes];
+    char* out = header;
+    put<uint64_t>(out, BusLog::fileMagic);
+    put<uint32_t>(out, BusLog::fileVersion);
+    put<uint32_t>(out, numCores);
+    put<uint32_t>(out, s);
+    put<uint32_t>(out, E);
+    put<uint32_t>(out, b);
+    file.write(header, out - header);
+    return true;
+}
+
+void BusLogWriter::write(const BusLogRecord& record) {
+    summary.add(record);
+    records++;
+    if (listener != nullptr) {
+        listener->transactionComplete(record);
+    }
+    if (!file.is_open()) {
+        return;
+    }
+
+    size_t bytes = recordHeaderBytes + 4 * record.changes.size();
+    if (used + bytes > buffer.size()) {
+        drain();
+        if (bytes > buffer.size()) {
+            buffer.resize(bytes);
+        }
+    }
+
+    char* out = &buffer[used];
+    put<uint16_t>(out, record.requesterId);
+    put<uint8_t>(out, static_cast<uint8_t>(record.type));
+    put<uint8_t>(out, record.servedByCache ? 1 : 0);
+    put<uint32_t>(out, record.address);
+    put<uint64_t>(out, record.startCycle);
+    put<uint64_t>(out, record.grantCycle);
+    put<uint64_t>(out, record.completionCycle);
+    put<uint8_t>(out, static_cast<uint8_t>(record.requesterState));
+    put<uint16_t>(out, record.joinedReaders);
+    put<uint16_t>(out, record.changes.size());
+    for (uint32_t change : record.changes) {
+        put<uint32_t>(out, change);
+    }
+    used += bytes;
+}
+
+void BusLogWriter::setListener(BusLogListener* listener) {
+    this->listener = listener;
+}
+
+void BusLogWriter::drain() {
+    if (used > 0) {
+        file.write(buffer.data(), static_cast<std::streamsize>(used));
+        used = 0;
+    }
+}
+
+void BusLogWriter::close() {
+    if (file.is_open()) {
+        drain();
+        file.close();
+    }
+}
+
+const std::string& BusLogWriter::getFileName() const {
+    return fileName;
+}
+
+uint64_t BusLogWriter::getRecords() const {
+    return records;
+}
+
+const BusLogSummary& BusLogWriter::getSummary() const {
+    return summary;
+}
+
+BusLogReader::BusLogReader(const std::string& fileName) :
+    file(fileName, std::ios::binary),
+    records(0) {
+    if (!file.is_open()) {
+        throw std::runtime_error("cannot open bus log: " + fileName);
+    }
+
+    char header[fileHeaderBytes];
+    if (!file.read(header, sizeof(header))) {
+        throw std::runtime_error(fileName + " is not a bus log");
+    }
+    const char* in = header;
+    uint64_t magic = get<uint64_t>(in);
+    uint32_t version = get<uint32_t>(in);
+    if (magic != BusLog::fileMagic) {
+        throw std::runtime_error(fileName + " is not a bus log");
+    }
+    if (version != BusLog::fileVersion) {
+        throw std::runtime_error("unsupported bus log version " + std::to_string(version));
+    }
+    numCores = static_cast<int>(get<uint32_t>(in));
+    indexBits = static_cast<int>(get<uint32_t>(in));
+    associativity = static_cast<int>(get<uint32_t>(in));
+    blockBits = static_cast<int>(get<uint32_t>(in));
+}
+
+bool BusLogReader::next(BusLogRecord& record) {
+    char header[recordHeaderBytes];
+    if (!file.read(header, sizeof(header))) {
+        if (file.gcount() != 0) {
+            throw std::runtime_error("bus log is truncated after " + std::to_string(records) + " records");
+        }
+        return false;
+    }
+
+    const char* in = header;
+    record.requesterId = get<uint16_t>(in);
+    record.type = static_cast<BusRequestType>(get<uint8_t>(in));
+    record.servedByCache = (get<uint8_t>(in) & 1) != 0;
+    record.address = get<uint32_t>(in);
+    record.startCycle = get<uint64_t>(in);
+    record.grantCycle = get<uint64_t>(in);
+    record.completionCycle = get<uint64_t>(in);
+    record.requesterState = static_cast<CacheLineState>(get<uint8_t>(in));
+    record.joinedReaders = get<uint16_t>(in);
+    uint16_t changes = get<uint16_t>(in);
+
+    record.changes.resize(changes);
+    if (changes > 0 && !file.read(reinterpret_cast<char*>(record.changes.data()), 4 * changes)) {
+        throw std::runtime_error("bus log is truncated after " + std::to_string(records) + " records");
+    }
+    if (record.joinedReaders > changes) {
+        throw std::runtime_error("bus log record " + std::to_string(records + 1) + " is corrupt");
+    }
+    records++;
+    return true;
+}
+
+int BusLogReader::getNumCores() const {
+    return numCores;
+}
+
+int BusLogReader::getIndexBits() const {
+    return indexBits;
+}
+
+int BusLogReader::getAssociativity() const {
+    return associativity;
+}
+
+int BusLogReader::getBlockBits() const {
+    return blockBits;
+}
@@ -0,0 +1,126 @@
+#ifndef BUS_LOG_H
+#define BUS_LOG_H
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include "Types.h"
+
+// One completed coherence transaction of the bus event log
+struct BusLogRecord {
+    int requesterId;
+    BusRequestType type;
+    address_t address;
+    bool servedByCache;              // Another cache supplied the block
+    cycle_t startCycle;              // Request issued by the cache
+    cycle_t grantCycle;              // Ordered on the bus slice / at the home node (snoops applied)
+    cycle_t completionCycle;         // Requester notified
+    CacheLineState requesterState;   // Requester's state afterwards (Invalid for a writeback)
+    int joinedReaders;               // Coalesced readers, the last entries of changes
+    std::vector<uint32_t> changes;   // Other caches whose line changed state (see BusLog::packChange)
+};
+
+// Totals over a set of records (used by the replay report and the log tool)
+struct BusLogSummary {
+    static const int types = 5;      // Indexed by the BusRequestType value
+
+    uint64_t transactions[types] = {};
+    uint64_t waitCycles[types] = {};     // Start to grant
+    uint64_t serviceCycles[types] = {};  // Grant to completion
+    uint64_t servedByCache = 0;
+    uint64_t stateChanges = 0;           // Snooped caches whose state changed
+    uint64_t joinedReaders = 0;
+    cycle_t lastCompletion = 0;
+
+    void add(const BusLogRecord& record);
+    uint64_t getTransactions() const;    // All types
+};
+
+// Receives each record as the writer takes it (see BusLogWriter::setListener)
+class BusLogListener {
+public:
+    virtual ~BusLogListener() {}
+    virtual void transactionComplete(const BusLogRecord& record) = 0;
+};
+
+// Binary log of every bus transaction. Records are appended at completion into a buffer
+// that is written out in 64 KiB blocks, so logging costs little more than a copy. The
+// writer also keeps a summary of what it saw; one without a file only keeps the summary.
+//
+// File layout: magic, version, number of cores and the cache organization (s, E, b) the
+// run used, then one record per transaction: u16 requester, u8 type, u8 flags (bit 0 =
+// served by a cache), u32 address, u64 start, grant and completion cycles, u8 requester
+// state, u16 joined readers, u16 change count and a u32 per change (cache << 16 | old
+// state << 8 | new state). Values are in host byte order.
+class BusLog {
+public:
+    static const uint64_t fileMagic = 0x474f4c535542314cULL; // "L1BUSLOG" on a little-endian host
+    static const uint32_t fileVersion = 1;
+
+    static uint32_t packChange(int cacheId, CacheLineState oldState, CacheLineState newState) {
+        return (static_cast<uint32_t>(cacheId) << 16) | (static_cast<uint32_t>(oldState) << 8) |
+               static_cast<uint32_t>(newState);
+    }
+    static int getChangeCache(uint32_t change) { return static_cast<int>(change >> 16); }
+    static CacheLineState getChangeOldState(uint32_t change) { return static_cast<CacheLineState>((change >> 8) & 0xff); }
+    static CacheLineState getChangeNewState(uint32_t change) { return static_cast<CacheLineState>(change & 0xff); }
+
+    static const char* getTypeName(BusRequestType type);
+    static const char* getStateName(CacheLineState state);
+};
+
+class BusLogWriter {
+private:
+    std::ofstream file;
+    std::string fileName;
+    std::vector<char> buffer;
+    size_t used;
+    uint64_t records;
+    BusLogSummary summary;
+    BusLogListener* listener;
+
+    void drain();
+
+public:
+    BusLogWriter();
+    ~BusLogWriter();
+
+    // Create the log file; returns false if it cannot be created
+    bool open(const std::string& fileName, int numCores, int s, int E, int b);
+
+    void write(const BusLogRecord& record);
+
+    // Also pass every record to listener (nullptr = none)
+    void setListener(BusLogListener* listener);
+
+    // Flush the buffer and close the file
+    void close();
+
+    const std::string& getFileName() const;
+    uint64_t getRecords() const;
+    const BusLogSummary& getSummary() const;
+};
+
+// Sequential reader; throws std::runtime_error if the file is not a bus log or is truncated
+class BusLogReader {
+private:
+    std::ifstream file;
+    int numCores;
+    int indexBits;
+    int associativity;
+    int blockBits;
+    uint64_t records;
+
+public:
+    explicit BusLogReader(const std::string& fileName);
+
+    // Read the next record; false at the end of the log
+    bool next(BusLogRecord& record);
+
+    int getNumCores() const;
+    int getIndexBits() const;
+    int getAssociativity() const;
+    int getBlockBits() const;
+};
+
+#endif // BUS_LOG_H
@@ -0,0 +1,216 @@
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include "BusLog.h"
+
+// Filter and aggregate a bus event log written by L1simulate --bus-log. Without --summary
+// or --top the matching records are printed one per line.
+
+struct BlockCounts {
+    uint64_t transactions;
+    uint64_t invalidations;  // Snooped copies invalidated by transactions on the block
+};
+
+void printUsage(const char* programName) {
+    std::cout << "Usage: " << programName << " [filters] [--summary] [--top <n>] <logfile>" << std::endl;
+    std::cout << "-c <core>: Transactions requested by this core" << std::endl;
+    std::cout << "-s <core>: Transactions that changed the state of this core's copy" << std::endl;
+    std::cout << "-T <types>: Transactions of these types (BusRd,BusRdX,InvalidateSig,WriteBack)" << std::endl;
+    std::cout << "-a <address>: Transactions on the block holding this address (decimal or 0x hex)" << std::endl;
+    std::cout << "--from <cycle>, --to <cycle>: Transactions granted in this cycle range" << std::endl;
+    std::cout << "--summary: Print totals and average latencies per type and requests per core" << std::endl;
+    std::cout << "--top <n>: Print the n blocks with the most transactions" << std::endl;
+}
+
+static bool parseType(const std::string& name, BusRequestType& type) {
+    const BusRequestType types[] = {BusRequestType::BusRd, BusRequestType::BusRdX,
+                                    BusRequestType::InvalidateSig, BusRequestType::WriteBack};
+    for (BusRequestType candidate : types) {
+        if (name == BusLog::getTypeName(candidate)) {
+            type = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+static void printRecord(std::ostream& out, const BusLogRecord& record) {
+    out << record.grantCycle << " " << BusLog::getTypeName(record.type) << " core " << record.requesterId
+        << " 0x" << std::hex << record.address << std::dec << " start " << record.startCycle << " done "
+        << record.completionCycle << (record.servedByCache ? " from cache" : "") << " -> "
+        << BusLog::getStateName(record.requesterState);
+    for (size_t i = 0; i < record.changes.size(); i++) {
+        uint32_t change = record.changes[i];
+        out << (i == 0 ? "; " : ", ") << "core " << BusLog::getChangeCache(change) << " "
+            << BusLog::getStateName(BusLog::getChangeOldState(change)) << "->"
+            << BusLog::getStateName(BusLog::getChangeNewState(change));
+        if (i >= record.changes.size() - record.joinedReaders) {
+            out << " (joined)";
+        }
+    }
+    out << '\n';
+}
+
+int main(int argc, char* argv[]) {
+    int requester = -1;
+    int snooped = -1;
+    std::vector<BusRequestType> types;
+    bool blockFilter = false;
+    address_t filterAddress = 0;
+    cycle_t fromCycle = 0;
+    cycle_t toCycle = std::numeric_limits<cycle_t>::max();
+    bool summary = false;
+    size_t top = 0;
+    std::string file;
+
+    try {
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            bool hasValue = i + 1 < argc;
+            if (arg == "-c" && hasValue) {
+                requester = std::stoi(argv[++i]);
+            } else if (arg == "-s" && hasValue) {
+                snooped = std::stoi(argv[++i]);
+            } else if (arg == "-T" && hasValue) {
+                std::stringstream list(argv[++i]);
+                std::string name;
+                while (std::getline(list, name, ',')) {
+                    BusRequestType type;
+                    if (!parseType(name, type)) {
+                        std::cerr << "Error: unknown transaction type '" << name << "'" << std::endl;
+                        return 1;
+                    }
+                    types.push_back(type);
+                }
+            } else if (arg == "-a" && hasValue) {
+                filterAddress = static_cast<address_t>(std::stoul(argv[++i], nullptr, 0));
+                blockFilter = true;
+            } else if (arg == "--from" && hasValue) {
+                fromCycle = std::stoull(argv[++i]);
+            } else if (arg == "--to" && hasValue) {
+                toCycle = std::stoull(argv[++i]);
+            } else if (arg == "--summary") {
+                summary = true;
+            } else if (arg == "--top" && hasValue) {
+                top = std::stoul(argv[++i]);
+            } else if (arg == "-h") {
+                printUsage(argv[0]);
+                return 0;
+            } else if (file.empty() && arg[0] != '-') {
+                file = arg;
+            } else {
+                printUsage(argv[0]);
+                return 1;
+            }
+        }
+    } catch (const std::exception&) {
+        std::cerr << "Error: invalid option value" << std::endl;
+        return 1;
+    }
+    if (file.empty()) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    try {
+        BusLogReader reader(file);
+        int blockBits = reader.getBlockBits();
+        bool listRecords = !summary && top == 0;
+
+        BusLogSummary totals;
+        std::vector<uint64_t> coreRequests(reader.getNumCores(), 0);
+        std::unordered_map<address_t, BlockCounts> blocks;
+        std::string text;
+        std::ostringstream line;
+
+        BusLogRecord record;
+        while (reader.next(record)) {
+            if ((requester >= 0 && record.requesterId != requester) ||
+                record.grantCycle < fromCycle || record.grantCycle > toCycle ||
+                (blockFilter && (record.address >> blockBits) != (filterAddress >> blockBits)) ||
+                (!types.empty() && std::find(types.begin(), types.end(), record.type) == types.end())) {
+                continue;
+            }
+            if (snooped >= 0 && std::none_of(record.changes.begin(), record.changes.end(),
+                    [snooped](uint32_t change) { return BusLog::getChangeCache(change) == snooped; })) {
+                continue;
+            }
+
+            if (listRecords) {
+                line.str("");
+                printRecord(line, record);
+                text += line.str();
+                if (text.size() >= (1 << 16)) {
+                    std::cout << text;
+                    text.clear();
+                }
+                continue;
+            }
+            totals.add(record);
+            if (record.requesterId < static_cast<int>(coreRequests.size())) {
+                coreRequests[record.requesterId]++;
+            }
+            if (top > 0) {
+                BlockCounts& counts = blocks[record.address >> blockBits];
+                counts.transactions++;
+                for (size_t i = 0; i + record.joinedReaders < record.changes.size(); i++) {
+                    counts.invalidations += BusLog::getChangeNewState(record.changes[i]) == CacheLineState::INVALID;
+                }
+            }
+        }
+        std::cout << text;
+
+        if (summary) {
+            std::cout << "Transactions: " << totals.getTransactions() << std::endl;
+            const BusRequestType summaryTypes[] = {BusRequestType::BusRd, BusRequestType::BusRdX,
+                                                   BusRequestType::InvalidateSig, BusRequestType::WriteBack};
+            for (BusRequestType type : summaryTypes) {
+                int index = static_cast<int>(type);
+                uint64_t count = totals.transactions[index];
+                std::cout << BusLog::getTypeName(type) << ": " << count;
+                if (count > 0) {
+                    std::cout << " (average wait " << std::fixed << std::setprecision(2)
+                              << static_cast<double>(totals.waitCycles[index]) / count << ", service "
+                              << static_cast<double>(totals.serviceCycles[index]) / count << " cycles)";
+                }
+                std::cout << std::endl;
+            }
+            std::cout << "Served by Cache: " << totals.servedByCache << std::endl;
+            std::cout << "Snoop State Changes: " << totals.stateChanges << std::endl;
+            std::cout << "Coalesced Readers: " << totals.joinedReaders << std::endl;
+            std::cout << "Last Completion: " << totals.lastCompletion << std::endl;
+            for (size_t core = 0; core < coreRequests.size(); core++) {
+                std::cout << "Core " << core << " Requests: " << coreRequests[core] << std::endl;
+            }
+        }
+
+        if (top > 0) {
+            std::vector<std::pair<address_t, BlockCounts>> ranked(blocks.begin(), blocks.end());
+            size_t shown = std::min(top, ranked.size());
+            std::partial_sort(ranked.begin(), ranked.begin() + shown, ranked.end(),
+                [](const std::pair<address_t, BlockCounts>& a, const std::pair<address_t, BlockCounts>& b) {
+                    return a.second.transactions > b.second.transactions ||
+                           (a.second.transactions == b.second.transactions && a.first < b.first);
+                });
+            if (summary) {
+                std::cout << std::endl;
+            }
+            std::cout << "Top Blocks by Transactions:" << std::endl;
+            for (size_t i = 0; i < shown; i++) {
+                std::cout << "0x" << std::hex << (static_cast<uint64_t>(ranked[i].first) << blockBits) << std::dec
+                          << ": " << ranked[i].second.transactions << " transactions, "
+                          << ranked[i].second.invalidations << " invalidations" << std::endl;
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
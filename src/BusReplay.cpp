@@ -0,0 +1,330 @@
+#include "BusReplay.h"
+#include "Trace.h"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <limits>
+#include <stdexcept>
+
+// A replay that makes no progress for this many cycles with requests outstanding is stuck
+static const cycle_t stallLimit = 10000000;
+
+// Request types of the report, and their JSON/CSV keys
+static const BusRequestType reportTypes[] = {BusRequestType::BusRd, BusRequestType::BusRdX,
+                                             BusRequestType::InvalidateSig, BusRequestType::WriteBack};
+static const char* const reportTypeKeys[] = {"busrd", "busrdx", "invalidatesig", "writeback"};
+
+BusReplay::BusReplay(const std::string& logFile, const SimulatorConfig& config, int s, int E, int b) :
+    logFile(logFile),
+    config(config),
+    cycles(0),
+    wallSeconds(0.0) {
+    BusLogReader reader(logFile);
+    numCores = reader.getNumCores();
+    indexBits = s > 0 ? s : reader.getIndexBits();
+    associativity = E > 0 ? E : reader.getAssociativity();
+    blockOffsetBits = b > 0 ? b : reader.getBlockBits();
+    if (numCores <= 0 || indexBits <= 0 || associativity <= 0 || blockOffsetBits <= 0) {
+        throw std::runtime_error("bus log has an invalid cache organization");
+    }
+
+    // Every logged transaction, and every reader that shared a response, was one request
+    streams.assign(numCores, Stream{std::vector<Request>(), 0, 0, false, 0});
+    totalRequests = 0;
+    BusLogRecord record;
+    while (reader.next(record)) {
+        if (record.requesterId >= numCores) {
+            throw std::runtime_error("bus log names core " + std::to_string(record.requesterId) +
+                                     " of " + std::to_string(numCores));
+        }
+        logged.add(record);
+        Request request = {record.startCycle, record.completionCycle, record.address, record.type};
+        streams[record.requesterId].requests.push_back(request);
+        for (size_t i = record.changes.size() - record.joinedReaders; i < record.changes.size(); i++) {
+            Request joined = {record.startCycle, record.completionCycle, record.address, BusRequestType::BusRd};
+            streams[BusLog::getChangeCache(record.changes[i])].requests.push_back(joined);
+        }
+        totalRequests += 1 + record.joinedReaders;
+    }
+
+    // Issue order of the logged run: a fill's writeback is pushed as the fill completes,
+    // before the core issues its next miss
+    for (Stream& stream : streams) {
+        std::stable_sort(stream.requests.begin(), stream.requests.end(), [](const Request& a, const Request& b) {
+            if (a.cycle != b.cycle) {
+                return a.cycle < b.cycle;
+            }
+            return a.type == BusRequestType::WriteBack && b.type != BusRequestType::WriteBack;
+        });
+    }
+
+    interconnect.reset(Simulator::createInterconnect(config, blockOffsetBits, numCores));
+    if (config.dramModel) {
+        memoryController.reset(new MemoryController(blockOffsetBits, config.dram));
+        interconnect->setMemoryController(memoryController.get());
+    }
+
+    replayLog.reset(new BusLogWriter());
+    if (!config.busLogFile.empty() &&
+        !replayLog->open(config.busLogFile, numCores, indexBits, associativity, blockOffsetBits)) {
+        throw std::runtime_error("cannot create bus log: " + config.busLogFile);
+    }
+    interconnect->setEventLog(replayLog.get());
+
+    caches.reserve(numCores);
+    for (int i = 0; i < numCores; i++) {
+        caches.emplace_back(i, indexBits, associativity, blockOffsetBits, interconnect.get());
+        caches.back().setEvictionWritebacks(false);
+        interconnect->addCache(&caches.back());
+    }
+}
+
+cycle_t BusReplay::getDueCycle(const Stream& stream) const {
+    if (stream.waiting || stream.next == stream.requests.size()) {
+        return std::numeric_limits<cycle_t>::max();
+    }
+    int64_t due = static_cast<int64_t>(stream.requests[stream.next].cycle) + stream.delay;
+    return due < 0 ? 0 : static_cast<cycle_t>(due);
+}
+
+uint64_t BusReplay::issue(int core, cycle_t cycle, bool writebacks) {
+    Stream& stream = streams[core];
+    uint64_t pushed = 0;
+    while (getDueCycle(stream) <= cycle) {
+        const Request& request = stream.requests[stream.next];
+        bool writeback = request.type == BusRequestType::WriteBack;
+        if (writeback != writebacks) {
+            break;
+        }
+        if (!writeback) {
+            // The core restarts the cycle after its last miss completed, then stalls on this
+            // one until the interconnect completes it and the cache unblocks
+            if (caches[core].getReadyCycle() > cycle) {
+                break;
+            }
+            caches[core].setBlocked(true);
+            stream.waiting = true;
+            stream.waitingCompletion = request.completionCycle;
+        }
+        interconnect->pushRequest(core, request.type, request.address, cycle);
+        stream.next++;
+        pushed++;
+    }
+    return pushed;
+}
+
+void BusReplay::run() {
+    std::chrono::steady_clock::time_point wallStart = std::chrono::steady_clock::now();
+
+    const BusLogSummary& replayed = replayLog->getSummary();
+    uint64_t issued = 0;
+    cycle_t cycle = 0;
+    cycle_t lastProgress = 0;
+    uint64_t lastCompleted = 0;
+
+    while (true) {
+        uint64_t completed = replayed.getTransactions() + replayed.joinedReaders;
+        if (completed != lastCompleted) {
+            lastCompleted = completed;
+            lastProgress = cycle;
+        }
+        if (completed == issued) {
+            // Nothing outstanding: skip ahead to the next due request
+            cycle_t due = std::numeric_limits<cycle_t>::max();
+            for (const Stream& stream : streams) {
+                due = std::min(due, getDueCycle(stream));
+            }
+            if (due == std::numeric_limits<cycle_t>::max()) {
+                break;
+            }
+            cycle = std::max(cycle, due);
+            lastProgress = cycle;
+        } else if (cycle - lastProgress > stallLimit) {
+            throw std::runtime_error("replay stalled at cycle " + std::to_string(cycle) + " with " +
+                                     std::to_string(issued - completed) + " requests outstanding");
+        }
+
+        interconnect->tick(cycle);
+
+        // A restarted core's later requests move by however much later or earlier its miss
+        // completed than in the logged run
+        for (int i = 0; i < numCores; i++) {
+            Stream& stream = streams[i];
+            if (stream.waiting && !caches[i].isBlocked()) {
+                stream.waiting = false;
+                stream.delay = static_cast<int64_t>(caches[i].getReadyCycle() - 1) -
+                               static_cast<int64_t>(stream.waitingCompletion);
+            }
+        }
+
+        // Writebacks go in while fills complete, then the cores issue in core order
+        for (int i = 0; i < numCores; i++) {
+            issued += issue(i, cycle, true);
+        }
+        for (int i = 0; i < numCores; i++) {
+            issued += issue(i, cycle, false);
+        }
+        cycle++;
+    }
+
+    cycles = cycle;
+    replayLog->close();
+    wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    TRACE(SimulationComplete, cycles);
+}
+
+void BusReplay::printComparison(std::ostream& out, const std::string& label, double loggedValue,
+                                double replayedValue) const {
+    out << label << " (logged / replayed): " << std::fixed << std::setprecision(2) << loggedValue << " / "
+        << replayedValue << std::endl;
+}
+
+double BusReplay::getAverageLatency(const BusLogSummary& summary, BusRequestType type) {
+    int index = static_cast<int>(type);
+    return summary.transactions[index] == 0 ? 0.0 :
+        static_cast<double>(summary.waitCycles[index] + summary.serviceCycles[index]) / summary.transactions[index];
+}
+
+void BusReplay::printReport(std::ostream& out) const {
+    uint64_t blockSize = 1ULL << blockOffsetBits;
+    uint64_t numSets = 1ULL << indexBits;
+
+    out << "Simulation Parameters:" << std::endl;
+    out << "Bus Log: " << logFile << std::endl;
+    out << "Simulation Mode: Replay (logged bus requests, each core's spacing kept, no cores)" << std::endl;
+    if (numCores != 4) {
+        out << "Number of Cores: " << numCores << std::endl;
+    }
+    out << "Set Index Bits: " << indexBits << std::endl;
+    out << "Associativity: " << associativity << std::endl;
+    out << "Block Bits: " << blockOffsetBits << std::endl;
+    out << "Block Size (Bytes): " << blockSize << std::endl;
+    out << "Number of Sets: " << numSets << std::endl;
+    out << "Cache Size (KB per core): " << (numSets * associativity * blockSize / 1024.0) << std::endl;
+    out << "MESI Protocol: Enabled" << std::endl;
+    interconnect->printParameters(out);
+    if (memoryController) {
+        memoryController->printParameters(out);
+    }
+    if (!config.busLogFile.empty()) {
+        out << "Replay Bus Log: " << config.busLogFile << " (" << replayLog->getRecords() << " transactions)"
+            << std::endl;
+    }
+    out << std::endl;
+
+    const BusLogSummary& replayed = replayLog->getSummary();
+    out << "Replay Summary:" << std::endl;
+    out << "Replayed Requests: " << totalRequests << std::endl;
+    out << "Replay Cycles: " << cycles << std::endl;
+    out << "Last Completion (logged / replayed): " << logged.lastCompletion << " / " << replayed.lastCompletion
+        << std::endl;
+    for (BusRequestType type : reportTypes) {
+        int index = static_cast<int>(type);
+        if (logged.transactions[index] == 0 && replayed.transactions[index] == 0) {
+            continue;
+        }
+        std::string name = BusLog::getTypeName(type);
+        out << name << " Transactions (logged / replayed): " << logged.transactions[index] << " / "
+            << replayed.transactions[index] << std::endl;
+        printComparison(out, name + " Average Latency (cycles)", getAverageLatency(logged, type),
+                        getAverageLatency(replayed, type));
+    }
+    out << "Served by Cache (logged / replayed): " << logged.servedByCache << " / " << replayed.servedByCache
+        << std::endl;
+    out << "Snoop State Changes (logged / replayed): " << logged.stateChanges << " / " << replayed.stateChanges
+        << std::endl;
+    out << "Coalesced Readers (logged / replayed): " << logged.joinedReaders << " / " << replayed.joinedReaders
+        << std::endl;
+    out << "Replay Wall Time (s): " << std::fixed << std::setprecision(3) << wallSeconds << std::endl;
+    out << std::endl;
+
+    for (int i = 0; i < numCores; i++) {
+        out << "Core " << i << " Replay Statistics:" << std::endl;
+        out << "Cache Evictions: " << caches[i].getEvictions() << std::endl;
+        out << "Bus Invalidations: " << caches[i].getInvalidationsReceived() << std::endl;
+        out << std::endl;
+    }
+
+    out << "Overall Bus Summary:" << std::endl;
+    out << "Total Bus Transactions: " << interconnect->getTotalBusTransactions() << std::endl;
+    out << "Total Bus Traffic (Bytes): " << interconnect->getTotalDataTrafficBytes() << std::endl;
+    interconnect->printStats(out, cycles);
+    if (memoryController) {
+        memoryController->printStats(out);
+    }
+}
+
+void BusReplay::writeCsv(std::ostream& out) const {
+    out << "num_cores,s,E,b,cache_size_bytes,replayed_requests,replay_cycles,"
+        << "last_completion_logged,last_completion_replayed";
+    for (const char* key : reportTypeKeys) {
+        out << "," << key << "_transactions_logged," << key << "_transactions_replayed,"
+            << key << "_average_latency_logged," << key << "_average_latency_replayed";
+    }
+    out << ",served_by_cache_logged,served_by_cache_replayed,state_changes_logged,state_changes_replayed,"
+        << "coalesced_readers_logged,coalesced_readers_replayed,bus_transactions,bus_traffic_bytes,"
+        << "core,evictions,invalidations" << std::endl;
+
+    const BusLogSummary& replayed = replayLog->getSummary();
+    uint64_t cacheSize = (1ULL << indexBits) * associativity * (1ULL << blockOffsetBits);
+    for (int i = 0; i < numCores; i++) {
+        out << numCores << "," << indexBits << "," << associativity << "," << blockOffsetBits << ","
+            << cacheSize << "," << totalRequests << "," << cycles << ","
+            << logged.lastCompletion << "," << replayed.lastCompletion;
+        for (BusRequestType type : reportTypes) {
+            int index = static_cast<int>(type);
+            out << "," << logged.transactions[index] << "," << replayed.transactions[index] << ","
+                << std::fixed << std::setprecision(6) << getAverageLatency(logged, type) << ","
+                << getAverageLatency(replayed, type);
+        }
+        out << "," << logged.servedByCache << "," << replayed.servedByCache << ","
+            << logged.stateChanges << "," << replayed.stateChanges << ","
+            << logged.joinedReaders << "," << replayed.joinedReaders << ","
+            << interconnect->getTotalBusTransactions() << "," << interconnect->getTotalDataTrafficBytes() << ","
+            << i << "," << caches[i].getEvictions() << "," << caches[i].getInvalidationsReceived() << std::endl;
+    }
+}
+
+void BusReplay::writeJson(std::ostream& out) const {
+    const BusLogSummary& replayed = replayLog->getSummary();
+    out << "{" << std::endl;
+    out << "  \"bus_log\": \"" << logFile << "\"," << std::endl;
+    out << "  \"num_cores\": " << numCores << ", \"s\": " << indexBits << ", \"E\": " << associativity
+        << ", \"b\": " << blockOffsetBits << ", \"cache_size_bytes\": "
+        << ((1ULL << indexBits) * associativity * (1ULL << blockOffsetBits)) << "," << std::endl;
+    out << "  \"replayed_requests\": " << totalRequests << ", \"replay_cycles\": " << cycles
+        << ", \"last_completion_logged\": " << logged.lastCompletion
+        << ", \"last_completion_replayed\": " << replayed.lastCompletion << "," << std::endl;
+    out << "  \"served_by_cache_logged\": " << logged.servedByCache
+        << ", \"served_by_cache_replayed\": " << replayed.servedByCache
+        << ", \"state_changes_logged\": " << logged.stateChanges
+        << ", \"state_changes_replayed\": " << replayed.stateChanges
+        << ", \"coalesced_readers_logged\": " << logged.joinedReaders
+        << ", \"coalesced_readers_replayed\": " << replayed.joinedReaders << "," << std::endl;
+    out << "  \"bus_transactions\": " << interconnect->getTotalBusTransactions()
+        << ", \"bus_traffic_bytes\": " << interconnect->getTotalDataTrafficBytes() << "," << std::endl;
+
+    out << "  \"types\": [" << std::endl;
+    for (size_t t = 0; t < sizeof(reportTypes) / sizeof(reportTypes[0]); t++) {
+        BusRequestType type = reportTypes[t];
+        int index = static_cast<int>(type);
+        out << "    {\"type\": \"" << reportTypeKeys[t] << "\""
+            << ", \"transactions_logged\": " << logged.transactions[index]
+            << ", \"transactions_replayed\": " << replayed.transactions[index]
+            << ", \"average_latency_logged\": " << std::fixed << std::setprecision(6)
+            << getAverageLatency(logged, type)
+            << ", \"average_latency_replayed\": " << getAverageLatency(replayed, type) << "}"
+            << (t + 1 < sizeof(reportTypes) / sizeof(reportTypes[0]) ? "," : "") << std::endl;
+    }
+    out << "  ]," << std::endl;
+
+    out << "  \"cores\": [" << std::endl;
+    for (int i = 0; i < numCores; i++) {
+        out << "    {\"core\": " << i
+            << ", \"evictions\": " << caches[i].getEvictions()
+            << ", \"invalidations\": " << caches[i].getInvalidationsReceived() << "}"
+            << (i + 1 < numCores ? "," : "") << std::endl;
+    }
+    out << "  ]" << std::endl;
+    out << "}" << std::endl;
+}
@@ -0,0 +1,82 @@
+#ifndef BUS_REPLAY_H
+#define BUS_REPLAY_H
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <ostream>
+#include "Types.h"
+#include "BusLog.h"
+#include "Simulator.h"
+
+// Replay of a bus event log. The logged requests are pushed into a fresh interconnect in
+// place of cores running the traces, and the caches take the snoops and fills as usual.
+// Each core's requests keep their logged order and spacing: a core with a miss outstanding
+// issues nothing more, and once it restarts its next requests follow after the same gap as
+// in the logged run. A faster or slower fabric therefore moves each core's later requests
+// earlier or later, as it would have moved the core. The caches only see bus traffic, so
+// hits, silent upgrades and the LRU order of hit lines are not replayed. This re-times the
+// recorded traffic under other interconnect and DRAM options without re-reading the
+// traces, and compares latencies and snoop outcomes with the logged run.
+class BusReplay {
+private:
+    struct Request {
+        cycle_t cycle;            // Logged issue cycle
+        cycle_t completionCycle;  // Logged completion
+        address_t address;
+        BusRequestType type;
+    };
+
+    // One core's logged requests and its progress through them
+    struct Stream {
+        std::vector<Request> requests;
+        size_t next;
+        int64_t delay;            // Replayed minus logged restart of the last completed miss
+        bool waiting;             // A miss is outstanding
+        cycle_t waitingCompletion;
+    };
+
+    std::string logFile;
+    SimulatorConfig config;
+    int numCores;
+    int indexBits;
+    int associativity;
+    int blockOffsetBits;
+
+    std::unique_ptr<BusLogWriter> replayLog;   // Summary of the replayed transactions (and --bus-log)
+    std::unique_ptr<MemoryController> memoryController;
+    std::unique_ptr<Interconnect> interconnect;
+    std::vector<Cache> caches;
+
+    std::vector<Stream> streams;
+    uint64_t totalRequests;
+    BusLogSummary logged;
+    cycle_t cycles;
+    double wallSeconds;
+
+    // Cycle the stream's next request is due, or the largest cycle_t if it cannot issue yet
+    cycle_t getDueCycle(const Stream& stream) const;
+    // Push the stream's due writebacks, or its due miss; returns the requests pushed
+    uint64_t issue(int core, cycle_t cycle, bool writebacks);
+
+    void printComparison(std::ostream& out, const std::string& label, double loggedValue,
+                         double replayedValue) const;
+    
+    // Average start-to-completion latency of a request type in a summary (0 without transactions)
+    static double getAverageLatency(const BusLogSummary& summary, BusRequestType type);
+
+public:
+    // Cache organization from the log unless s, E or b are positive
+    BusReplay(const std::string& logFile, const SimulatorConfig& config, int s, int E, int b);
+
+    void run();
+
+    void printReport(std::ostream& out) const;
+    
+    // Machine-readable report with fixed fields: every request type is listed, whether or not
+    // it occurred. CSV has one row per core with the run's fields repeated.
+    void writeCsv(std::ostream& out) const;
+    void writeJson(std::ostream& out) const;
+};
+
+#endif // BUS_REPLAY_H
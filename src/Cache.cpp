@@ -1,6 +1,9 @@
 #include "Cache.h"
-#include "Bus.h"
-#include "Simulator.h"
+#include "Interconnect.h"
+#include "Trace.h"
+#include "Checkpoint.h"
+#include "MissClassifier.h"
+#include "HotLineTracker.h"
 #include <iostream>
 #include <cmath>
 #include <algorithm>
@@ -20,9 +23,7 @@ void CacheLine::setState(CacheLineState newState) {
     CacheLineState oldState = getState();
     
     if (oldState != newState) {
-        DEBUG_PRINT("Cache line state transition: " 
-                  << cacheLineStateToString(oldState) << " -> " 
-                  << cacheLineStateToString(newState));
+        TRACE(LineStateChange, oldState, newState);
     }
     
     flags.state = static_cast<unsigned>(newState);
@@ -63,6 +64,19 @@ std::string CacheLine::cacheLineStateToString(CacheLineState state) const {
     }
 }
 
+void CacheLine::saveState(CheckpointWriter& writer) const {
+    writer.write(tag);
+    writer.write(lastUsedCycle);
+    writer.write<uint8_t>(flags.state);
+    writer.write<uint8_t>(flags.valid);
+}
+
+void CacheLine::loadState(CheckpointReader& reader) {
+    reader.read(tag);
+    reader.read(lastUsedCycle);
+    flags.state = reader.read<uint8_t>() & 0b11;
+    flags.valid = reader.read<uint8_t>() & 1;
+}
 
 // CacheSet Implementation
 CacheSet::CacheSet(int E) : associativity(E) {
@@ -117,8 +131,36 @@ int CacheSet::getAssociativity() const {
     return associativity;
 }
 
+void CacheSet::saveState(CheckpointWriter& writer) const {
+    for (const CacheLine& line : lines) {
+        line.saveState(writer);
+    }
+    // The table may keep entries of lines that were since invalidated, so it is saved as is
+    writer.write<uint64_t>(tagToLineIndex.size());
+    for (const std::pair<const address_t, int>& entry : tagToLineIndex) {
+        writer.write(entry.first);
+        writer.write(entry.second);
+    }
+}
+
+void CacheSet::loadState(CheckpointReader& reader) {
+    for (CacheLine& line : lines) {
+        line.loadState(reader);
+    }
+    tagToLineIndex.clear();
+    uint64_t entries = reader.readSize();
+    for (uint64_t i = 0; i < entries; i++) {
+        address_t tag = reader.read<address_t>();
+        int index = reader.read<int>();
+        if (index < 0 || index >= associativity) {
+            throw std::runtime_error("checkpoint is corrupt");
+        }
+        tagToLineIndex[tag] = index;
+    }
+}
+
 // Cache Implementation
-Cache::Cache(int id, int s, int E, int b, Bus* bus) 
+Cache::Cache(int id, int s, int E, int b, Interconnect* bus) 
     : id(id), 
       numSets(1 << s), 
       associativity(E), 
@@ -127,7 +169,14 @@ Cache::Cache(int id, int s, int E, int b, Bus* bus)
       blockOffsetBits(b),
       bus(bus),
       blocked(false),
-      readyCycle(0) {
+      readyCycle(0),
+      fillBlockAddress(0),
+      fillFirstWord(0),
+      fillCompleteCycle(0),
+      evictionWritebacks(true),
+      missClassifier(nullptr),
+      hotLines(nullptr),
+      countInteractions(false) {
     
     // Precompute address manipulation masks and shifts
     tagMask = ~((1ULL << (indexBits + blockOffsetBits)) - 1);
@@ -143,10 +192,7 @@ Cache::Cache(int id, int s, int E, int b, Bus* bus)
     }
     
     // Initialize all statistics to zero
-    stats = {0};  // Zero-initialize all fields
-    
-    // Set debug tracking flags
-    stats.trackInvalidationAddresses = (id == 2); // Only track for Core 2 which has the issue
+    stats = {};  // Zero-initialize all fields
 }
 
 bool Cache::access(cycle_t currentCycle, MemOperation op, address_t addr) {
@@ -157,23 +203,29 @@ bool Cache::access(cycle_t currentCycle, MemOperation op, address_t addr) {
     address_t tag = extractTag(addr);
     int setIndex = extractIndex(addr);
     
-    DEBUG_PRINT("Cycle " << currentCycle << ": Cache " << id 
-                << " access, op: " << (op == MemOperation::READ ? "READ" : "WRITE") 
-                << ", addr: 0x" << std::hex << addr << std::dec 
-                << " (tag: 0x" << std::hex << tag << std::dec 
-                << ", set: " << setIndex << ")");
+    TRACE(CacheAccess, currentCycle, id, op == MemOperation::READ ? "READ" : "WRITE", addr, tag, setIndex);
     
     // Look for the block in the cache
     CacheLine* line = sets[setIndex].findLine(tag);
     
+    if (!groupAccesses.empty()) {
+        size_t group = setIndex % groupAccesses.size();
+        groupAccesses[group]++;
+        if (line == nullptr) {
+            groupMisses[group]++;
+        }
+    }
+    if (missClassifier != nullptr) {
+        missClassifier->access(op, addr, line == nullptr);
+    }
+    
     if (line != nullptr) {
         // Cache hit
         stats.hits++;
         
         CacheLineState oldState = line->getState();
         
-        DEBUG_PRINT("Cycle " << currentCycle << ": Cache " << id 
-                    << " HIT, line state: " << getCacheLineStateString(oldState));
+        TRACE(CacheHit, currentCycle, id, oldState);
         
         // Update LRU status
         line->updateLRU(currentCycle);
@@ -181,23 +233,24 @@ bool Cache::access(cycle_t currentCycle, MemOperation op, address_t addr) {
         // Handle based on operation and current state
         if (op == MemOperation::READ) {
             // Read hit - no state change needed
-            return true;
+            return !stallOnPartialFill(currentCycle, addr);
         } else { // Write operation
             if (oldState == CacheLineState::MODIFIED) {
                 // Already in M state - no change needed
-                return true;
+                return !stallOnPartialFill(currentCycle, addr);
             } else if (oldState == CacheLineState::EXCLUSIVE) {
                 // Exclusive -> Modified
-                DEBUG_PRINT("Cycle " << currentCycle << ": Cache " << id 
-                            << " transition E->M on write hit");
+                TRACE(WriteHitExclusive, currentCycle, id);
                 line->setState(CacheLineState::MODIFIED);
-                return true;
+                return !stallOnPartialFill(currentCycle, addr);
             } else if (oldState == CacheLineState::SHARED) {
                 // Shared -> Need to invalidate other copies via InvalidateSig
-                DEBUG_PRINT("Cycle " << currentCycle << ": Cache " << id 
-                            << " write to shared line, need to invalidate other copies");
+                TRACE(WriteHitShared, currentCycle, id);
                 
                 // Issue InvalidateSig to invalidate other copies
+                if (hotLines != nullptr) {
+                    hotLines->touch(id, addr);
+                }
                 blocked = true;
                 bus->pushRequest(id, BusRequestType::InvalidateSig, addr, currentCycle);
                 
@@ -217,8 +270,10 @@ bool Cache::access(cycle_t currentCycle, MemOperation op, address_t addr) {
         // Cache miss
         stats.misses++;
         
-        DEBUG_PRINT("Cycle " << currentCycle << ": Cache " << id 
-                    << " MISS, addr: 0x" << std::hex << addr << std::dec);
+        TRACE(CacheMiss, currentCycle, id, addr);
+        if (hotLines != nullptr) {
+            hotLines->record(HotLineEvent::Miss, id, addr);
+        }
         
         // Handle miss - initiate memory transaction
         handleMiss(currentCycle, op, addr, tag, setIndex);
@@ -226,6 +281,75 @@ bool Cache::access(cycle_t currentCycle, MemOperation op, address_t addr) {
     }
 }
 
+bool Cache::functionalAccess(cycle_t currentCycle, MemOperation op, address_t addr) {
+    stats.accesses++;
+    
+    address_t tag = extractTag(addr);
+    int setIndex = extractIndex(addr);
+    CacheLine* line = sets[setIndex].findLine(tag);
+    if (missClassifier != nullptr) {
+        missClassifier->access(op, addr, line == nullptr);
+    }
+    
+    if (line != nullptr) {
+        stats.hits++;
+        line->updateLRU(currentCycle);
+        
+        if (op == MemOperation::WRITE && line->getState() != CacheLineState::MODIFIED) {
+            // E->M silently; S->M invalidates the other copies first, as the InvalidateSig would
+            if (line->getState() == CacheLineState::SHARED) {
+                if (hotLines != nullptr) {
+                    hotLines->touch(id, addr);
+                }
+                bus->functionalRequest(currentCycle, id, BusRequestType::InvalidateSig, addr);
+            }
+            line->setState(CacheLineState::MODIFIED);
+        }
+        return true;
+    }
+    
+    stats.misses++;
+    if (hotLines != nullptr) {
+        hotLines->record(HotLineEvent::Miss, id, addr);
+    }
+    
+    // Resolve the miss at once: snoop the other caches and install the line in its final state
+    CacheLineState newState;
+    if (op == MemOperation::READ) {
+        bool suppliedByCache = bus->functionalRequest(currentCycle, id, BusRequestType::BusRd, addr);
+        newState = suppliedByCache ? CacheLineState::SHARED : CacheLineState::EXCLUSIVE;
+    } else {
+        bus->functionalRequest(currentCycle, id, BusRequestType::BusRdX, addr);
+        newState = CacheLineState::MODIFIED;
+    }
+    allocateBlock(currentCycle, addr, newState, false);
+    return false;
+}
+
+bool Cache::stallOnPartialFill(cycle_t currentCycle, address_t addr) {
+    if (currentCycle >= fillCompleteCycle || (addr >> blockOffsetBits) != fillBlockAddress) {
+        return false;
+    }
+    
+    // Words arrive 2 cycles apart in wrap-around order, the last one at fillCompleteCycle
+    int wordsPerBlock = std::max(1, blockSize / 4);
+    int word = extractOffset(addr) / 4;
+    int position = (word - fillFirstWord + wordsPerBlock) % wordsPerBlock;
+    cycle_t arrivalCycle = fillCompleteCycle - 2 * (wordsPerBlock - 1 - position);
+    
+    // As after a miss, a word is usable from the cycle after it arrives
+    if (currentCycle > arrivalCycle) {
+        return false;
+    }
+    
+    stats.partialFillStalls++;
+    stats.partialFillStallCycles += arrivalCycle + 1 - currentCycle;
+    readyCycle = arrivalCycle + 1;
+    
+    TRACE(CachePartialFillStall, currentCycle, id, word, readyCycle);
+    return true;
+}
+
 void Cache::handleMiss(cycle_t currentCycle, MemOperation op, address_t addr, address_t tag, int setIndex) {
     // Block cache while handling miss
     blocked = true;
@@ -241,15 +365,13 @@ void Cache::handleMiss(cycle_t currentCycle, MemOperation op, address_t addr, ad
         requestType = BusRequestType::BusRdX;
     }
     
-    DEBUG_PRINT("Cycle " << currentCycle << ": Cache " << id 
-                << " handling miss, issuing " << getBusRequestTypeString(requestType) 
-                << " for addr: 0x" << std::hex << addr << std::dec);
+    TRACE(MissRequest, currentCycle, id, requestType, addr);
     
     // Issue request to the bus
     bus->pushRequest(id, requestType, addr, currentCycle);
 }
 
-void Cache::allocateBlock(cycle_t currentCycle, address_t addr, CacheLineState newState) {
+void Cache::allocateBlock(cycle_t currentCycle, address_t addr, CacheLineState newState, bool issueWriteback) {
     address_t tag = extractTag(addr);
     int setIndex = extractIndex(addr);
     
@@ -257,17 +379,12 @@ void Cache::allocateBlock(cycle_t currentCycle, address_t addr, CacheLineState n
     int victimIndex = sets[setIndex].findLRULine();
     CacheLine& victimLine = sets[setIndex].getLine(victimIndex);
     
-    DEBUG_PRINT("Cycle " << currentCycle << ": Cache " << id 
-                << " allocating block, addr: 0x" << std::hex << addr << std::dec 
-                << ", state: " << getCacheLineStateString(newState));
+    TRACE(CacheAllocate, currentCycle, id, addr, newState);
     
     // Check if the line we're about to replace is already the same address/tag
     // If so, we just need to update its state
     if (victimLine.isValid() && victimLine.getTag() == tag) {
-        DEBUG_PRINT("Cycle " << currentCycle << ": Cache " << id 
-                    << " updating existing line for tag: 0x" << std::hex << tag << std::dec 
-                    << ", old state: " << getCacheLineStateString(victimLine.getState())
-                    << ", new state: " << getCacheLineStateString(newState));
+        TRACE(CacheUpdateExisting, currentCycle, id, tag, victimLine.getState(), newState);
         
         victimLine.setState(newState);
         victimLine.updateLRU(currentCycle);
@@ -286,9 +403,7 @@ void Cache::allocateBlock(cycle_t currentCycle, address_t addr, CacheLineState n
         // Always increment eviction counter for valid lines
         stats.evictions++;
         
-        DEBUG_PRINT("Cycle " << currentCycle << ": Cache " << id 
-                    << " evicting line, tag: 0x" << std::hex << oldTag << std::dec 
-                    << ", state: " << getCacheLineStateString(victimState));
+        TRACE(CacheEvict, currentCycle, id, oldTag, victimState);
         
         // Check if line is in Modified state (dirty)
         if (victimState == CacheLineState::MODIFIED) {
@@ -298,11 +413,12 @@ void Cache::allocateBlock(cycle_t currentCycle, address_t addr, CacheLineState n
             // Reconstruct victim address (tag + index + 0s for offset)
             address_t victimAddr = (oldTag << tagShift) | (setIndex << indexShift);
             
-            DEBUG_PRINT("Cycle " << currentCycle << ": Cache " << id 
-                        << " initiating writeback, addr: 0x" << std::hex << victimAddr << std::dec);
+            TRACE(CacheWriteBack, currentCycle, id, victimAddr);
             
-            // Issue writeback transaction to bus
-            bus->pushRequest(id, BusRequestType::WriteBack, victimAddr, currentCycle);
+            // Issue writeback transaction to bus (functional accesses only count it)
+            if (issueWriteback && evictionWritebacks) {
+                bus->pushRequest(id, BusRequestType::WriteBack, victimAddr, currentCycle);
+            }
         }
     }
     
@@ -315,14 +431,19 @@ void Cache::allocateBlock(cycle_t currentCycle, address_t addr, CacheLineState n
     sets[setIndex].updateLookupTable(tag, victimIndex);
 }
 
-bool Cache::snoop(cycle_t currentCycle, BusRequestType busReq, address_t addr) {
+// Count an event of a requesting core, growing the per-core counts as needed
+static void countForCore(std::vector<uint64_t>& counts, int core) {
+    if (core >= static_cast<int>(counts.size())) {
+        counts.resize(core + 1, 0);
+    }
+    counts[core]++;
+}
+
+bool Cache::snoop(cycle_t currentCycle, BusRequestType busReq, address_t addr, int requesterId) {
     // Find if we have this block
     CacheLine* line = findBlock(addr);
     
-    DEBUG_PRINT("Cycle " << currentCycle << ": Cache " << id 
-                << " received snoop, req: " << getBusRequestTypeString(busReq) 
-                << ", addr: 0x" << std::hex << addr << std::dec 
-                << ", have block: " << (line != nullptr ? "yes" : "no"));
+    TRACE(SnoopReceived, currentCycle, id, busReq, addr, line != nullptr ? "yes" : "no");
     
     // If we don't have the block, nothing to do
     if (line == nullptr) {
@@ -337,8 +458,7 @@ bool Cache::snoop(cycle_t currentCycle, BusRequestType busReq, address_t addr) {
         // Another cache wants to read
         if (oldState == CacheLineState::MODIFIED) {
             // Need to supply data and change to Shared
-            DEBUG_PRINT("Cycle " << currentCycle << ": Cache " << id 
-                        << " serving BusRd from M state, transitioning to S");
+            TRACE(SnoopSupplyModified, currentCycle, id);
             
             // First, need to update memory since our copy was modified
             // This is done implicitly in the simulator - data is transferred to the requestor
@@ -349,35 +469,38 @@ bool Cache::snoop(cycle_t currentCycle, BusRequestType busReq, address_t addr) {
         } else if (oldState == CacheLineState::EXCLUSIVE) {
             // When in Exclusive state, we have the only valid copy - need to respond
             // and supply data (memory would be up to date, but cache-to-cache transfer is faster)
-            DEBUG_PRINT("Cycle " << currentCycle << ": Cache " << id 
-                        << " serving BusRd from E state, transitioning to S");
+            TRACE(SnoopSupplyExclusive, currentCycle, id);
             
             line->setState(CacheLineState::SHARED);
             responded = true; // Data supplied from this cache
         } else if (oldState == CacheLineState::SHARED) {
             // Shared state remains Shared - per MESI protocol, one of the shared caches can supply data
             // For simplicity, let's say we respond if we're the first cache to see this request
-            DEBUG_PRINT("Cycle " << currentCycle << ": Cache " << id
-                        << " responding to BusRd, remaining in S state");
+            TRACE(SnoopShared, currentCycle, id);
             // In a real implementation, there would be a mechanism to select which S cache responds
             // For now, we'll leave responded = false to let memory supply the data
         }
+        if (responded) {
+            if (countInteractions) {
+                countForCore(suppliesTo, requesterId);
+            }
+            if (hotLines != nullptr) {
+                hotLines->record(HotLineEvent::CacheToCache, id, addr);
+            }
+        }
     } else if (busReq == BusRequestType::BusRdX || busReq == BusRequestType::InvalidateSig) {
         // Another cache wants exclusive access (BusRdX) or is explicitly invalidating (InvalidateSig)
         if (oldState != CacheLineState::INVALID) {
             // For BusRdX from Modified state, we need to write back data to memory
             // instead of sending data directly to the requesting cache
             if (oldState == CacheLineState::MODIFIED && busReq == BusRequestType::BusRdX) {
-                DEBUG_PRINT("Cycle " << currentCycle << ": Cache " << id 
-                          << " invalidating line due to BusRdX (was Modified), writing back data to memory");
+                TRACE(SnoopInvalidateModified, currentCycle, id);
                 
                 // We don't respond with data to the requesting cache for BusRdX
                 // Instead, we just write back to memory
                 responded = false;
             } else {
-                DEBUG_PRINT("Cycle " << currentCycle << ": Cache " << id 
-                          << " invalidating line due to " << getBusRequestTypeString(busReq)
-                          << " (was " << getCacheLineStateString(oldState) << ")");
+                TRACE(SnoopInvalidate, currentCycle, id, busReq, oldState);
             }
             
             // Update LRU information before invalidating
@@ -387,40 +510,22 @@ bool Cache::snoop(cycle_t currentCycle, BusRequestType busReq, address_t addr) {
             // This prevents double-counting or erroneous incrementing
             if (oldState != CacheLineState::INVALID) {
                 stats.invalidationsReceived++;
+                if (countInteractions) {
+                    countForCore(invalidationsFrom, requesterId);
+                }
                 
-                DEBUG_PRINT("Cycle " << currentCycle << ": Cache " << id 
-                          << " INVALIDATION due to " << getBusRequestTypeString(busReq)
-                          << " from Core " << (busReq == BusRequestType::BusRdX ? "unknown" : "unknown") 
-                          << ", previous state: " << getCacheLineStateString(oldState)
-                          << ", invalidation count: " << stats.invalidationsReceived);
+                TRACE(InvalidationReceived, currentCycle, id, busReq, requesterId, oldState, stats.invalidationsReceived);
                 
-                // Track addresses causing invalidations (if debug tracking is enabled)
-                if (stats.trackInvalidationAddresses) {
-                    stats.invalidationsByAddress[addr]++;
+                // Count the line's invalidations (if hot line tracking is enabled)
+                if (hotLines != nullptr) {
+                    hotLines->record(HotLineEvent::Invalidation, id, addr);
                     
-                    // Print out the top invalidation addresses periodically
-                    if (stats.invalidationsReceived % 500 == 0) {
-                        DEBUG_PRINT("Cache " << id << " invalidation profile after " 
-                                  << stats.invalidationsReceived << " invalidations:");
-                        
-                        // Sort addresses by invalidation count
-                        std::vector<std::pair<address_t, uint64_t>> sortedAddrs;
-                        for (const auto& pair : stats.invalidationsByAddress) {
-                            sortedAddrs.push_back(pair);
-                        }
-                        
-                        std::sort(sortedAddrs.begin(), sortedAddrs.end(), 
-                                 [](const std::pair<address_t, uint64_t>& a, 
-                                    const std::pair<address_t, uint64_t>& b) { 
-                                      return a.second > b.second; 
-                                 });
-                        
-                        // Print top 5 addresses
-                        int count = 0;
-                        for (const auto& pair : sortedAddrs) {
-                            if (count++ >= 5) break;
-                            DEBUG_PRINT("  Address 0x" << std::hex << pair.first << std::dec 
-                                      << ": " << pair.second << " invalidations");
+                    // Trace the hottest lines periodically (the sort only runs when traced)
+                    if (TRACE_ACTIVE(InvalidationProfile) && stats.invalidationsReceived % 500 == 0) {
+                        TRACE(InvalidationProfile, id, stats.invalidationsReceived);
+                        for (const HotLineTracker::HotLine& hot : hotLines->getHottest(5)) {
+                            TRACE(InvalidationProfileEntry, hot.block << blockOffsetBits,
+                                  hot.events[static_cast<int>(HotLineEvent::Invalidation)]);
                         }
                     }
                 }
@@ -428,6 +533,9 @@ bool Cache::snoop(cycle_t currentCycle, BusRequestType busReq, address_t addr) {
             
             // Invalidate the line
             line->setState(CacheLineState::INVALID);
+            if (missClassifier != nullptr) {
+                missClassifier->invalidate(addr);
+            }
         }
     }
     
@@ -449,16 +557,13 @@ void Cache::updateState(address_t addr, CacheLineState newState) {
 }
 
 void Cache::notifyTransactionComplete(cycle_t currentCycle, address_t addr, CacheLineState newState) {
-    DEBUG_PRINT("Cycle " << currentCycle << ": Cache " << id 
-                << " transaction complete for addr: 0x" << std::hex << addr << std::dec 
-                << ", new state: " << getCacheLineStateString(newState));
+    TRACE(TransactionComplete, currentCycle, id, addr, newState);
     
     // Check if this is a normal memory transaction (BusRd/BusRdX) or a writeback
     if (newState == CacheLineState::INVALID) {
         // This is a writeback completion - no need to allocate a block
         // The block was already evicted, so we just need to unblock the cache
-        DEBUG_PRINT("Cycle " << currentCycle << ": Cache " << id 
-                    << " writeback complete, no state change needed");
+        TRACE(WriteBackNoChange, currentCycle, id);
     } else {
         // For BusRd and BusRdX, we need to allocate/update a block
         
@@ -467,9 +572,7 @@ void Cache::notifyTransactionComplete(cycle_t currentCycle, address_t addr, Cach
         CacheLine* line = findBlock(addr);
         if (line != nullptr) {
             // We already have this block, just update its state
-            DEBUG_PRINT("Cycle " << currentCycle << ": Cache " << id 
-                        << " updating existing line state to " << getCacheLineStateString(newState)
-                        << " (from " << getCacheLineStateString(line->getState()) << ")");
+            TRACE(LineStateUpdate, currentCycle, id, newState, line->getState());
             line->setState(newState);
             line->updateLRU(currentCycle);
         } else {
@@ -482,8 +585,19 @@ void Cache::notifyTransactionComplete(cycle_t currentCycle, address_t addr, Cach
     blocked = false;
     readyCycle = currentCycle + 1; // Ready from next cycle
     
-    DEBUG_PRINT("Cycle " << currentCycle << ": Cache " << id 
-                << " unblocked, ready from cycle " << readyCycle);
+    TRACE(CacheUnblocked, currentCycle, id, readyCycle);
+}
+
+void Cache::notifyEarlyRestart(cycle_t currentCycle, address_t addr, CacheLineState newState,
+                               cycle_t fillCompleteCycle, bool criticalWordFirst) {
+    // Install the line and restart the core now; later accesses check fill progress
+    notifyTransactionComplete(currentCycle, addr, newState);
+    
+    fillBlockAddress = addr >> blockOffsetBits;
+    fillFirstWord = criticalWordFirst ? extractOffset(addr) / 4 : 0;
+    this->fillCompleteCycle = fillCompleteCycle;
+    
+    TRACE(CacheEarlyRestart, currentCycle, id, extractOffset(addr) / 4, fillCompleteCycle);
 }
 
 // Address manipulation helpers
@@ -514,6 +628,10 @@ int Cache::extractOffset(address_t addr) const {
 }
 
 // Getters and setters
+void Cache::setEvictionWritebacks(bool enabled) {
+    evictionWritebacks = enabled;
+}
+
 bool Cache::isBlocked() const {
     return blocked;
 }
@@ -577,6 +695,99 @@ uint64_t Cache::getInvalidationsReceived() const {
     return stats.invalidationsReceived;
 }
 
+uint64_t Cache::getPartialFillStalls() const {
+    return stats.partialFillStalls;
+}
+
+uint64_t Cache::getPartialFillStallCycles() const {
+    return stats.partialFillStallCycles;
+}
+
+void Cache::saveState(CheckpointWriter& writer) const {
+    for (const CacheSet& set : sets) {
+        set.saveState(writer);
+    }
+    writer.write(blocked);
+    writer.write(readyCycle);
+    writer.write(fillBlockAddress);
+    writer.write(fillFirstWord);
+    writer.write(fillCompleteCycle);
+    
+    writer.write(stats.accesses);
+    writer.write(stats.hits);
+    writer.write(stats.misses);
+    writer.write(stats.evictions);
+    writer.write(stats.writebacks);
+    writer.write(stats.invalidationsReceived);
+    writer.write(stats.prefetchRequests);
+    writer.write(stats.usefulPrefetches);
+    writer.write(stats.partialFillStalls);
+    writer.write(stats.partialFillStallCycles);
+    writer.writeVector(groupAccesses);
+    writer.writeVector(groupMisses);
+    writer.writeVector(invalidationsFrom);
+    writer.writeVector(suppliesTo);
+}
+
+void Cache::loadState(CheckpointReader& reader) {
+    for (CacheSet& set : sets) {
+        set.loadState(reader);
+    }
+    reader.read(blocked);
+    reader.read(readyCycle);
+    reader.read(fillBlockAddress);
+    reader.read(fillFirstWord);
+    reader.read(fillCompleteCycle);
+    
+    reader.read(stats.accesses);
+    reader.read(stats.hits);
+    reader.read(stats.misses);
+    reader.read(stats.evictions);
+    reader.read(stats.writebacks);
+    reader.read(stats.invalidationsReceived);
+    reader.read(stats.prefetchRequests);
+    reader.read(stats.usefulPrefetches);
+    reader.read(stats.partialFillStalls);
+    reader.read(stats.partialFillStallCycles);
+    reader.readVector(groupAccesses);
+    reader.readVector(groupMisses);
+    reader.readVector(invalidationsFrom);
+    reader.readVector(suppliesTo);
+}
+
+void Cache::trackSetGroups(int groups) {
+    groupAccesses.assign(groups, 0);
+    groupMisses.assign(groups, 0);
+}
+
+void Cache::setMissClassifier(MissClassifier* classifier) {
+    missClassifier = classifier;
+}
+
+void Cache::setHotLineTracker(HotLineTracker* tracker) {
+    hotLines = tracker;
+}
+
+void Cache::setInteractionCounting(bool enabled) {
+    countInteractions = enabled;
+}
+
+uint64_t Cache::getGroupAccesses(int group) const {
+    return groupAccesses[group];
+}
+
+uint64_t Cache::getGroupMisses(int group) const {
+    return groupMisses[group];
+}
+
+uint64_t Cache::getInvalidationsFrom(int core) const {
+    return core < static_cast<int>(invalidationsFrom.size()) ? invalidationsFrom[core] : 0;
+}
+
+uint64_t Cache::getSuppliesTo(int core) const {
+    return core < static_cast<int>(suppliesTo.size()) ? suppliesTo[core] : 0;
+}
+
 std::string Cache::getBusRequestTypeString(BusRequestType type) const {
     switch (type) {
         case BusRequestType::BusRd: return "BusRd";
@@ -7,8 +7,12 @@
 #include <deque>
 #include <string>
 
-// Forward declaration of Bus class to avoid circular dependencies
-class Bus;
+// Forward declaration of Interconnect class to avoid circular dependencies
+class Interconnect;
+class CheckpointWriter;
+class CheckpointReader;
+class MissClassifier;
+class HotLineTracker;
 
 // Cache Line - represents a single cache line
 class CacheLine {
@@ -41,6 +45,10 @@ public:
     
     // Debug helper
     std::string cacheLineStateToString(CacheLineState state) const;
+    
+    // Checkpointing (state and valid bits are stored as they are)
+    void saveState(CheckpointWriter& writer) const;
+    void loadState(CheckpointReader& reader);
 };
 
 // Cache Set - represents a set of cache lines with the same index
@@ -68,6 +76,10 @@ public:
 
     void updateLookupTable(address_t tag, int index);
     void removeLookupEntry(address_t tag);
+    
+    // Checkpointing: the lines and the lookup table
+    void saveState(CheckpointWriter& writer) const;
+    void loadState(CheckpointReader& reader);
 };
 
 // Cache structure for a single core
@@ -88,12 +100,19 @@ private:
     // Cache structure
     std::vector<CacheSet> sets;
     
-    // Bus connection
-    Bus* bus;
+    // Bus connection (shared bus or network interconnect)
+    Interconnect* bus;
     
     // Cache state
     bool blocked;           // Is cache waiting for a memory transaction?
     cycle_t readyCycle;     // Cycle when cache will be ready after miss handling
+    
+    // Block still being filled after an early restart (words stream in 2 cycles apart)
+    address_t fillBlockAddress;  // Block address (addr >> b) of the line being filled
+    int fillFirstWord;           // Word delivered first (the critical word, or word 0)
+    cycle_t fillCompleteCycle;   // Cycle the last word arrives
+    
+    bool evictionWritebacks;     // Dirty victims issue a WriteBack (off while replaying a bus log)
 
     // Address manipulation masks and shifts
     address_t tagMask;
@@ -112,12 +131,23 @@ private:
         uint64_t invalidationsReceived; // Number of invalidations received from bus
         uint64_t prefetchRequests;
         uint64_t usefulPrefetches;
-        
-        // Debug flag - Count invalidations by address (for troubleshooting bus invalidation issues)
-        bool trackInvalidationAddresses;
-        std::unordered_map<address_t, uint64_t> invalidationsByAddress;
+        uint64_t partialFillStalls;     // Hits on a word of a filling line that had not arrived yet
+        uint64_t partialFillStallCycles;
     } stats;
     
+    MissClassifier* missClassifier;   // Classifies every miss (nullptr = off)
+    HotLineTracker* hotLines;         // Lines with the most coherence events, shared by all caches (nullptr = off)
+    
+    // Per-set-group access and miss counts (set sampling error estimates; empty = off)
+    std::vector<uint64_t> groupAccesses;
+    std::vector<uint64_t> groupMisses;
+    
+    // Per requesting core: lines of this cache it invalidated, and lines this cache supplied
+    // to it (grown to the highest requester seen; only counted when countInteractions is set)
+    bool countInteractions;
+    std::vector<uint64_t> invalidationsFrom;
+    std::vector<uint64_t> suppliesTo;
+    
     // Address manipulation helpers
     address_t extractTag(address_t addr) const;
     int extractIndex(address_t addr) const;
@@ -126,21 +156,30 @@ private:
     // Miss handling
     void handleMiss(cycle_t currentCycle, MemOperation op, address_t addr, address_t tag, int setIndex);
     
-    // Block allocation
-    void allocateBlock(cycle_t currentCycle, address_t addr, CacheLineState newState);
+    // Block allocation (issueWriteback = false counts a dirty victim's writeback without
+    // putting it on the bus, for functional accesses)
+    void allocateBlock(cycle_t currentCycle, address_t addr, CacheLineState newState,
+                       bool issueWriteback = true);
+    
+    // Stall a hit on a word of a line that is still being filled; returns true if stalled
+    bool stallOnPartialFill(cycle_t currentCycle, address_t addr);
     
     // Debug helpers
     std::string getBusRequestTypeString(BusRequestType type) const;
     std::string getCacheLineStateString(CacheLineState state) const;
     
 public:
-    Cache(int id, int s, int E, int b, Bus* bus);
+    Cache(int id, int s, int E, int b, Interconnect* bus);
     
     // Main cache access function
     bool access(cycle_t currentCycle, MemOperation op, address_t addr);
     
-    // Snoop function to handle coherence
-    bool snoop(cycle_t currentCycle, BusRequestType busReq, address_t addr);
+    // Functional access for fast-forwarding: updates tags, LRU and MESI state (snooping the
+    // other caches instantly) and the access counters, without bus timing. Returns true on a hit
+    bool functionalAccess(cycle_t currentCycle, MemOperation op, address_t addr);
+    
+    // Snoop function to handle coherence (requesterId is the core that issued the request)
+    bool snoop(cycle_t currentCycle, BusRequestType busReq, address_t addr, int requesterId);
     
     // Find a block in the cache
     CacheLine* findBlock(address_t addr);
@@ -153,6 +192,12 @@ public:
     // Handle completion of a memory transaction
     void notifyTransactionComplete(cycle_t currentCycle, address_t addr, CacheLineState newState);
     
+    // Handle early restart: the requested word has arrived and the rest of the line
+    // streams in until fillCompleteCycle, in wrap-around order from the critical word
+    // (criticalWordFirst) or from word 0
+    void notifyEarlyRestart(cycle_t currentCycle, address_t addr, CacheLineState newState,
+                            cycle_t fillCompleteCycle, bool criticalWordFirst);
+    
     // State getters/setters
     bool isBlocked() const;
     void setBlocked(bool blocked);
@@ -165,6 +210,25 @@ public:
     int getAssociativity() const;
     int getNumSets() const;
     
+    // Checkpointing: every set, the miss handling state and the statistics
+    void saveState(CheckpointWriter& writer) const;
+    void loadState(CheckpointReader& reader);
+    
+    // Bus log replay feeds the logged writebacks itself, so evictions must not add their own
+    void setEvictionWritebacks(bool enabled);
+    
+    // Count accesses and misses separately for the sets in each of `groups` groups (set index modulo groups)
+    void trackSetGroups(int groups);
+    
+    // Classify every miss as compulsory, capacity, conflict, true or false sharing
+    void setMissClassifier(MissClassifier* classifier);
+    
+    // Count misses, invalidations and cache-to-cache transfers per line
+    void setHotLineTracker(HotLineTracker* tracker);
+    
+    // Count the invalidations and cache-to-cache supplies per requesting core
+    void setInteractionCounting(bool enabled);
+    
     // Statistics functions
     double getMissRate() const;
     uint64_t getAccesses() const;
@@ -173,6 +237,12 @@ public:
     uint64_t getEvictions() const;
     uint64_t getWritebacks() const;
     uint64_t getInvalidationsReceived() const;
+    uint64_t getPartialFillStalls() const;
+    uint64_t getPartialFillStallCycles() const;
+    uint64_t getGroupAccesses(int group) const;
+    uint64_t getGroupMisses(int group) const;
+    uint64_t getInvalidationsFrom(int core) const;
+    uint64_t getSuppliesTo(int core) const;
 };
 
 #endif // CACHE_H 
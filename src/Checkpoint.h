@@ -0,0 +1,146 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <vector>
+#include <deque>
+#include <string>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+#include "Types.h"
+
+// Binary checkpoint streams. Every component writes its state field by field, in a fixed
+// order, and reads it back in the same order. Values are stored in host byte order, so a
+// checkpoint is only meant to be restored by the same simulator build on the same host.
+class CheckpointWriter {
+private:
+    std::ostream& out;
+
+public:
+    explicit CheckpointWriter(std::ostream& out) : out(out) {}
+
+    // Integers, floating point values, flags and enums
+    template <typename T>
+    void write(const T& value) {
+        static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value,
+                      "checkpoint values must be scalars");
+        out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    void writeString(const std::string& value) {
+        write<uint64_t>(value.size());
+        out.write(value.data(), static_cast<std::streamsize>(value.size()));
+    }
+
+    template <typename T>
+    void writeVector(const std::vector<T>& values) {
+        write<uint64_t>(values.size());
+        for (const T& value : values) {
+            write(value);
+        }
+    }
+
+    void writeTransaction(const BusTransaction& transaction) {
+        write(transaction.requesterId);
+        write(transaction.type);
+        write(transaction.address);
+        write(transaction.startCycle);
+        write(transaction.completionCycle);
+        write(transaction.dataReady);
+        write(transaction.servedByCache);
+        write(transaction.priority);
+    }
+
+    void writeTransactions(const std::deque<BusTransaction>& transactions) {
+        write<uint64_t>(transactions.size());
+        for (const BusTransaction& transaction : transactions) {
+            writeTransaction(transaction);
+        }
+    }
+
+    bool good() const { return out.good(); }
+};
+
+// Reading side; throws std::runtime_error on a truncated checkpoint
+class CheckpointReader {
+private:
+    std::istream& in;
+
+public:
+    explicit CheckpointReader(std::istream& in) : in(in) {}
+
+    template <typename T>
+    void read(T& value) {
+        static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value,
+                      "checkpoint values must be scalars");
+        if (!in.read(reinterpret_cast<char*>(&value), sizeof(value))) {
+            throw std::runtime_error("checkpoint is truncated");
+        }
+    }
+
+    template <typename T>
+    T read() {
+        T value;
+        read(value);
+        return value;
+    }
+
+    std::string readString() {
+        std::string value(readSize(), '\0');
+        if (!value.empty() && !in.read(&value[0], static_cast<std::streamsize>(value.size()))) {
+            throw std::runtime_error("checkpoint is truncated");
+        }
+        return value;
+    }
+
+    template <typename T>
+    void readVector(std::vector<T>& values) {
+        values.resize(readSize());
+        for (size_t i = 0; i < values.size(); i++) {
+            T value;
+            read(value);
+            values[i] = value;
+        }
+    }
+
+    BusTransaction readTransaction() {
+        BusTransaction transaction;
+        read(transaction.requesterId);
+        read(transaction.type);
+        read(transaction.address);
+        read(transaction.startCycle);
+        read(transaction.completionCycle);
+        read(transaction.dataReady);
+        read(transaction.servedByCache);
+        read(transaction.priority);
+        return transaction;
+    }
+
+    void readTransactions(std::deque<BusTransaction>& transactions) {
+        transactions.clear();
+        uint64_t count = readSize();
+        for (uint64_t i = 0; i < count; i++) {
+            transactions.push_back(readTransaction());
+        }
+    }
+
+    // Element count of a string or container; rejects counts no checkpoint could hold
+    uint64_t readSize() {
+        uint64_t size = read<uint64_t>();
+        if (size > (1ULL << 40)) {
+            throw std::runtime_error("checkpoint is corrupt");
+        }
+        return size;
+    }
+
+    // Check that a configuration value matches the one the checkpoint was taken with
+    template <typename T>
+    void expect(const T& value, const std::string& name) {
+        if (read<T>() != value) {
+            throw std::runtime_error("checkpoint was taken with a different " + name);
+        }
+    }
+};
+
+#endif // CHECKPOINT_H
@@ -1,6 +1,7 @@
 #include "Core.h"
 #include "Cache.h"
-#include "Simulator.h"
+#include "Trace.h"
+#include "Checkpoint.h"
 #include <iostream>
 
 Core::Core(int id, Cache* cache, const std::string& tracePath) :
@@ -11,10 +12,26 @@ Core::Core(int id, Cache* cache, const std::string& tracePath) :
     blocked(false),
     totalCycles(0),
     idleCycles(0),
+    stallCycles(),
     instructionCount(0),
     readCount(0),
     writeCount(0) {
-    DEBUG_PRINT("Core " << id << " initialized with trace file: " << tracePath);
+    TRACE(CoreInitFile, id, tracePath);
+}
+
+Core::Core(int id, Cache* cache, std::shared_ptr<const DecodedTrace> trace) :
+    id(id),
+    cache(cache),
+    traceReader(new TraceReader(trace)),
+    finished(false),
+    blocked(false),
+    totalCycles(0),
+    idleCycles(0),
+    stallCycles(),
+    instructionCount(0),
+    readCount(0),
+    writeCount(0) {
+    TRACE(CoreInitDecoded, id, trace->size());
 }
 
 Core::~Core() {
@@ -32,7 +49,7 @@ void Core::tick(cycle_t currentCycle) {
         if (!cache->isBlocked() && currentCycle >= cache->getReadyCycle()) {
             // Cache has completed the operation, unblock core
             blocked = false;
-            DEBUG_PRINT("Cycle " << currentCycle << ": Core " << id << " unblocked");
+            TRACE(CoreUnblocked, currentCycle, id);
         } else {
             // Still waiting for cache
             return;
@@ -54,9 +71,7 @@ void Core::tick(cycle_t currentCycle) {
 
         // Every 1000 instructions, print debug info
         if (instructionCount % 1000 == 0) {
-            DEBUG_PRINT("Core " << id << " executed " << instructionCount 
-                        << " instructions, " << readCount << " reads, " 
-                        << writeCount << " writes");
+            TRACE(CoreProgress, id, instructionCount, readCount, writeCount);
         }
 
         // Try to access cache
@@ -65,28 +80,75 @@ void Core::tick(cycle_t currentCycle) {
         if (!hit) {
             // Cache miss - block the core
             blocked = true;
-            DEBUG_PRINT("Cycle " << currentCycle << ": Core " << id 
-                        << " blocked due to cache miss, addr: 0x" 
-                        << std::hex << entry.addr << std::dec 
-                        << ", op: " << (entry.op == MemOperation::READ ? "READ" : "WRITE"));
+            TRACE(CoreBlocked, currentCycle, id, entry.addr,
+                  entry.op == MemOperation::READ ? "READ" : "WRITE");
         }
     } else {
         // End of trace - mark core as finished
         finished = true;
-        DEBUG_PRINT("Cycle " << currentCycle << ": Core " << id 
-                    << " finished execution after " << instructionCount 
-                    << " instructions");
+        TRACE(CoreFinished, currentCycle, id, instructionCount);
+    }
+}
+
+void Core::saveState(CheckpointWriter& writer) {
+    writer.write(finished);
+    writer.write(blocked);
+    writer.write(totalCycles);
+    writer.write(idleCycles);
+    for (cycle_t cycles : stallCycles) {
+        writer.write(cycles);
+    }
+    writer.write(instructionCount);
+    writer.write(readCount);
+    writer.write(writeCount);
+    traceReader->saveState(writer);
+}
+
+void Core::loadState(CheckpointReader& reader) {
+    reader.read(finished);
+    reader.read(blocked);
+    reader.read(totalCycles);
+    reader.read(idleCycles);
+    for (cycle_t& cycles : stallCycles) {
+        reader.read(cycles);
     }
+    reader.read(instructionCount);
+    reader.read(readCount);
+    reader.read(writeCount);
+    traceReader->loadState(reader);
 }
 
-void Core::incrementIdleCycle() {
+bool Core::functionalStep(cycle_t currentCycle) {
+    if (finished) {
+        return false;
+    }
+    blocked = false;
+
+    TraceEntry entry;
+    if (!traceReader->getNextTrace(entry)) {
+        finished = true;
+        TRACE(CoreFinishedFastForward, currentCycle, id, instructionCount);
+        return false;
+    }
+
+    instructionCount++;
+    if (entry.op == MemOperation::READ) {
+        readCount++;
+    } else {
+        writeCount++;
+    }
+    cache->functionalAccess(currentCycle, entry.op, entry.addr);
+    return true;
+}
+
+void Core::incrementIdleCycle(StallCause cause) {
     if (!finished) {
         idleCycles++;
+        stallCycles[static_cast<int>(cause)]++;
         
         // Debug counter for idle cycles
         if (idleCycles % 1000 == 0) {
-            DEBUG_PRINT("Core " << id << " idle cycle count: " 
-                        << idleCycles);
+            TRACE(CoreIdle, id, idleCycles);
         }
     }
 }
@@ -101,10 +163,7 @@ bool Core::isBlocked() const {
 
 void Core::setTotalCycles(cycle_t cycles) {
     totalCycles = cycles;
-    DEBUG_PRINT("Core " << id << " final stats - Total cycles: " 
-                << totalCycles << ", Idle cycles: " << idleCycles 
-                << ", Instructions: " << instructionCount 
-                << ", Execution cycles: " << (totalCycles - idleCycles));
+    TRACE(CoreFinalStats, id, totalCycles, idleCycles, instructionCount, totalCycles - idleCycles);
 }
 
 cycle_t Core::getTotalCycles() const {
@@ -115,6 +174,10 @@ cycle_t Core::getIdleCycles() const {
     return idleCycles;
 }
 
+cycle_t Core::getStallCycles(StallCause cause) const {
+    return stallCycles[static_cast<int>(cause)];
+}
+
 uint64_t Core::getInstructionCount() const {
     return instructionCount;
 }
@@ -130,3 +193,15 @@ uint64_t Core::getWriteCount() const {
 int Core::getId() const {
     return id;
 } 
+
+const char* getStallCauseName(StallCause cause) {
+    switch (cause) {
+        case StallCause::Arbitration: return "Arbitration";
+        case StallCause::WriteBack: return "Writeback";
+        case StallCause::Memory: return "Memory";
+        case StallCause::CacheToCache: return "Cache-to-Cache";
+        case StallCause::Upgrade: return "Upgrade";
+        case StallCause::Fill: return "Fill";
+        default: return "Unknown";
+    }
+}
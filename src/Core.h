@@ -3,10 +3,13 @@
 
 #include <string>
 #include "Types.h"
+#include <memory>
 #include "TraceReader.h"
 
 // Forward declarations
 class Cache;
+class CheckpointWriter;
+class CheckpointReader;
 
 // Core class represents a single processor core
 class Core {
@@ -21,19 +24,29 @@ private:
     // Statistics
     cycle_t totalCycles;        // Total execution cycles
     cycle_t idleCycles;         // Cycles spent idle/blocked
+    cycle_t stallCycles[static_cast<int>(StallCause::Count)]; // Idle cycles by cause
     uint64_t instructionCount;  // Total instructions executed
     uint64_t readCount;         // Total read operations
     uint64_t writeCount;        // Total write operations
 
 public:
     Core(int id, Cache* cache, const std::string& tracePath);
+    Core(int id, Cache* cache, std::shared_ptr<const DecodedTrace> trace); // Pre-decoded trace
     ~Core();
     
     // Process one cycle for this core
     void tick(cycle_t currentCycle);
     
-    // Increment idle cycles counter
-    void incrementIdleCycle();
+    // Execute the next trace entry functionally (no timing, see Cache::functionalAccess).
+    // The caller must have drained any outstanding miss. Returns false at the end of the trace
+    bool functionalStep(cycle_t currentCycle);
+    
+    // Checkpointing: flags, counters and the trace position
+    void saveState(CheckpointWriter& writer);
+    void loadState(CheckpointReader& reader);
+    
+    // Increment idle cycles counter, attributing the cycle to what the core waits for
+    void incrementIdleCycle(StallCause cause);
     
     // State getters
     bool isFinished() const;
@@ -46,9 +59,13 @@ public:
     // Statistics getters
     cycle_t getTotalCycles() const;
     cycle_t getIdleCycles() const;
+    cycle_t getStallCycles(StallCause cause) const;
     uint64_t getInstructionCount() const;
     uint64_t getReadCount() const;
     uint64_t getWriteCount() const;
 };
 
+// Name of a stall cause in the statistics ("Cache-to-Cache")
+const char* getStallCauseName(StallCause cause);
+
 #endif // CORE_H 
@@ -0,0 +1,337 @@
+#include "FunctionalSimulator.h"
+#include "ParallelEngine.h"
+#include <iomanip>
+#include <algorithm>
+#include <stdexcept>
+
+const address_t FunctionalSimulator::invalidTag;
+const size_t FunctionalSimulator::batchSize;
+
+FunctionalSimulator::FunctionalSimulator(const std::vector<std::shared_ptr<const DecodedTrace>>& traces,
+                                         const std::vector<SweepPoint>& points, int jobs,
+                                         InterleavePolicy interleave) :
+    traces(traces),
+    numCores(static_cast<int>(traces.size())),
+    jobs(std::max(1, std::min(jobs, static_cast<int>(points.size())))),
+    interleave(interleave),
+    totalAccesses(0) {
+
+    if (numCores == 0) {
+        throw std::runtime_error("functional simulation needs at least one trace");
+    }
+
+    for (const SweepPoint& point : points) {
+        if (point.s >= 30 || point.b >= 32) {
+            throw std::runtime_error("cache geometry too large for the functional model");
+        }
+
+        Model model;
+        model.point = point;
+        model.numSets = 1 << point.s;
+        model.associativity = point.E;
+        model.setMask = static_cast<address_t>(model.numSets - 1);
+        model.clock = 0;
+
+        std::vector<int>::iterator group = std::find(blockBits.begin(), blockBits.end(), point.b);
+        model.blockGroup = static_cast<int>(group - blockBits.begin());
+        if (group == blockBits.end()) {
+            blockBits.push_back(point.b);
+        }
+
+        size_t lines = static_cast<size_t>(numCores) * model.numSets * model.associativity;
+        model.tags.assign(lines, invalidTag);
+        model.lastUsed.assign(lines, 0);
+        model.states.assign(lines, static_cast<uint8_t>(CacheLineState::INVALID));
+        model.stats.assign(numCores, FunctionalCoreStats());
+        models.push_back(model);
+    }
+}
+
+int FunctionalSimulator::findLine(const Model& model, size_t setBase, address_t block) const {
+    const address_t* tags = &model.tags[setBase];
+    for (int way = 0; way < model.associativity; way++) {
+        if (tags[way] == block) {
+            return static_cast<int>(setBase) + way;
+        }
+    }
+    return -1;
+}
+
+void FunctionalSimulator::access(Model& model, int core, MemOperation op, address_t block) {
+    FunctionalCoreStats& stats = model.stats[core];
+    size_t set = static_cast<size_t>(block & model.setMask);
+    size_t setStride = static_cast<size_t>(model.numSets) * model.associativity;
+    size_t setBase = core * setStride + set * model.associativity;
+    bool write = (op == MemOperation::WRITE);
+
+    stats.accesses++;
+    if (write) {
+        stats.writes++;
+    } else {
+        stats.reads++;
+    }
+
+    int line = findLine(model, setBase, block);
+    if (line >= 0) {
+        stats.hits++;
+        model.lastUsed[line] = ++model.clock;
+
+        if (write && model.states[line] != static_cast<uint8_t>(CacheLineState::MODIFIED)) {
+            // S -> M invalidates the other copies, E -> M is silent
+            if (model.states[line] == static_cast<uint8_t>(CacheLineState::SHARED)) {
+                for (int other = 0; other < numCores; other++) {
+                    int copy = other == core ? -1 : findLine(model, other * setStride + set * model.associativity, block);
+                    if (copy >= 0) {
+                        model.tags[copy] = invalidTag;
+                        model.states[copy] = static_cast<uint8_t>(CacheLineState::INVALID);
+                        model.stats[other].invalidations++;
+                    }
+                }
+            }
+            model.states[line] = static_cast<uint8_t>(CacheLineState::MODIFIED);
+        }
+        return;
+    }
+
+    stats.misses++;
+
+    // Snoop the other caches: BusRdX invalidates every copy, BusRd demotes them to Shared
+    bool shared = false;
+    for (int other = 0; other < numCores; other++) {
+        int copy = other == core ? -1 : findLine(model, other * setStride + set * model.associativity, block);
+        if (copy < 0) {
+            continue;
+        }
+        if (write) {
+            model.tags[copy] = invalidTag;
+            model.states[copy] = static_cast<uint8_t>(CacheLineState::INVALID);
+            model.stats[other].invalidations++;
+        } else {
+            model.states[copy] = static_cast<uint8_t>(CacheLineState::SHARED);
+            shared = true;
+        }
+    }
+
+    // Victim: the first invalid line, else the least recently used one
+    int victim = static_cast<int>(setBase);
+    for (int way = 0; way < model.associativity; way++) {
+        size_t index = setBase + way;
+        if (model.tags[index] == invalidTag) {
+            victim = static_cast<int>(index);
+            break;
+        }
+        if (model.lastUsed[index] < model.lastUsed[victim]) {
+            victim = static_cast<int>(index);
+        }
+    }
+    if (model.tags[victim] != invalidTag) {
+        stats.evictions++;
+        if (model.states[victim] == static_cast<uint8_t>(CacheLineState::MODIFIED)) {
+            stats.writebacks++;
+        }
+    }
+
+    CacheLineState state = write ? CacheLineState::MODIFIED :
+                           (shared ? CacheLineState::SHARED : CacheLineState::EXCLUSIVE);
+    model.tags[victim] = block;
+    model.states[victim] = static_cast<uint8_t>(state);
+    model.lastUsed[victim] = ++model.clock;
+}
+
+void FunctionalSimulator::run() {
+    std::vector<size_t> positions(numCores, 0);
+    std::vector<int> batchCores;
+    std::vector<uint8_t> batchOps;
+    std::vector<address_t> batchAddresses;
+    std::vector<std::vector<address_t>> batchBlocks(blockBits.size());
+    batchCores.reserve(batchSize);
+    batchOps.reserve(batchSize);
+    batchAddresses.reserve(batchSize);
+
+    // Every batch is shared by all configurations; the models are dealt over the threads
+    ParallelEngine engine(jobs);
+    std::function<void(int)> runBatch = [&](int worker) {
+        size_t count = batchCores.size();
+        for (size_t m = worker; m < models.size(); m += jobs) {
+            Model& model = models[m];
+            const address_t* blocks = batchBlocks[model.blockGroup].data();
+            for (size_t i = 0; i < count; i++) {
+                access(model, batchCores[i], static_cast<MemOperation>(batchOps[i]), blocks[i]);
+            }
+        }
+    };
+
+    // Each visit adds a core's rate to its credit and takes an access once the credit
+    // reaches one. Round-robin gives every core rate 1; proportional gives the longest
+    // trace rate 1 and the others their length relative to it.
+    int activeCores = 0;
+    size_t longest = 0;
+    for (int core = 0; core < numCores; core++) {
+        if (!traces[core]->empty()) {
+            activeCores++;
+        }
+        longest = std::max(longest, traces[core]->size());
+    }
+    std::vector<double> rates(numCores, 1.0);
+    std::vector<double> credits(numCores, 0.0);
+    if (interleave == InterleavePolicy::Proportional) {
+        for (int core = 0; core < numCores; core++) {
+            rates[core] = longest > 0 ? static_cast<double>(traces[core]->size()) / longest : 1.0;
+        }
+    }
+    
+    int nextCore = 0;
+    while (activeCores > 0) {
+        batchCores.clear();
+        batchOps.clear();
+        batchAddresses.clear();
+        while (batchCores.size() < batchSize && activeCores > 0) {
+            const DecodedTrace& trace = *traces[nextCore];
+            credits[nextCore] += rates[nextCore];
+            if (positions[nextCore] < trace.size() && credits[nextCore] >= 1.0) {
+                credits[nextCore] -= 1.0;
+                const TraceEntry& entry = trace[positions[nextCore]++];
+                batchCores.push_back(nextCore);
+                batchOps.push_back(static_cast<uint8_t>(entry.op));
+                batchAddresses.push_back(entry.addr);
+                if (positions[nextCore] == trace.size()) {
+                    activeCores--;
+                }
+            }
+            nextCore = (nextCore + 1) % numCores;
+        }
+
+        // Split the addresses once per block size
+        for (size_t group = 0; group < blockBits.size(); group++) {
+            std::vector<address_t>& blocks = batchBlocks[group];
+            blocks.resize(batchAddresses.size());
+            for (size_t i = 0; i < batchAddresses.size(); i++) {
+                blocks[i] = batchAddresses[i] >> blockBits[group];
+            }
+        }
+
+        engine.runPhase(runBatch);
+        totalAccesses += batchCores.size();
+    }
+}
+
+void FunctionalSimulator::writeCsv(std::ostream& out) const {
+    out << "s,E,b,cache_size_bytes,core,accesses,reads,writes,hits,misses,miss_rate,"
+        << "evictions,writebacks,invalidations" << std::endl;
+
+    for (const Model& model : models) {
+        const SweepPoint& p = model.point;
+        uint64_t cacheSize = (1ULL << p.s) * p.E * (1ULL << p.b);
+        for (int i = 0; i < numCores; i++) {
+            const FunctionalCoreStats& core = model.stats[i];
+            double missRate = core.accesses > 0 ? static_cast<double>(core.misses) / core.accesses : 0.0;
+            out << p.s << "," << p.E << "," << p.b << "," << cacheSize << "," << i << ","
+                << core.accesses << "," << core.reads << "," << core.writes << ","
+                << core.hits << "," << core.misses << ","
+                << std::fixed << std::setprecision(6) << missRate << ","
+                << core.evictions << "," << core.writebacks << "," << core.invalidations << std::endl;
+        }
+    }
+}
+
+void FunctionalSimulator::writeJson(std::ostream& out, const std::string& traceBase) const {
+    out << "{" << std::endl;
+    out << "  \"trace\": \"" << traceBase << "\"," << std::endl;
+    out << "  \"model\": \"functional\"," << std::endl;
+    out << "  \"interleave\": \"" << getInterleaveName(interleave) << "\"," << std::endl;
+    out << "  \"points\": [" << std::endl;
+
+    for (size_t m = 0; m < models.size(); m++) {
+        const Model& model = models[m];
+        const SweepPoint& p = model.point;
+        out << "    {\"s\": " << p.s << ", \"E\": " << p.E << ", \"b\": " << p.b
+            << ", \"cache_size_bytes\": " << ((1ULL << p.s) * p.E * (1ULL << p.b))
+            << "," << std::endl << "     \"cores\": [" << std::endl;
+
+        for (int i = 0; i < numCores; i++) {
+            const FunctionalCoreStats& core = model.stats[i];
+            double missRate = core.accesses > 0 ? static_cast<double>(core.misses) / core.accesses : 0.0;
+            out << "       {\"core\": " << i
+                << ", \"accesses\": " << core.accesses
+                << ", \"reads\": " << core.reads
+                << ", \"writes\": " << core.writes
+                << ", \"hits\": " << core.hits
+                << ", \"misses\": " << core.misses
+                << ", \"miss_rate\": " << std::fixed << std::setprecision(6) << missRate
+                << ", \"evictions\": " << core.evictions
+                << ", \"writebacks\": " << core.writebacks
+                << ", \"invalidations\": " << core.invalidations << "}"
+                << (i + 1 < numCores ? "," : "") << std::endl;
+        }
+        out << "     ]}" << (m + 1 < models.size() ? "," : "") << std::endl;
+    }
+
+    out << "  ]" << std::endl;
+    out << "}" << std::endl;
+}
+
+void FunctionalSimulator::printReport(std::ostream& out, const std::string& traceBase, double decodeSeconds,
+                                      double runSeconds) const {
+    for (size_t m = 0; m < models.size(); m++) {
+        const Model& model = models[m];
+        const SweepPoint& p = model.point;
+        uint64_t blockSize = 1ULL << p.b;
+        uint64_t cacheSize = (1ULL << p.s) * p.E * blockSize;
+
+        if (m > 0) {
+            out << std::endl;
+        }
+        out << "Simulation Parameters:" << std::endl;
+        out << "Trace Prefix: " << traceBase << std::endl;
+        out << "Simulation Mode: Functional (no timing model, coherence resolved instantly)" << std::endl;
+        out << "Interleaving: " << getInterleaveName(interleave) << std::endl;
+        if (numCores != 4) {
+            out << "Number of Cores: " << numCores << std::endl;
+        }
+        out << "Set Index Bits: " << p.s << std::endl;
+        out << "Associativity: " << p.E << std::endl;
+        out << "Block Bits: " << p.b << std::endl;
+        out << "Block Size (Bytes): " << blockSize << std::endl;
+        out << "Number of Sets: " << (1ULL << p.s) << std::endl;
+        out << "Cache Size (KB per core): " << (cacheSize / 1024.0) << std::endl;
+        out << "MESI Protocol: Enabled" << std::endl;
+        out << "Write Policy: Write-back, Write-allocate" << std::endl;
+        out << "Replacement Policy: LRU (invalid lines replaced first)" << std::endl;
+        out << std::endl;
+
+        for (int i = 0; i < numCores; i++) {
+            const FunctionalCoreStats& core = model.stats[i];
+            double missRate = core.accesses > 0 ? static_cast<double>(core.misses) / core.accesses : 0.0;
+            out << "Core " << i << " Functional Statistics:" << std::endl;
+            out << "Total Instructions: " << core.accesses << std::endl;
+            out << "Total Reads: " << core.reads << std::endl;
+            out << "Total Writes: " << core.writes << std::endl;
+            out << "Cache Hits: " << core.hits << std::endl;
+            out << "Cache Misses: " << core.misses << std::endl;
+            out << "Cache Miss Rate: " << std::fixed << std::setprecision(2) << (missRate * 100.0) << "%" << std::endl;
+            out << "Cache Evictions: " << core.evictions << std::endl;
+            out << "Writebacks: " << core.writebacks << std::endl;
+            out << "Bus Invalidations: " << core.invalidations << std::endl;
+            out << std::endl;
+        }
+    }
+
+    out << "Functional Simulation Summary:" << std::endl;
+    out << "Total Accesses: " << totalAccesses << std::endl;
+    out << "Trace Decode Time (s): " << std::fixed << std::setprecision(3) << decodeSeconds << std::endl;
+    out << "Simulation Wall Time (s): " << std::fixed << std::setprecision(3) << runSeconds << std::endl;
+    out << "Accesses per Second: " << std::fixed << std::setprecision(0)
+        << (runSeconds > 0.0 ? totalAccesses * models.size() / runSeconds : 0.0) << std::endl;
+}
+
+std::string FunctionalSimulator::getInterleaveName(InterleavePolicy interleave) {
+    return interleave == InterleavePolicy::Proportional ? "record-proportional" : "round-robin";
+}
+
+uint64_t FunctionalSimulator::getTotalAccesses() const {
+    return totalAccesses;
+}
+
+size_t FunctionalSimulator::getNumConfigurations() const {
+    return models.size();
+}
@@ -0,0 +1,94 @@
+#ifndef FUNCTIONALSIMULATOR_H
+#define FUNCTIONALSIMULATOR_H
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <ostream>
+#include "Types.h"
+#include "TraceReader.h"
+#include "Sweep.h"
+
+// Functional statistics of one core's cache in one configuration
+struct FunctionalCoreStats {
+    uint64_t accesses;
+    uint64_t reads;
+    uint64_t writes;
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+    uint64_t writebacks;
+    uint64_t invalidations;   // Lines invalidated by other cores' writes
+};
+
+// Order in which the per-core traces are merged into the single access stream
+enum class InterleavePolicy {
+    RoundRobin,   // One access from each core in turn
+    Proportional  // Each core at a rate proportional to its trace length, so all finish together
+};
+
+// Tag-only MESI model of the private caches with no timing: every access resolves its
+// coherence actions instantly. Any number of cache geometries are simulated in lockstep
+// in a single pass over the traces. The interleaved trace is cut into batches; each
+// batch is split into block addresses once per distinct block size, and every
+// configuration then runs over the whole batch while its tag arrays stay hot.
+class FunctionalSimulator {
+private:
+    // One configuration: a private cache per core
+    struct Model {
+        SweepPoint point;
+        int numSets;
+        int associativity;
+        address_t setMask;
+        int blockGroup;                     // Index of the model's block size in blockBits
+        uint64_t clock;                     // LRU timestamp source
+        // Line arrays indexed [core][set][way]; ways of a set are contiguous so a lookup
+        // scans one short run of tags. Invalid lines hold invalidTag, so the lookup
+        // never has to read the state array.
+        std::vector<address_t> tags;        // Block address (tag and index) of each line
+        std::vector<uint64_t> lastUsed;
+        std::vector<uint8_t> states;        // CacheLineState
+        std::vector<FunctionalCoreStats> stats; // Per core
+    };
+
+    static const address_t invalidTag = ~static_cast<address_t>(0);
+    static const size_t batchSize = 16384;  // Interleaved accesses decoded per batch
+
+    std::vector<std::shared_ptr<const DecodedTrace>> traces;
+    int numCores;
+    int jobs;
+    InterleavePolicy interleave;
+    std::vector<int> blockBits;             // Distinct block sizes (b) over all models
+    std::vector<Model> models;
+    uint64_t totalAccesses;
+
+    // Find a block in a core's set; returns the line index or -1
+    int findLine(const Model& model, size_t setBase, address_t block) const;
+
+    // Apply one access of core to a model
+    void access(Model& model, int core, MemOperation op, address_t block);
+
+public:
+    FunctionalSimulator(const std::vector<std::shared_ptr<const DecodedTrace>>& traces,
+                        const std::vector<SweepPoint>& points, int jobs,
+                        InterleavePolicy interleave = InterleavePolicy::RoundRobin);
+
+    // Interleave the cores by the policy and run every configuration
+    void run();
+
+    // One CSV row per configuration and core, or one JSON object per configuration
+    void writeCsv(std::ostream& out) const;
+    void writeJson(std::ostream& out, const std::string& traceBase) const;
+
+    // Statistics report in the layout of Simulator::printStats, one per configuration,
+    // labelled as functional and without cycle counts
+    void printReport(std::ostream& out, const std::string& traceBase, double decodeSeconds,
+                     double runSeconds) const;
+
+    static std::string getInterleaveName(InterleavePolicy interleave);
+
+    uint64_t getTotalAccesses() const;
+    size_t getNumConfigurations() const;
+};
+
+#endif // FUNCTIONALSIMULATOR_H
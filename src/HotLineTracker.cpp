@@ -0,0 +1,141 @@
+#include "HotLineTracker.h"
+#include <algorithm>
+
+HotLineTracker::HotLineTracker(int capacity, int numCores, int blockOffsetBits) :
+    capacity(capacity),
+    numCores(numCores),
+    blockOffsetBits(blockOffsetBits) {
+    lines.reserve(capacity);
+    wordMasks.reserve(static_cast<size_t>(capacity) * numCores);
+    heap.reserve(capacity);
+    lineIndex.reserve(capacity * 2);
+}
+
+void HotLineTracker::swapHeap(int a, int b) {
+    std::swap(heap[a], heap[b]);
+    lines[heap[a]].heapPosition = a;
+    lines[heap[b]].heapPosition = b;
+}
+
+void HotLineTracker::siftUp(int position) {
+    while (position > 0) {
+        int parent = (position - 1) / 2;
+        if (lines[heap[parent]].count <= lines[heap[position]].count) {
+            break;
+        }
+        swapHeap(parent, position);
+        position = parent;
+    }
+}
+
+void HotLineTracker::siftDown(int position) {
+    int size = static_cast<int>(heap.size());
+    while (true) {
+        int smallest = position;
+        int left = 2 * position + 1;
+        int right = left + 1;
+        if (left < size && lines[heap[left]].count < lines[heap[smallest]].count) {
+            smallest = left;
+        }
+        if (right < size && lines[heap[right]].count < lines[heap[smallest]].count) {
+            smallest = right;
+        }
+        if (smallest == position) {
+            break;
+        }
+        swapHeap(smallest, position);
+        position = smallest;
+    }
+}
+
+int HotLineTracker::admit(address_t block) {
+    std::unordered_map<address_t, int>::iterator it = lineIndex.find(block);
+    if (it != lineIndex.end()) {
+        return it->second;
+    }
+
+    int index;
+    uint64_t inherited = 0;
+    if (static_cast<int>(lines.size()) < capacity) {
+        index = static_cast<int>(lines.size());
+        lines.push_back(HotLine());
+        lines.back().heapPosition = static_cast<int>(heap.size());
+        heap.push_back(index);
+        wordMasks.resize(wordMasks.size() + numCores, 0);
+    } else {
+        // Replace the coldest line; the new one may have had up to its count of events already
+        index = heap[0];
+        inherited = lines[index].count;
+        lineIndex.erase(lines[index].block);
+        std::fill(wordMasks.begin() + static_cast<size_t>(index) * numCores,
+                  wordMasks.begin() + static_cast<size_t>(index + 1) * numCores, 0);
+    }
+
+    HotLine& line = lines[index];
+    line.block = block;
+    line.count = inherited;
+    line.overcount = inherited;
+    std::fill(line.events, line.events + static_cast<int>(HotLineEvent::Count), 0);
+    lineIndex[block] = index;
+    siftUp(line.heapPosition);
+    return index;
+}
+
+void HotLineTracker::record(HotLineEvent event, int core, address_t addr) {
+    int index = admit(addr >> blockOffsetBits);
+    HotLine& line = lines[index];
+    line.count++;
+    line.events[static_cast<int>(event)]++;
+    siftDown(line.heapPosition);
+    if (event == HotLineEvent::Miss) {
+        wordMasks[static_cast<size_t>(index) * numCores + core] |= getWordBit(addr);
+    }
+}
+
+void HotLineTracker::touch(int core, address_t addr) {
+    std::unordered_map<address_t, int>::const_iterator it = lineIndex.find(addr >> blockOffsetBits);
+    if (it != lineIndex.end()) {
+        wordMasks[static_cast<size_t>(it->second) * numCores + core] |= getWordBit(addr);
+    }
+}
+
+std::vector<HotLineTracker::HotLine> HotLineTracker::getHottest(size_t count) const {
+    std::vector<HotLine> hottest(lines);
+    std::sort(hottest.begin(), hottest.end(), [](const HotLine& a, const HotLine& b) {
+        uint64_t seenA = a.count - a.overcount;
+        uint64_t seenB = b.count - b.overcount;
+        if (seenA != seenB) {
+            return seenA > seenB;
+        }
+        return a.count != b.count ? a.count > b.count : a.block < b.block;
+    });
+    if (hottest.size() > count) {
+        hottest.resize(count);
+    }
+    return hottest;
+}
+
+uint64_t HotLineTracker::getWordMask(address_t block, int core) const {
+    std::unordered_map<address_t, int>::const_iterator it = lineIndex.find(block);
+    return it != lineIndex.end() ? wordMasks[static_cast<size_t>(it->second) * numCores + core] : 0;
+}
+
+bool HotLineTracker::isFalseSharingCandidate(const HotLine& line) const {
+    if (line.events[static_cast<int>(HotLineEvent::Invalidation)] == 0) {
+        return false;
+    }
+    int sharers = 0;
+    uint64_t touched = 0;
+    for (int core = 0; core < numCores; core++) {
+        uint64_t mask = getWordMask(line.block, core);
+        if (mask == 0) {
+            continue;
+        }
+        if (touched & mask) {
+            return false;
+        }
+        touched |= mask;
+        sharers++;
+    }
+    return sharers >= 2;
+}
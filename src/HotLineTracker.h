@@ -0,0 +1,79 @@
+#ifndef HOT_LINE_TRACKER_H
+#define HOT_LINE_TRACKER_H
+
+#include <vector>
+#include <unordered_map>
+#include "Types.h"
+
+// Coherence events counted per line
+enum class HotLineEvent {
+    Invalidation,  // A cache lost the line to another core's BusRdX or InvalidateSig
+    Miss,          // A cache missed on the line
+    CacheToCache,  // A cache supplied the line to another core's BusRd
+    Count
+};
+
+// Bounded top-K of the lines with the most coherence events over all cores (space-saving
+// algorithm). A fixed number of lines is tracked; an untracked line takes the place of the
+// line with the fewest events and inherits its count as an overcount, so a line's count is
+// an upper bound that is off by at most its overcount. With m tracked lines, every line with
+// more than 1/m of the events is tracked. The tracked lines form a min-heap on their count,
+// so each event is a hash lookup and a sift of O(log m).
+//
+// Each line also keeps the words each core touched on it, from the accesses that missed or
+// upgraded the line (hits are not looked up, to keep them free). Cores that share a line
+// without sharing a word are a sign of false sharing.
+class HotLineTracker {
+public:
+    struct HotLine {
+        address_t block;      // Block address (addr >> b)
+        uint64_t count;       // Events, including the overcount
+        uint64_t overcount;   // Events of the line it replaced (at most this many were not seen)
+        uint64_t events[static_cast<int>(HotLineEvent::Count)];
+        int heapPosition;
+    };
+
+private:
+    std::vector<HotLine> lines;
+    std::vector<uint64_t> wordMasks;                  // line * numCores + core; bit per word (modulo 64)
+    std::vector<int> heap;                            // Line indices, fewest events first
+    std::unordered_map<address_t, int> lineIndex;     // Block -> line
+    int capacity;
+    int numCores;
+    int blockOffsetBits;
+
+    uint64_t getWordBit(address_t addr) const {
+        return uint64_t(1) << (((addr & ((static_cast<address_t>(1) << blockOffsetBits) - 1)) >> 2) & 63);
+    }
+
+    void swapHeap(int a, int b);
+    void siftUp(int position);
+    void siftDown(int position);
+
+    // The tracked line of a block, admitting it in place of the coldest line if needed
+    int admit(address_t block);
+
+public:
+    HotLineTracker(int capacity, int numCores, int blockOffsetBits);
+
+    // Count an event of core on the line holding addr
+    void record(HotLineEvent event, int core, address_t addr);
+
+    // Note the word of addr as touched by core: a miss marks it too, an upgrade (write hit on
+    // a shared line) only marks it when the line is already tracked
+    void touch(int core, address_t addr);
+
+    // The count hottest lines, most events seen since they were tracked first (lines tracked
+    // from the start rank above lines that inherited a large overcount)
+    std::vector<HotLine> getHottest(size_t count) const;
+
+    // Words of a tracked block touched by core (bit per word, modulo 64)
+    uint64_t getWordMask(address_t block, int core) const;
+
+    // Two or more cores touched the line, it was invalidated, and no word was touched by two cores
+    bool isFalseSharingCandidate(const HotLine& line) const;
+
+    int getCapacity() const { return capacity; }
+};
+
+#endif // HOT_LINE_TRACKER_H
@@ -0,0 +1,334 @@
+#include "Interconnect.h"
+#include "Cache.h"
+#include "Trace.h"
+#include "Checkpoint.h"
+#include <iostream>
+
+Interconnect::Interconnect(int blockSize) :
+    memoryController(nullptr),
+    eventLog(nullptr),
+    latencyStats(nullptr),
+    blockSizeBytes(1 << blockSize),
+    blockOffsetBits(blockSize),
+    totalDataTrafficBytes(0),
+    totalBusTransactions(0),
+    stagingEnabled(false) {
+}
+
+Interconnect::~Interconnect() {
+}
+
+void Interconnect::addCache(Cache* cache) {
+    caches.push_back(cache);
+    stagedRequests.resize(caches.size());
+    stagedCursor.resize(caches.size(), 0);
+    requestProgress.resize(caches.size(), RequestProgress{false, StallCause::Arbitration, -1});
+    TRACE(InterconnectCacheAdded, cache->getId());
+}
+
+void Interconnect::setMemoryController(MemoryController* controller) {
+    memoryController = controller;
+}
+
+void Interconnect::setEventLog(BusLogWriter* log) {
+    eventLog = log;
+}
+
+void Interconnect::setLatencyStats(LatencyStats* stats) {
+    latencyStats = stats;
+}
+
+void Interconnect::pushRequest(int requesterId, BusRequestType type, address_t address, cycle_t currentCycle) {
+    if (type != BusRequestType::WriteBack) {
+        requestProgress[requesterId] = RequestProgress{false, StallCause::Arbitration, -1};
+    }
+    if (stagingEnabled) {
+        StagedRequest request = {type, address, currentCycle};
+        stagedRequests[requesterId].push_back(request);
+        return;
+    }
+    enqueueRequest(requesterId, type, address, currentCycle);
+}
+
+void Interconnect::setRequestStaging(bool enabled) {
+    stagingEnabled = enabled;
+}
+
+void Interconnect::releaseStagedRequests(cycle_t cycle) {
+    // Same order as the serial engine: cores push in ID order within a cycle
+    for (size_t core = 0; core < stagedRequests.size(); core++) {
+        std::vector<StagedRequest>& staged = stagedRequests[core];
+        size_t& cursor = stagedCursor[core];
+        while (cursor < staged.size() && staged[cursor].cycle <= cycle) {
+            enqueueRequest(static_cast<int>(core), staged[cursor].type, staged[cursor].address, staged[cursor].cycle);
+            cursor++;
+        }
+        if (cursor == staged.size() && cursor > 0) {
+            staged.clear();
+            cursor = 0;
+        }
+    }
+}
+
+void Interconnect::markGranted(int requesterId, const BusTransaction& transaction) {
+    RequestProgress& progress = requestProgress[requesterId];
+    progress.granted = true;
+    if (transaction.type == BusRequestType::InvalidateSig) {
+        progress.cause = StallCause::Upgrade;
+    } else if (transaction.servedByCache) {
+        progress.cause = StallCause::CacheToCache;
+    } else {
+        progress.cause = StallCause::Memory;
+    }
+}
+
+bool Interconnect::isBehindWriteBack(int, int) const {
+    // Interconnects that can tell which writeback holds a request override this
+    return false;
+}
+
+bool Interconnect::writeBackCompletionUnblocks() const {
+    return memoryController == nullptr;
+}
+
+StallCause Interconnect::getStallCause(int core) const {
+    // The cache unblocks when the block arrives; a core still blocked then waits for its restart
+    if (!caches[core]->isBlocked()) {
+        return StallCause::Fill;
+    }
+    const RequestProgress& progress = requestProgress[core];
+    if (progress.granted) {
+        return progress.cause;
+    }
+    return progress.resource >= 0 && isBehindWriteBack(progress.resource, core) ?
+        StallCause::WriteBack : StallCause::Arbitration;
+}
+
+bool Interconnect::needsMemoryAccess(const BusTransaction& transaction, bool suppliedByCache) const {
+    // BusRdX always goes to memory, BusRd only when no cache supplied the block
+    return transaction.type == BusRequestType::WriteBack ||
+           transaction.type == BusRequestType::BusRdX ||
+           (transaction.type == BusRequestType::BusRd && !suppliedByCache);
+}
+
+uint64_t Interconnect::recordTransaction(cycle_t currentCycle, const BusTransaction& transaction) {
+    // Only count non-WriteBack operations as bus transactions
+    if (transaction.type != BusRequestType::WriteBack) {
+        totalBusTransactions++;
+    }
+    
+    // Update data traffic statistics
+    // All transactions that involve data transfers should be counted:
+    // 1. BusRd: Data transfer from memory or another cache
+    // 2. BusRdX: Data transfer from memory or another cache 
+    // 3. WriteBack: Data transfer from cache to memory
+    if (transaction.type == BusRequestType::BusRd ||
+        transaction.type == BusRequestType::BusRdX ||
+        transaction.type == BusRequestType::WriteBack) {
+        totalDataTrafficBytes += blockSizeBytes;
+        
+        TRACE(InterconnectTraffic, currentCycle, blockSizeBytes, transaction.type, totalDataTrafficBytes);
+        return blockSizeBytes;
+    }
+    
+    return 0;
+}
+
+bool Interconnect::functionalRequest(cycle_t currentCycle, int requesterId, BusRequestType type,
+                                     address_t address) {
+    BusTransaction transaction = {requesterId, type, address, currentCycle, currentCycle,
+                                  true, false, BusRequestPriority::NORMAL};
+    return broadcastSnoop(currentCycle, transaction);
+}
+
+bool Interconnect::broadcastSnoop(cycle_t currentCycle, const BusTransaction& transaction,
+                                  std::vector<int>* holders, int* supplierId) {
+    bool suppliedByCache = false;
+    
+    if (holders != nullptr) {
+        holders->clear();
+    }
+    if (supplierId != nullptr) {
+        *supplierId = -1;
+    }
+    if (eventLog != nullptr) {
+        snoopChanges.clear();
+    }
+    
+    TRACE(SnoopBroadcast, currentCycle, transaction.address, transaction.type);
+    
+    // Send snoop to all caches except requester
+    for (size_t i = 0; i < caches.size(); i++) {
+        if (static_cast<int>(i) != transaction.requesterId) {
+            // Record which caches held a valid copy before the snoop changes it
+            if (holders != nullptr && caches[i]->findBlock(transaction.address) != nullptr) {
+                holders->push_back(static_cast<int>(i));
+            }
+            
+            CacheLine* line = eventLog != nullptr ? caches[i]->findBlock(transaction.address) : nullptr;
+            CacheLineState oldState = line != nullptr ? line->getState() : CacheLineState::INVALID;
+            
+            bool responded = caches[i]->snoop(currentCycle, transaction.type, transaction.address,
+                                              transaction.requesterId);
+            
+            if (line != nullptr && line->getState() != oldState) {
+                snoopChanges.push_back(BusLog::packChange(static_cast<int>(i), oldState, line->getState()));
+            }
+            
+            // Set suppliedByCache to true only for BusRd requests when another cache supplies the data
+            // BusRdX should not get data directly from other caches
+            if (responded && transaction.type == BusRequestType::BusRd) {
+                suppliedByCache = true;
+                if (supplierId != nullptr) {
+                    *supplierId = static_cast<int>(i);
+                }
+                TRACE(SnoopResponse, currentCycle, i);
+                // In real hardware, we would break here since only one cache can respond,
+                // but for simulation correctness, we want to make sure all caches update their state
+            }
+        }
+    }
+    
+    return suppliedByCache;
+}
+
+void Interconnect::logTransaction(const BusTransaction& transaction, cycle_t grantCycle,
+                                  const std::vector<uint32_t>& changes, const std::vector<int>& joinedReaders) {
+    BusLogRecord& record = logRecord;
+    record.requesterId = transaction.requesterId;
+    record.type = transaction.type;
+    record.address = transaction.address;
+    record.servedByCache = transaction.servedByCache;
+    record.startCycle = transaction.startCycle;
+    record.grantCycle = grantCycle;
+    record.completionCycle = transaction.completionCycle;
+    record.joinedReaders = static_cast<int>(joinedReaders.size());
+    
+    // Same final states as notifyRequester; readers sharing a response all end up Shared
+    if (transaction.type == BusRequestType::WriteBack) {
+        record.requesterState = CacheLineState::INVALID;
+    } else if (transaction.type == BusRequestType::BusRd) {
+        record.requesterState = (transaction.servedByCache || !joinedReaders.empty()) ?
+            CacheLineState::SHARED : CacheLineState::EXCLUSIVE;
+    } else {
+        record.requesterState = CacheLineState::MODIFIED;
+    }
+    
+    record.changes = changes;
+    for (int reader : joinedReaders) {
+        record.changes.push_back(BusLog::packChange(reader, CacheLineState::INVALID, CacheLineState::SHARED));
+    }
+    eventLog->write(record);
+}
+
+void Interconnect::notifyRequester(cycle_t currentCycle, const BusTransaction& transaction) {
+    // Handle WriteBack case first
+    if (transaction.type == BusRequestType::WriteBack) {
+        // For WriteBack, just need to notify cache that writeback is complete
+        TRACE(WriteBackComplete, currentCycle, transaction.requesterId);
+        
+        // A writeback can complete long after the cache issued its next miss, so it must not
+        // unblock that miss; only the fixed-latency bus keeps the original behaviour, where
+        // the completion unblocks the cache
+        if (!writeBackCompletionUnblocks()) {
+            return;
+        }
+                  
+        // For a writeback, we set the state to INVALID to indicate this was a writeback completion
+        // This is a convention between the Bus and Cache classes - writebacks don't update any line's state
+        // but we need to distinguish them from other transactions
+        caches[transaction.requesterId]->notifyTransactionComplete(
+            currentCycle, transaction.address, CacheLineState::INVALID);
+        return;
+    } else if (transaction.type == BusRequestType::InvalidateSig) {
+        // For InvalidateSig, no need to allocate a block or update state
+        // This is a write hit to a shared line, so the state should be modified
+        TRACE(InvalidateComplete, currentCycle, transaction.requesterId);
+                    
+        // Set state to MODIFIED since this was a write hit to a shared line
+        caches[transaction.requesterId]->notifyTransactionComplete(
+            currentCycle, transaction.address, CacheLineState::MODIFIED);
+        return;
+    }
+    
+    // For read/write requests, determine the appropriate new state for the block
+    CacheLineState newState;
+    
+    if (transaction.type == BusRequestType::BusRd) {
+        // If another cache has the block, it goes to Shared
+        // Otherwise, it goes to Exclusive
+        newState = transaction.servedByCache ? 
+            CacheLineState::SHARED : CacheLineState::EXCLUSIVE;
+            
+        TRACE(ReadComplete, currentCycle, transaction.requesterId, transaction.servedByCache ? "yes" : "no",
+              newState);
+    } else if (transaction.type == BusRequestType::BusRdX) {
+        // Always goes to Modified for BusRdX, regardless of whether another cache had it
+        newState = CacheLineState::MODIFIED;
+        
+        TRACE(ReadExclusiveComplete, currentCycle, transaction.requesterId, newState);
+    } else {
+        std::cerr << "ERROR: Invalid transaction type in notifyRequester: " 
+                  << static_cast<int>(transaction.type) << std::endl;
+        return;
+    }
+    
+    // Notify the requesting cache
+    caches[transaction.requesterId]->notifyTransactionComplete(
+        currentCycle, transaction.address, newState);
+}
+
+void Interconnect::saveState(CheckpointWriter& writer) const {
+    writer.write(totalDataTrafficBytes);
+    writer.write(totalBusTransactions);
+    for (const RequestProgress& progress : requestProgress) {
+        writer.write(progress.granted);
+        writer.write(progress.cause);
+        writer.write(progress.resource);
+    }
+}
+
+void Interconnect::loadState(CheckpointReader& reader) {
+    reader.read(totalDataTrafficBytes);
+    reader.read(totalBusTransactions);
+    for (RequestProgress& progress : requestProgress) {
+        reader.read(progress.granted);
+        reader.read(progress.cause);
+        reader.read(progress.resource);
+    }
+}
+
+uint64_t Interconnect::getTotalDataTrafficBytes() const {
+    return totalDataTrafficBytes;
+}
+
+uint64_t Interconnect::getTotalBusTransactions() const {
+    return totalBusTransactions;
+}
+
+int Interconnect::getBlockSizeBytes() const {
+    return blockSizeBytes;
+}
+
+// Helper for debugging
+std::string Interconnect::getBusRequestTypeString(BusRequestType type) const {
+    switch (type) {
+        case BusRequestType::BusRd: return "BusRd";
+        case BusRequestType::BusRdX: return "BusRdX";
+        case BusRequestType::WriteBack: return "WriteBack";
+        case BusRequestType::InvalidateSig: return "InvalidateSig";
+        case BusRequestType::None: return "None";
+        default: return "Unknown";
+    }
+}
+
+// Helper for debugging
+std::string Interconnect::getCacheLineStateString(CacheLineState state) const {
+    switch (state) {
+        case CacheLineState::MODIFIED: return "Modified";
+        case CacheLineState::EXCLUSIVE: return "Exclusive";
+        case CacheLineState::SHARED: return "Shared";
+        case CacheLineState::INVALID: return "Invalid";
+        default: return "Unknown";
+    }
+}
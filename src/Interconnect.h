@@ -0,0 +1,155 @@
+#ifndef INTERCONNECT_H
+#define INTERCONNECT_H
+
+#include <vector>
+#include <string>
+#include <ostream>
+#include "Types.h"
+#include "BusLog.h"
+
+// Forward declarations to avoid circular dependencies
+class Cache;
+class MemoryController;
+class CheckpointWriter;
+class CheckpointReader;
+class LatencyStats;
+
+// Interconnect base class shared by every coherence fabric (shared bus, ring, mesh).
+// It owns the connected caches and the MESI snoop/notify logic; subclasses decide
+// how requests are queued, ordered and how long each transaction takes.
+class Interconnect {
+protected:
+    std::vector<Cache*> caches;        // Connected caches
+
+    const int memoryLatency = 100;     // Memory access latency in cycles (fixed-latency memory)
+    MemoryController* memoryController; // Banked DRAM model, or nullptr for fixed latency
+    
+    // Bus event log (nullptr = off). While it is on, every snoop collects the state changes
+    // it caused in snoopChanges; the subclass keeps them with the transaction until it completes.
+    BusLogWriter* eventLog;
+    std::vector<uint32_t> snoopChanges;
+    BusLogRecord logRecord;            // Scratch record reused by every completion
+
+    LatencyStats* latencyStats;        // Latency histograms fed at every completion (nullptr = off)
+
+    int blockSizeBytes;                // Size of cache block in bytes
+    int blockOffsetBits;               // log2(blockSizeBytes)
+
+    // Statistics
+    uint64_t totalDataTrafficBytes;    // Total data transferred (bytes)
+    uint64_t totalBusTransactions;     // Total number of coherence transactions
+    
+    // Requests issued by the cores while they run in parallel. Each core only appends
+    // to its own buffer, so no locking is needed; the simulator releases them into the
+    // interconnect serially, in cycle and core order, at quantum boundaries.
+    struct StagedRequest {
+        BusRequestType type;
+        address_t address;
+        cycle_t cycle;
+    };
+    bool stagingEnabled;
+    std::vector<std::vector<StagedRequest>> stagedRequests; // Per requesting core
+    std::vector<size_t> stagedCursor;                       // Next unreleased request per core
+    
+    // Progress of each core's outstanding demand request (BusRd, BusRdX, InvalidateSig),
+    // so that every cycle a core is blocked can be attributed to a stall cause
+    struct RequestProgress {
+        bool granted;
+        StallCause cause;      // Once granted
+        int resource;          // Slice or home node the queued request waits at (-1 = not yet queued)
+    };
+    std::vector<RequestProgress> requestProgress;
+    
+    // Record the stall cause of a granted request (also for readers sharing its response)
+    void markGranted(int requesterId, const BusTransaction& transaction);
+    
+    // Is the resource busy with a writeback of a core other than requesterId?
+    virtual bool isBehindWriteBack(int resource, int requesterId) const;
+    
+    // Does a writeback completion unblock its cache? Only the fixed-latency bus keeps this
+    // original behaviour; elsewhere a writeback can complete while the cache waits on a later miss
+    virtual bool writeBackCompletionUnblocks() const;
+    
+    // Queue a request in the interconnect (called directly, or when a staged request is released)
+    virtual void enqueueRequest(int requesterId, BusRequestType type, address_t address, cycle_t currentCycle) = 0;
+
+    // Snoop all caches except the requester; returns true if a cache supplied the data.
+    // When holders is given it receives the IDs of the caches that held a valid copy
+    // before the snoop, and supplierId the cache that supplied the data (or -1).
+    bool broadcastSnoop(cycle_t currentCycle, const BusTransaction& transaction,
+                        std::vector<int>* holders = nullptr, int* supplierId = nullptr);
+
+    // Append a completed transaction to the event log. changes are the snoop state changes
+    // collected at grant; joinedReaders the coalesced readers that shared the response.
+    void logTransaction(const BusTransaction& transaction, cycle_t grantCycle,
+                        const std::vector<uint32_t>& changes, const std::vector<int>& joinedReaders);
+    
+    // Deliver the final MESI state to the requesting cache
+    void notifyRequester(cycle_t currentCycle, const BusTransaction& transaction);
+
+    // Does the transaction read from or write to main memory?
+    bool needsMemoryAccess(const BusTransaction& transaction, bool suppliedByCache) const;
+
+    // Account a granted transaction in the global transaction/traffic counters.
+    // Returns the number of data bytes the transaction moves.
+    uint64_t recordTransaction(cycle_t currentCycle, const BusTransaction& transaction);
+
+    // Debug helpers
+    std::string getBusRequestTypeString(BusRequestType type) const;
+    std::string getCacheLineStateString(CacheLineState state) const;
+
+public:
+    // Constructor takes block size bits
+    Interconnect(int blockSize);
+    virtual ~Interconnect();
+
+    // Register a cache to the interconnect
+    void addCache(Cache* cache);
+
+    // Route memory accesses through a DRAM controller instead of the fixed memory latency
+    void setMemoryController(MemoryController* controller);
+    
+    // Record every completed transaction in a bus event log (nullptr turns logging off)
+    void setEventLog(BusLogWriter* log);
+
+    // Record the queueing, service and end-to-end latency of every completed transaction
+    void setLatencyStats(LatencyStats* stats);
+
+    // Push a new request from a cache (staged instead while request staging is enabled)
+    void pushRequest(int requesterId, BusRequestType type, address_t address, cycle_t currentCycle);
+    
+    // Parallel engine support: stage requests per core, then release those issued in a given cycle
+    void setRequestStaging(bool enabled);
+    void releaseStagedRequests(cycle_t cycle);
+
+    // Apply a request's snoops at once, without queueing, timing or traffic accounting
+    // (functional fast-forward). Returns true if another cache supplied the data.
+    bool functionalRequest(cycle_t currentCycle, int requesterId, BusRequestType type, address_t address);
+
+    // Process one cycle of interconnect activity
+    virtual void tick(cycle_t currentCycle) = 0;
+
+    // What a blocked core waits for this cycle (see StallCause)
+    StallCause getStallCause(int core) const;
+
+    // Number of requests waiting to be granted
+    virtual size_t getQueueSize() const = 0;
+
+    // Checkpointing: queues, transactions in progress and statistics. Checkpoints are taken
+    // between cycles, when no request is staged. Subclasses extend the base state.
+    virtual void saveState(CheckpointWriter& writer) const;
+    virtual void loadState(CheckpointReader& reader);
+
+    // Parameter lines for the stats header and the interconnect-specific stats section
+    virtual void printParameters(std::ostream& out) const = 0;
+    virtual void printStats(std::ostream& out, cycle_t totalCycles) const = 0;
+
+    // Get statistics
+    uint64_t getTotalDataTrafficBytes() const;
+    uint64_t getTotalBusTransactions() const;
+
+    // Get block size
+    int getBlockSizeBytes() const;
+};
+
+#endif // INTERCONNECT_H
@@ -0,0 +1,225 @@
+#include "IntervalStats.h"
+#include "Core.h"
+#include "Cache.h"
+#include "Interconnect.h"
+#include <cstdio>
+
+static const size_t bufferBytes = 1 << 16;
+
+// Idle cycle columns, in StallCause order
+static const char* const stallColumns[] = {
+    "arbitration", "writeback", "memory", "cache_to_cache", "upgrade", "fill"
+};
+static const int stallCauses = static_cast<int>(StallCause::Count);
+static_assert(sizeof(stallColumns) / sizeof(stallColumns[0]) == stallCauses, "one column per stall cause");
+
+DoubleBufferedWriter::DoubleBufferedWriter() : backFull(false), stopping(false) {
+}
+
+DoubleBufferedWriter::~DoubleBufferedWriter() {
+    close();
+}
+
+bool DoubleBufferedWriter::open(const std::string& fileName) {
+    file.open(fileName, std::ios::trunc);
+    if (!file.is_open()) {
+        return false;
+    }
+    front.reserve(bufferBytes + 4096);
+    back.reserve(bufferBytes + 4096);
+    backFull = false;
+    stopping = false;
+    writer = std::thread(&DoubleBufferedWriter::writerLoop, this);
+    return true;
+}
+
+void DoubleBufferedWriter::writerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        condition.wait(lock, [this] { return backFull || stopping; });
+        if (backFull) {
+            // The back buffer belongs to this thread until backFull is cleared
+            lock.unlock();
+            file.write(back.data(), static_cast<std::streamsize>(back.size()));
+            back.clear();
+            lock.lock();
+            backFull = false;
+            condition.notify_all();
+        } else {
+            return;
+        }
+    }
+}
+
+void DoubleBufferedWriter::handOff() {
+    std::unique_lock<std::mutex> lock(mutex);
+    condition.wait(lock, [this] { return !backFull; });
+    front.swap(back);
+    backFull = true;
+    condition.notify_all();
+}
+
+void DoubleBufferedWriter::append(const std::string& text) {
+    front += text;
+    if (front.size() >= bufferBytes) {
+        handOff();
+    }
+}
+
+void DoubleBufferedWriter::close() {
+    if (!writer.joinable()) {
+        return;
+    }
+    if (!front.empty()) {
+        handOff();
+    }
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait(lock, [this] { return !backFull; });
+        stopping = true;
+        condition.notify_all();
+    }
+    writer.join();
+    file.close();
+}
+
+IntervalSampler::IntervalSampler() :
+    numCores(0),
+    intervalCycles(0),
+    intervalInstructions(0),
+    intervals(0),
+    started(false),
+    queueDepthSum(0),
+    queueDepthMax(0) {
+}
+
+bool IntervalSampler::open(const std::string& name, int cores, cycle_t cycles, uint64_t instructions) {
+    if (!writer.open(name)) {
+        return false;
+    }
+    fileName = name;
+    numCores = cores;
+    intervalCycles = cycles;
+    intervalInstructions = instructions;
+
+    std::string header = "interval,start_cycle,end_cycle,instructions,bus_transactions,traffic_bytes,"
+                         "queue_depth_avg,queue_depth_max";
+    for (int i = 0; i < numCores; i++) {
+        std::string core = ",core" + std::to_string(i) + "_";
+        header += core + "instructions" + core + "accesses" + core + "misses" + core + "miss_rate" +
+                  core + "invalidations" + core + "writebacks" + core + "idle_cycles";
+        for (const char* cause : stallColumns) {
+            header += core + "stall_" + cause;
+        }
+    }
+    writer.append(header + "\n");
+    return true;
+}
+
+void IntervalSampler::takeSnapshot(Snapshot& snapshot, cycle_t cycle, const std::vector<Core>& cores,
+                                   const std::vector<Cache>& caches, const Interconnect& interconnect) const {
+    snapshot.cycle = cycle;
+    snapshot.instructions = 0;
+    snapshot.busTransactions = interconnect.getTotalBusTransactions();
+    snapshot.trafficBytes = interconnect.getTotalDataTrafficBytes();
+    snapshot.coreInstructions.resize(numCores);
+    snapshot.accesses.resize(numCores);
+    snapshot.misses.resize(numCores);
+    snapshot.invalidations.resize(numCores);
+    snapshot.writebacks.resize(numCores);
+    snapshot.idleCycles.resize(numCores);
+    snapshot.stallCycles.resize(numCores * stallCauses);
+    for (int i = 0; i < numCores; i++) {
+        snapshot.coreInstructions[i] = cores[i].getInstructionCount();
+        snapshot.instructions += snapshot.coreInstructions[i];
+        snapshot.accesses[i] = caches[i].getAccesses();
+        snapshot.misses[i] = caches[i].getMisses();
+        snapshot.invalidations[i] = caches[i].getInvalidationsReceived();
+        snapshot.writebacks[i] = caches[i].getWritebacks();
+        snapshot.idleCycles[i] = cores[i].getIdleCycles();
+        for (int cause = 0; cause < stallCauses; cause++) {
+            snapshot.stallCycles[i * stallCauses + cause] = cores[i].getStallCycles(static_cast<StallCause>(cause));
+        }
+    }
+}
+
+void IntervalSampler::writeInterval(cycle_t endCycle, const std::vector<Core>& cores,
+                                    const std::vector<Cache>& caches, const Interconnect& interconnect) {
+    Snapshot end;
+    takeSnapshot(end, endCycle, cores, caches, interconnect);
+    cycle_t cycles = endCycle - start.cycle;
+
+    char depth[64];
+    std::snprintf(depth, sizeof(depth), "%.2f,%zu",
+                  cycles > 0 ? static_cast<double>(queueDepthSum) / cycles : 0.0, queueDepthMax);
+    std::string row = std::to_string(intervals) + "," + std::to_string(start.cycle) + "," +
+                      std::to_string(endCycle) + "," + std::to_string(end.instructions - start.instructions) + "," +
+                      std::to_string(end.busTransactions - start.busTransactions) + "," +
+                      std::to_string(end.trafficBytes - start.trafficBytes) + "," + depth;
+    for (int i = 0; i < numCores; i++) {
+        uint64_t accesses = end.accesses[i] - start.accesses[i];
+        uint64_t misses = end.misses[i] - start.misses[i];
+        char missRate[32];
+        std::snprintf(missRate, sizeof(missRate), "%.4f",
+                      accesses > 0 ? static_cast<double>(misses) / accesses : 0.0);
+        row += "," + std::to_string(end.coreInstructions[i] - start.coreInstructions[i]) + "," +
+               std::to_string(accesses) + "," + std::to_string(misses) + "," + missRate + "," +
+               std::to_string(end.invalidations[i] - start.invalidations[i]) + "," +
+               std::to_string(end.writebacks[i] - start.writebacks[i]) + "," +
+               std::to_string(end.idleCycles[i] - start.idleCycles[i]);
+        for (int cause = i * stallCauses; cause < (i + 1) * stallCauses; cause++) {
+            row += "," + std::to_string(end.stallCycles[cause] - start.stallCycles[cause]);
+        }
+    }
+    writer.append(row + "\n");
+
+    intervals++;
+    start = end;
+    queueDepthSum = 0;
+    queueDepthMax = 0;
+}
+
+void IntervalSampler::begin(cycle_t cycle, const std::vector<Core>& cores, const std::vector<Cache>& caches,
+                            const Interconnect& interconnect) {
+    takeSnapshot(start, cycle, cores, caches, interconnect);
+    started = true;
+}
+
+void IntervalSampler::sample(cycle_t cycle, const std::vector<Core>& cores, const std::vector<Cache>& caches,
+                             const Interconnect& interconnect) {
+    size_t depth = interconnect.getQueueSize();
+    queueDepthSum += depth;
+    if (depth > queueDepthMax) {
+        queueDepthMax = depth;
+    }
+
+    bool intervalDone;
+    if (intervalCycles > 0) {
+        intervalDone = cycle + 1 - start.cycle >= intervalCycles;
+    } else {
+        uint64_t instructions = 0;
+        for (const Core& core : cores) {
+            instructions += core.getInstructionCount();
+        }
+        intervalDone = instructions - start.instructions >= intervalInstructions;
+    }
+    if (intervalDone) {
+        writeInterval(cycle + 1, cores, caches, interconnect);
+    }
+}
+
+void IntervalSampler::finish(cycle_t endCycle, const std::vector<Core>& cores, const std::vector<Cache>& caches,
+                             const Interconnect& interconnect) {
+    if (started && endCycle > start.cycle) {
+        writeInterval(endCycle, cores, caches, interconnect);
+    }
+    writer.close();
+}
+
+const std::string& IntervalSampler::getFileName() const {
+    return fileName;
+}
+
+uint64_t IntervalSampler::getIntervals() const {
+    return intervals;
+}
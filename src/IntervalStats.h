@@ -0,0 +1,105 @@
+#ifndef INTERVAL_STATS_H
+#define INTERVAL_STATS_H
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "Types.h"
+
+class Core;
+class Cache;
+class Interconnect;
+
+// Text file written through two buffers: the simulation fills one while a background
+// thread writes the other, so file output never stalls the simulation loop unless the
+// writer falls a whole buffer behind.
+class DoubleBufferedWriter {
+private:
+    std::ofstream file;
+    std::string front;        // Filled by the caller
+    std::string back;         // Being written by the writer thread
+
+    std::thread writer;
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool backFull;            // Guarded by mutex
+    bool stopping;
+
+    void writerLoop();
+    void handOff();           // Give the front buffer to the writer thread
+
+public:
+    DoubleBufferedWriter();
+    ~DoubleBufferedWriter();
+
+    // Create the file and start the writer thread; returns false if it cannot be created
+    bool open(const std::string& fileName);
+
+    void append(const std::string& text);
+
+    // Write everything appended so far, stop the writer thread and close the file
+    void close();
+};
+
+// Time series of the run: every interval of a number of cycles, or of instructions over all
+// cores, one CSV row with what each core and the interconnect did in the interval. Counts
+// are per interval, not cumulative; the last row covers the partial interval at the end.
+class IntervalSampler {
+private:
+    // Counter values at the start of the current interval
+    struct Snapshot {
+        cycle_t cycle;
+        uint64_t instructions;
+        uint64_t busTransactions;
+        uint64_t trafficBytes;
+        std::vector<uint64_t> coreInstructions;
+        std::vector<uint64_t> accesses;
+        std::vector<uint64_t> misses;
+        std::vector<uint64_t> invalidations;
+        std::vector<uint64_t> writebacks;
+        std::vector<uint64_t> idleCycles;
+        std::vector<uint64_t> stallCycles;    // core * StallCause::Count + cause
+    };
+
+    DoubleBufferedWriter writer;
+    std::string fileName;
+    int numCores;
+    cycle_t intervalCycles;         // 0 when intervals are counted in instructions
+    uint64_t intervalInstructions;
+    uint64_t intervals;
+    bool started;
+    Snapshot start;
+    uint64_t queueDepthSum;         // Queued interconnect requests summed over the interval's cycles
+    size_t queueDepthMax;
+
+    void takeSnapshot(Snapshot& snapshot, cycle_t cycle, const std::vector<Core>& cores,
+                      const std::vector<Cache>& caches, const Interconnect& interconnect) const;
+    void writeInterval(cycle_t endCycle, const std::vector<Core>& cores, const std::vector<Cache>& caches,
+                       const Interconnect& interconnect);
+
+public:
+    IntervalSampler();
+
+    // Create the CSV; exactly one of cycles and instructions is positive
+    bool open(const std::string& fileName, int numCores, cycle_t cycles, uint64_t instructions);
+
+    // Start the first interval at cycle (the restored cycle after --restore)
+    void begin(cycle_t cycle, const std::vector<Core>& cores, const std::vector<Cache>& caches,
+               const Interconnect& interconnect);
+
+    // Called at the end of every simulated cycle
+    void sample(cycle_t cycle, const std::vector<Core>& cores, const std::vector<Cache>& caches,
+                const Interconnect& interconnect);
+
+    // Write the last, partial interval (ending before endCycle) and close the file
+    void finish(cycle_t endCycle, const std::vector<Core>& cores, const std::vector<Cache>& caches,
+                const Interconnect& interconnect);
+
+    const std::string& getFileName() const;
+    uint64_t getIntervals() const;
+};
+
+#endif // INTERVAL_STATS_H
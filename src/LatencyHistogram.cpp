@@ -0,0 +1,87 @@
+#include "LatencyHistogram.h"
+#include "BusLog.h"
+#include <cmath>
+#include <iomanip>
+
+LatencyHistogram::LatencyHistogram() : total(0), sum(0), max(0) {
+    counts.fill(0);
+}
+
+uint64_t LatencyHistogram::getBucketHighValue(size_t bucket) {
+    if (bucket < (size_t(2) << subBucketBits)) {
+        return bucket;
+    }
+    int shift = static_cast<int>(bucket >> subBucketBits) - 1;
+    uint64_t low = static_cast<uint64_t>(bucket - (static_cast<size_t>(shift) << subBucketBits)) << shift;
+    return low + (uint64_t(1) << shift) - 1;
+}
+
+uint64_t LatencyHistogram::getCount() const {
+    return total;
+}
+
+uint64_t LatencyHistogram::getMax() const {
+    return max;
+}
+
+double LatencyHistogram::getMean() const {
+    return total > 0 ? static_cast<double>(sum) / total : 0.0;
+}
+
+uint64_t LatencyHistogram::getPercentile(double percentile) const {
+    if (total == 0) {
+        return 0;
+    }
+    uint64_t rank = static_cast<uint64_t>(std::ceil(percentile / 100.0 * total));
+    if (rank < 1) {
+        rank = 1;
+    }
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < bucketCount; bucket++) {
+        seen += counts[bucket];
+        if (seen >= rank) {
+            // The bucket's values are equivalent; report its top, but never above the maximum
+            uint64_t value = getBucketHighValue(bucket);
+            return value < max ? value : max;
+        }
+    }
+    return max;
+}
+
+void LatencyHistogram::print(std::ostream& out) const {
+    out << "p50: " << getPercentile(50.0) << ", p90: " << getPercentile(90.0)
+        << ", p99: " << getPercentile(99.0) << ", p99.9: " << getPercentile(99.9)
+        << ", Max: " << max << ", Mean: " << std::fixed << std::setprecision(2) << getMean() << std::endl;
+}
+
+LatencyStats::LatencyStats(int numCores) :
+    coreHistograms(numCores * MetricCount),
+    typeHistograms(typeCount * MetricCount) {
+}
+
+void LatencyStats::printMetrics(std::ostream& out, const LatencyHistogram* histograms) {
+    out << "Queueing Delay (cycles): ";
+    histograms[Queueing].print(out);
+    out << "Service Time (cycles): ";
+    histograms[Service].print(out);
+    out << "End-to-End Latency (cycles): ";
+    histograms[EndToEnd].print(out);
+}
+
+void LatencyStats::printCoreStats(std::ostream& out, int core) const {
+    const LatencyHistogram* histograms = &coreHistograms[core * MetricCount];
+    out << "Bus Requests: " << histograms[Queueing].getCount() << std::endl;
+    printMetrics(out, histograms);
+}
+
+void LatencyStats::printTypeStats(std::ostream& out) const {
+    static const BusRequestType types[] = {
+        BusRequestType::BusRd, BusRequestType::BusRdX, BusRequestType::InvalidateSig, BusRequestType::WriteBack
+    };
+    for (BusRequestType type : types) {
+        const LatencyHistogram* histograms = &typeHistograms[(static_cast<int>(type) - 1) * MetricCount];
+        out << std::endl << BusLog::getTypeName(type) << " Latency:" << std::endl;
+        out << "Transactions: " << histograms[Queueing].getCount() << std::endl;
+        printMetrics(out, histograms);
+    }
+}
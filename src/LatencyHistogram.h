@@ -0,0 +1,106 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <vector>
+#include <array>
+#include <ostream>
+#include "Types.h"
+
+// Log-linear (HDR-style) histogram of cycle counts. Values below 128 have a bucket each;
+// above, every power of two is split into 64 buckets, so a reported value is within 1/64
+// (1.6%) of the recorded one. The buckets are a fixed array, so recording is a bit scan
+// and an increment, with no allocation.
+class LatencyHistogram {
+public:
+    static const int subBucketBits = 6;   // 64 buckets per power of two
+    static const int maxValueBits = 40;   // Larger values are recorded as 2^40 - 1
+    static const size_t bucketCount = ((maxValueBits - subBucketBits - 1) << subBucketBits) +
+                                      (2 << subBucketBits);
+
+private:
+    std::array<uint64_t, bucketCount> counts;
+    uint64_t total;
+    uint64_t sum;
+    uint64_t max;
+
+    static size_t getBucket(uint64_t value) {
+        if (value >> maxValueBits) {
+            value = (uint64_t(1) << maxValueBits) - 1;
+        }
+        if (value < (uint64_t(2) << subBucketBits)) {
+            return static_cast<size_t>(value);
+        }
+        int shift = 63 - __builtin_clzll(value) - subBucketBits;
+        return (static_cast<size_t>(shift) << subBucketBits) + static_cast<size_t>(value >> shift);
+    }
+
+    // Largest value that falls into a bucket
+    static uint64_t getBucketHighValue(size_t bucket);
+
+public:
+    LatencyHistogram();
+
+    void record(uint64_t value) {
+        counts[getBucket(value)]++;
+        total++;
+        sum += value;
+        if (value > max) {
+            max = value;
+        }
+    }
+
+    uint64_t getCount() const;
+    uint64_t getMax() const;
+    double getMean() const;
+
+    // Smallest recorded value (to the histogram's precision) with at least percentile % of
+    // the values at or below it; 0 if nothing was recorded
+    uint64_t getPercentile(double percentile) const;
+
+    // "p50: 4, p90: 12, p99: 140, p99.9: 301, Max: 305, Mean: 6.20"
+    void print(std::ostream& out) const;
+};
+
+// Queueing delay (request pushed to grant), service time (grant to completion) and
+// end-to-end latency of every completed interconnect transaction, per requesting core
+// and per request type. The per-core histograms hold the core's demand requests (BusRd,
+// BusRdX, InvalidateSig), the ones that stall it; writebacks only appear by type.
+class LatencyStats {
+private:
+    enum Metric { Queueing, Service, EndToEnd, MetricCount };
+    static const int typeCount = 4;       // WriteBack, BusRd, BusRdX, InvalidateSig
+
+    std::vector<LatencyHistogram> coreHistograms;    // core * MetricCount + metric
+    std::vector<LatencyHistogram> typeHistograms;    // (type - 1) * MetricCount + metric
+
+    static void recordMetrics(LatencyHistogram* histograms, uint64_t queueing, uint64_t service) {
+        histograms[Queueing].record(queueing);
+        histograms[Service].record(service);
+        histograms[EndToEnd].record(queueing + service);
+    }
+
+    static void printMetrics(std::ostream& out, const LatencyHistogram* histograms);
+
+public:
+    explicit LatencyStats(int numCores);
+
+    // Called when a transaction completes (completionCycle is final)
+    void record(const BusTransaction& transaction, cycle_t grantCycle) {
+        uint64_t queueing = grantCycle - transaction.startCycle;
+        uint64_t service = transaction.completionCycle - grantCycle;
+        int type = static_cast<int>(transaction.type) - 1;
+        if (type < 0 || type >= typeCount) {
+            return;
+        }
+        recordMetrics(&typeHistograms[type * MetricCount], queueing, service);
+        if (transaction.type != BusRequestType::WriteBack) {
+            recordMetrics(&coreHistograms[transaction.requesterId * MetricCount], queueing, service);
+        }
+    }
+
+    // Lines for a core's statistics section, and one section per request type
+    void printCoreStats(std::ostream& out, int core) const;
+    void printTypeStats(std::ostream& out) const;
+};
+
+#endif // LATENCY_HISTOGRAM_H
@@ -0,0 +1,327 @@
+#include "MemoryController.h"
+#include "Trace.h"
+#include "Checkpoint.h"
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+
+MemoryController::MemoryController(int blockSize, const DramParameters& params) :
+    params(params),
+    blockOffsetBits(blockSize),
+    nextTicket(0),
+    reads(0),
+    writes(0),
+    rowHits(0),
+    rowEmpty(0),
+    rowConflicts(0),
+    bankConflicts(0),
+    totalLatency(0),
+    totalQueueingDelay(0) {
+
+    blocksPerRow = std::max(1, params.rowSizeBytes >> blockOffsetBits);
+
+    Bank precharged = {-1, 0};
+    channelQueues.resize(params.channels);
+    banks.assign(params.channels, std::vector<Bank>(params.ranks * params.banksPerRank, precharged));
+    channelBusFreeCycle.assign(params.channels, 0);
+
+    TRACE(MemoryInit, params.channels, params.ranks, params.banksPerRank, blocksPerRow);
+}
+
+void MemoryController::decodeAddress(address_t address, int& channel, int& bank, int& row) const {
+    // row | rank | bank | channel | column | block offset
+    address_t blockAddress = address >> blockOffsetBits;
+    address_t rest = blockAddress / blocksPerRow;
+
+    channel = static_cast<int>(rest % params.channels);
+    rest /= params.channels;
+    int bankInRank = static_cast<int>(rest % params.banksPerRank);
+    rest /= params.banksPerRank;
+    int rank = static_cast<int>(rest % params.ranks);
+    rest /= params.ranks;
+
+    bank = rank * params.banksPerRank + bankInRank;
+    row = static_cast<int>(rest);
+}
+
+uint64_t MemoryController::enqueue(address_t address, bool isWrite, cycle_t arrivalCycle) {
+    Request request;
+    request.ticket = nextTicket++;
+    request.address = address;
+    request.isWrite = isWrite;
+    request.arrivalCycle = arrivalCycle;
+    request.waitedForBank = false;
+    decodeAddress(address, request.channel, request.bank, request.row);
+
+    channelQueues[request.channel].push_back(request);
+
+    TRACE(MemoryQueued, arrivalCycle, isWrite ? "write" : "read", address, request.channel, request.bank,
+          request.row);
+
+    return request.ticket;
+}
+
+int MemoryController::selectRequest(int channel, cycle_t currentCycle) {
+    std::deque<Request>& queue = channelQueues[channel];
+    std::vector<Bank>& channelBanks = banks[channel];
+
+    int oldest = -1;
+    int oldestRowHit = -1;
+
+    for (size_t i = 0; i < queue.size(); i++) {
+        Request& request = queue[i];
+        if (request.arrivalCycle > currentCycle) {
+            continue;
+        }
+
+        const Bank& bank = channelBanks[request.bank];
+        bool bankReady = bank.readyCycle <= currentCycle;
+        if (!bankReady) {
+            request.waitedForBank = true;
+        }
+
+        // FCFS only ever considers the oldest arrived request, ready or not
+        if (oldest < 0 || request.arrivalCycle < queue[oldest].arrivalCycle) {
+            oldest = static_cast<int>(i);
+        }
+        if (bankReady && bank.openRow == request.row &&
+            (oldestRowHit < 0 || request.arrivalCycle < queue[oldestRowHit].arrivalCycle)) {
+            oldestRowHit = static_cast<int>(i);
+        }
+    }
+
+    if (oldest < 0) {
+        return -1;
+    }
+
+    if (params.scheduling == MemorySchedulingPolicy::FRFCFS) {
+        if (oldestRowHit >= 0) {
+            return oldestRowHit;
+        }
+
+        // No ready row hit: oldest request whose bank can take a command
+        int oldestReady = -1;
+        for (size_t i = 0; i < queue.size(); i++) {
+            const Request& request = queue[i];
+            if (request.arrivalCycle <= currentCycle &&
+                channelBanks[request.bank].readyCycle <= currentCycle &&
+                (oldestReady < 0 || request.arrivalCycle < queue[oldestReady].arrivalCycle)) {
+                oldestReady = static_cast<int>(i);
+            }
+        }
+        return oldestReady;
+    }
+
+    return channelBanks[queue[oldest].bank].readyCycle <= currentCycle ? oldest : -1;
+}
+
+void MemoryController::issue(const Request& request, cycle_t currentCycle) {
+    Bank& bank = banks[request.channel][request.bank];
+
+    // Row buffer outcome determines the command sequence
+    cycle_t accessLatency;
+    if (bank.openRow == request.row) {
+        accessLatency = params.tCAS;
+        rowHits++;
+    } else if (bank.openRow < 0) {
+        accessLatency = params.tRCD + params.tCAS;
+        rowEmpty++;
+    } else {
+        accessLatency = params.tRP + params.tRCD + params.tCAS;
+        rowConflicts++;
+    }
+
+    // The block is then transferred over the channel data bus
+    cycle_t dataStart = std::max(currentCycle + accessLatency, channelBusFreeCycle[request.channel]);
+    cycle_t completionCycle = dataStart + params.tBurst;
+    channelBusFreeCycle[request.channel] = completionCycle;
+
+    if (params.rowPolicy == RowBufferPolicy::Open) {
+        // Column commands to the open row are pipelined one burst apart
+        bank.openRow = request.row;
+        bank.readyCycle = currentCycle + (accessLatency - params.tCAS) + params.tBurst;
+    } else {
+        bank.openRow = -1;
+        bank.readyCycle = completionCycle + params.tRP;
+    }
+
+    if (request.isWrite) {
+        writes++;
+    } else {
+        reads++;
+    }
+    if (request.waitedForBank) {
+        bankConflicts++;
+    }
+    totalLatency += completionCycle - request.arrivalCycle;
+    totalQueueingDelay += currentCycle - request.arrivalCycle;
+
+    completions[request.ticket] = completionCycle;
+
+    TRACE(MemoryIssued, currentCycle, request.isWrite ? "write" : "read", request.address, completionCycle);
+}
+
+void MemoryController::tick(cycle_t currentCycle) {
+    // Each channel issues at most one request per cycle
+    for (int channel = 0; channel < params.channels; channel++) {
+        if (channelQueues[channel].empty()) {
+            continue;
+        }
+
+        int index = selectRequest(channel, currentCycle);
+        if (index >= 0) {
+            std::deque<Request>& queue = channelQueues[channel];
+            Request request = queue[index];
+            queue.erase(queue.begin() + index);
+            issue(request, currentCycle);
+        }
+    }
+}
+
+bool MemoryController::takeCompletion(uint64_t ticket, cycle_t& completionCycle) {
+    std::unordered_map<uint64_t, cycle_t>::iterator it = completions.find(ticket);
+    if (it == completions.end()) {
+        return false;
+    }
+    completionCycle = it->second;
+    completions.erase(it);
+    return true;
+}
+
+void MemoryController::saveState(CheckpointWriter& writer) const {
+    writer.write<uint64_t>(channelQueues.size());
+    for (size_t channel = 0; channel < channelQueues.size(); channel++) {
+        writer.write<uint64_t>(channelQueues[channel].size());
+        for (const Request& request : channelQueues[channel]) {
+            writer.write(request.ticket);
+            writer.write(request.address);
+            writer.write(request.isWrite);
+            writer.write(request.arrivalCycle);
+            writer.write(request.channel);
+            writer.write(request.bank);
+            writer.write(request.row);
+            writer.write(request.waitedForBank);
+        }
+        writer.write<uint64_t>(banks[channel].size());
+        for (const Bank& bank : banks[channel]) {
+            writer.write(bank.openRow);
+            writer.write(bank.readyCycle);
+        }
+        writer.write(channelBusFreeCycle[channel]);
+    }
+
+    writer.write<uint64_t>(completions.size());
+    for (const std::pair<const uint64_t, cycle_t>& completion : completions) {
+        writer.write(completion.first);
+        writer.write(completion.second);
+    }
+    writer.write(nextTicket);
+
+    writer.write(reads);
+    writer.write(writes);
+    writer.write(rowHits);
+    writer.write(rowEmpty);
+    writer.write(rowConflicts);
+    writer.write(bankConflicts);
+    writer.write(totalLatency);
+    writer.write(totalQueueingDelay);
+}
+
+void MemoryController::loadState(CheckpointReader& reader) {
+    reader.expect<uint64_t>(channelQueues.size(), "DRAM organization");
+    for (size_t channel = 0; channel < channelQueues.size(); channel++) {
+        channelQueues[channel].clear();
+        uint64_t requests = reader.readSize();
+        for (uint64_t i = 0; i < requests; i++) {
+            Request request;
+            reader.read(request.ticket);
+            reader.read(request.address);
+            reader.read(request.isWrite);
+            reader.read(request.arrivalCycle);
+            reader.read(request.channel);
+            reader.read(request.bank);
+            reader.read(request.row);
+            reader.read(request.waitedForBank);
+            channelQueues[channel].push_back(request);
+        }
+        reader.expect<uint64_t>(banks[channel].size(), "DRAM organization");
+        for (Bank& bank : banks[channel]) {
+            reader.read(bank.openRow);
+            reader.read(bank.readyCycle);
+        }
+        reader.read(channelBusFreeCycle[channel]);
+    }
+
+    completions.clear();
+    uint64_t pending = reader.readSize();
+    for (uint64_t i = 0; i < pending; i++) {
+        uint64_t ticket = reader.read<uint64_t>();
+        completions[ticket] = reader.read<cycle_t>();
+    }
+    reader.read(nextTicket);
+
+    reader.read(reads);
+    reader.read(writes);
+    reader.read(rowHits);
+    reader.read(rowEmpty);
+    reader.read(rowConflicts);
+    reader.read(bankConflicts);
+    reader.read(totalLatency);
+    reader.read(totalQueueingDelay);
+}
+
+size_t MemoryController::getQueueSize() const {
+    size_t total = 0;
+    for (const std::deque<Request>& queue : channelQueues) {
+        total += queue.size();
+    }
+    return total;
+}
+
+void MemoryController::printParameters(std::ostream& out) const {
+    out << "Memory: Banked DRAM (" << params.channels << " channels, " << params.ranks << " ranks, "
+        << params.banksPerRank << " banks per rank, " << params.rowSizeBytes << "-byte rows)" << std::endl;
+    out << "Row Buffer Policy: " << (params.rowPolicy == RowBufferPolicy::Open ? "Open" : "Closed") << std::endl;
+    out << "Memory Scheduling: " << (params.scheduling == MemorySchedulingPolicy::FRFCFS ? "FR-FCFS" : "FCFS") << std::endl;
+    out << "DRAM Timing (cycles): tRCD=" << params.tRCD << " tCAS=" << params.tCAS
+        << " tRP=" << params.tRP << " tBurst=" << params.tBurst << std::endl;
+}
+
+void MemoryController::printStats(std::ostream& out) const {
+    uint64_t accesses = rowHits + rowEmpty + rowConflicts;
+
+    out << std::endl << "Memory Controller Summary:" << std::endl;
+    out << "Memory Reads: " << reads << std::endl;
+    out << "Memory Writes: " << writes << std::endl;
+    out << "Row Hits: " << rowHits << std::endl;
+    out << "Row Misses (bank precharged): " << rowEmpty << std::endl;
+    out << "Row Conflicts: " << rowConflicts << std::endl;
+    out << "Row Hit Rate: " << std::fixed << std::setprecision(2) << (getRowHitRate() * 100.0) << "%" << std::endl;
+    out << "Bank Conflicts: " << bankConflicts << std::endl;
+    out << "Average Queueing Delay (cycles): " << std::fixed << std::setprecision(2)
+        << (accesses > 0 ? static_cast<double>(totalQueueingDelay) / accesses : 0.0) << std::endl;
+    out << "Average Memory Latency (cycles): " << std::fixed << std::setprecision(2)
+        << getAverageLatency() << std::endl;
+}
+
+uint64_t MemoryController::getRowHits() const {
+    return rowHits;
+}
+
+uint64_t MemoryController::getRowConflicts() const {
+    return rowConflicts;
+}
+
+uint64_t MemoryController::getBankConflicts() const {
+    return bankConflicts;
+}
+
+double MemoryController::getRowHitRate() const {
+    uint64_t accesses = rowHits + rowEmpty + rowConflicts;
+    return accesses == 0 ? 0.0 : static_cast<double>(rowHits) / accesses;
+}
+
+double MemoryController::getAverageLatency() const {
+    uint64_t accesses = rowHits + rowEmpty + rowConflicts;
+    return accesses == 0 ? 0.0 : static_cast<double>(totalLatency) / accesses;
+}
@@ -0,0 +1,118 @@
+#ifndef MEMORYCONTROLLER_H
+#define MEMORYCONTROLLER_H
+
+#include <vector>
+#include <deque>
+#include <string>
+#include <ostream>
+#include <unordered_map>
+#include "Types.h"
+
+class CheckpointWriter;
+class CheckpointReader;
+
+// Row buffer management policy
+enum class RowBufferPolicy {
+    Open,   // Leave the row open after an access (rewards row locality)
+    Closed  // Precharge right after every access
+};
+
+// Request scheduling policy
+enum class MemorySchedulingPolicy {
+    FCFS,   // Strictly oldest request first
+    FRFCFS  // First-ready: oldest row hit first, then oldest request
+};
+
+// DRAM organization and timing (all timings in core cycles)
+struct DramParameters {
+    int channels = 1;
+    int ranks = 1;
+    int banksPerRank = 8;
+    int rowSizeBytes = 2048;
+    RowBufferPolicy rowPolicy = RowBufferPolicy::Open;
+    MemorySchedulingPolicy scheduling = MemorySchedulingPolicy::FRFCFS;
+    int tRCD = 30;    // Activate to column command
+    int tCAS = 30;    // Column command to data
+    int tRP = 30;     // Precharge
+    int tBurst = 8;   // Data burst for one cache block on the channel
+};
+
+// Banked DRAM memory controller shared behind the interconnect.
+// Block addresses are mapped as row | rank | bank | channel | column, so
+// consecutive blocks fill a row buffer before moving to the next channel/bank.
+class MemoryController {
+private:
+    struct Request {
+        uint64_t ticket;
+        address_t address;
+        bool isWrite;
+        cycle_t arrivalCycle;
+        int channel;
+        int bank;          // Flat bank index (rank * banksPerRank + bank) within the channel
+        int row;
+        bool waitedForBank; // Was the request held up by its bank serving another request?
+    };
+
+    struct Bank {
+        int openRow;        // -1 when precharged
+        cycle_t readyCycle; // Cycle the bank can accept a new command
+    };
+
+    DramParameters params;
+    int blockOffsetBits;
+    int blocksPerRow;
+
+    std::vector<std::deque<Request>> channelQueues;    // Pending requests per channel
+    std::vector<std::vector<Bank>> banks;              // [channel][bank]
+    std::vector<cycle_t> channelBusFreeCycle;          // Data bus availability per channel
+    std::unordered_map<uint64_t, cycle_t> completions; // Issued ticket -> data completion cycle
+    uint64_t nextTicket;
+
+    // Statistics
+    uint64_t reads;
+    uint64_t writes;
+    uint64_t rowHits;
+    uint64_t rowEmpty;      // Bank was precharged (activate needed, no conflict)
+    uint64_t rowConflicts;  // A different row was open (precharge + activate)
+    uint64_t bankConflicts; // Requests that waited for their bank to finish another request
+    uint64_t totalLatency;  // Arrival to data completion
+    uint64_t totalQueueingDelay; // Arrival to issue
+
+    void decodeAddress(address_t address, int& channel, int& bank, int& row) const;
+    int selectRequest(int channel, cycle_t currentCycle);
+    void issue(const Request& request, cycle_t currentCycle);
+
+public:
+    MemoryController(int blockSize, const DramParameters& params);
+
+    // Queue a block read or write that reaches the controller at arrivalCycle.
+    // Returns a ticket to poll for completion.
+    uint64_t enqueue(address_t address, bool isWrite, cycle_t arrivalCycle);
+
+    // Schedule and issue requests for this cycle
+    void tick(cycle_t currentCycle);
+
+    // If the request has been scheduled, consume its ticket and return its data completion cycle
+    bool takeCompletion(uint64_t ticket, cycle_t& completionCycle);
+
+    // Number of requests not yet issued
+    size_t getQueueSize() const;
+
+    // Stats output
+    // Checkpointing: queued requests, bank and channel state, pending completions and statistics.
+    // The organization must match; timing and policies may differ on restore.
+    void saveState(CheckpointWriter& writer) const;
+    void loadState(CheckpointReader& reader);
+
+    void printParameters(std::ostream& out) const;
+    void printStats(std::ostream& out) const;
+
+    // Statistics getters
+    uint64_t getRowHits() const;
+    uint64_t getRowConflicts() const;
+    uint64_t getBankConflicts() const;
+    double getRowHitRate() const;
+    double getAverageLatency() const;
+};
+
+#endif // MEMORYCONTROLLER_H
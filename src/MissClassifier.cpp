@@ -0,0 +1,137 @@
+#include "MissClassifier.h"
+
+SharingTracker::SharingTracker() : writes(0) {
+}
+
+void SharingTracker::recordWrite(address_t addr) {
+    lastWrite[addr >> 2] = ++writes;
+}
+
+uint64_t SharingTracker::getStamp() const {
+    return writes;
+}
+
+uint64_t SharingTracker::getWordStamp(address_t addr) const {
+    std::unordered_map<address_t, uint64_t>::const_iterator it = lastWrite.find(addr >> 2);
+    return it != lastWrite.end() ? it->second : 0;
+}
+
+MissClassifier::MissClassifier(SharingTracker* tracker, int lines, int blockOffsetBits) :
+    shadow(lines),
+    mostRecent(-1),
+    leastRecent(-1),
+    tracker(tracker),
+    blockOffsetBits(blockOffsetBits),
+    counts() {
+    shadowIndex.reserve(lines * 2);
+    freeNodes.reserve(lines);
+    for (int node = lines - 1; node >= 0; node--) {
+        freeNodes.push_back(node);
+    }
+}
+
+void MissClassifier::unlink(int node) {
+    ShadowLine& line = shadow[node];
+    if (line.prev >= 0) {
+        shadow[line.prev].next = line.next;
+    } else {
+        mostRecent = line.next;
+    }
+    if (line.next >= 0) {
+        shadow[line.next].prev = line.prev;
+    } else {
+        leastRecent = line.prev;
+    }
+}
+
+void MissClassifier::pushMostRecent(int node) {
+    ShadowLine& line = shadow[node];
+    line.prev = -1;
+    line.next = mostRecent;
+    if (mostRecent >= 0) {
+        shadow[mostRecent].prev = node;
+    } else {
+        leastRecent = node;
+    }
+    mostRecent = node;
+}
+
+bool MissClassifier::touchShadow(address_t block) {
+    std::unordered_map<address_t, int>::iterator it = shadowIndex.find(block);
+    if (it != shadowIndex.end()) {
+        unlink(it->second);
+        pushMostRecent(it->second);
+        return true;
+    }
+
+    // Reuse a free line, or replace the least recently used one
+    int node;
+    if (!freeNodes.empty()) {
+        node = freeNodes.back();
+        freeNodes.pop_back();
+    } else {
+        node = leastRecent;
+        unlink(node);
+        shadowIndex.erase(shadow[node].block);
+    }
+    shadow[node].block = block;
+    shadowIndex[block] = node;
+    pushMostRecent(node);
+    return false;
+}
+
+void MissClassifier::removeShadow(address_t block) {
+    std::unordered_map<address_t, int>::iterator it = shadowIndex.find(block);
+    if (it != shadowIndex.end()) {
+        unlink(it->second);
+        freeNodes.push_back(it->second);
+        shadowIndex.erase(it);
+    }
+}
+
+void MissClassifier::access(MemOperation op, address_t addr, bool miss) {
+    address_t block = addr >> blockOffsetBits;
+    bool shadowHit = touchShadow(block);
+
+    if (miss) {
+        MissType type;
+        std::unordered_map<address_t, Invalidation>::iterator lost = invalidated.find(block);
+        if (seen.insert(block).second) {
+            type = MissType::Compulsory;
+        } else if (lost != invalidated.end()) {
+            // Only another core can have written the block since: this is our first access
+            bool written = (addr >> 2) == lost->second.writtenWord ||
+                           tracker->getWordStamp(addr) > lost->second.stamp;
+            type = written ? MissType::TrueSharing : MissType::FalseSharing;
+            invalidated.erase(lost);
+        } else {
+            type = shadowHit ? MissType::Conflict : MissType::Capacity;
+        }
+        counts[static_cast<int>(type)]++;
+    }
+
+    if (op == MemOperation::WRITE) {
+        tracker->recordWrite(addr);
+    }
+}
+
+void MissClassifier::invalidate(address_t addr) {
+    address_t block = addr >> blockOffsetBits;
+    invalidated[block] = Invalidation{tracker->getStamp(), addr >> 2};
+    removeShadow(block);
+}
+
+uint64_t MissClassifier::getCount(MissType type) const {
+    return counts[static_cast<int>(type)];
+}
+
+const char* getMissTypeName(MissType type) {
+    switch (type) {
+        case MissType::Compulsory: return "Compulsory";
+        case MissType::Capacity: return "Capacity";
+        case MissType::Conflict: return "Conflict";
+        case MissType::TrueSharing: return "True Sharing";
+        case MissType::FalseSharing: return "False Sharing";
+        default: return "Unknown";
+    }
+}
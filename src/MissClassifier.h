@@ -0,0 +1,86 @@
+#ifndef MISS_CLASSIFIER_H
+#define MISS_CLASSIFIER_H
+
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include "Types.h"
+
+// Kinds of miss, in report order
+enum class MissType {
+    Compulsory,    // First access of the core to the block
+    Capacity,      // Would also miss in a fully-associative LRU cache of the same size
+    Conflict,      // Would hit in the fully-associative cache
+    TrueSharing,   // First access since an invalidation, to a word another core wrote since
+    FalseSharing,  // First access since an invalidation, to a word no other core wrote since
+    Count
+};
+
+// Last write of every word by any core, shared by the classifiers of all caches. Writes are
+// stamped with a running count rather than a cycle, so writes in one cycle stay ordered.
+class SharingTracker {
+private:
+    std::unordered_map<address_t, uint64_t> lastWrite;  // Word address (addr >> 2) -> stamp
+    uint64_t writes;
+
+public:
+    SharingTracker();
+
+    void recordWrite(address_t addr);
+
+    // Stamp of the latest write so far, and of the latest write to the word holding addr (0 = never)
+    uint64_t getStamp() const;
+    uint64_t getWordStamp(address_t addr) const;
+};
+
+// Classifies the misses of one cache (3C plus coherence). A shadow fully-associative LRU
+// cache of the same number of lines tells capacity from conflict misses. A block lost to
+// another core's BusRdX or InvalidateSig is remembered with the stamp of the invalidation and
+// the word the invalidating core wrote; the first miss to it afterwards is a sharing miss,
+// true if the word accessed was written by another core since, false otherwise.
+class MissClassifier {
+private:
+    // Fully-associative LRU list of block addresses over a fixed node array
+    struct ShadowLine {
+        address_t block;
+        int prev;   // Towards the most recently used end
+        int next;
+    };
+    std::vector<ShadowLine> shadow;
+    std::unordered_map<address_t, int> shadowIndex;   // Block -> node
+    std::vector<int> freeNodes;
+    int mostRecent;
+    int leastRecent;
+
+    struct Invalidation {
+        uint64_t stamp;
+        address_t writtenWord;   // Word address written by the invalidating core
+    };
+    std::unordered_map<address_t, Invalidation> invalidated;  // Block -> last invalidation
+    std::unordered_set<address_t> seen;                       // Blocks accessed so far
+
+    SharingTracker* tracker;
+    int blockOffsetBits;
+    uint64_t counts[static_cast<int>(MissType::Count)];
+
+    void unlink(int node);
+    void pushMostRecent(int node);
+    bool touchShadow(address_t block);   // Returns true on a shadow hit
+    void removeShadow(address_t block);
+
+public:
+    MissClassifier(SharingTracker* tracker, int lines, int blockOffsetBits);
+
+    // Every access of the cache, with whether it missed
+    void access(MemOperation op, address_t addr, bool miss);
+
+    // The cache lost the block holding addr to another core's write of addr
+    void invalidate(address_t addr);
+
+    uint64_t getCount(MissType type) const;
+};
+
+// Name of a miss type in the statistics ("True Sharing")
+const char* getMissTypeName(MissType type);
+
+#endif // MISS_CLASSIFIER_H
@@ -0,0 +1,535 @@
+#include "Network.h"
+#include "Cache.h"
+#include "MemoryController.h"
+#include "Trace.h"
+#include "Checkpoint.h"
+#include "LatencyHistogram.h"
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+Network::Network(int blockSize, int numCores, const NetworkParameters& params) :
+    Interconnect(blockSize),
+    params(params),
+    currentCycle(0),
+    totalMessages(0),
+    totalHops(0),
+    totalMessageLatency(0),
+    totalTransactionLatency(0),
+    completedTransactions(0) {
+
+    if (params.topology == NetworkTopology::Ring) {
+        numNodes = std::max(numCores, 2);
+        meshWidth = numNodes;
+        meshHeight = 1;
+    } else {
+        meshWidth = params.meshWidth > 0 ? params.meshWidth :
+            static_cast<int>(std::ceil(std::sqrt(static_cast<double>(numCores))));
+        meshHeight = std::max(1, (numCores + meshWidth - 1) / meshWidth);
+        numNodes = meshWidth * meshHeight;
+    }
+
+    // Create the directed links. Ring: direction 0 = clockwise, 1 = counter-clockwise.
+    // Mesh: direction 0 = east, 1 = west, 2 = south, 3 = north.
+    linkIndex.assign(numNodes * 4, -1);
+    for (int node = 0; node < numNodes; node++) {
+        for (int direction = 0; direction < 4; direction++) {
+            int neighbour = -1;
+            if (params.topology == NetworkTopology::Ring) {
+                if (direction == 0) neighbour = (node + 1) % numNodes;
+                if (direction == 1) neighbour = (node + numNodes - 1) % numNodes;
+            } else {
+                int x = node % meshWidth;
+                int y = node / meshWidth;
+                if (direction == 0 && x + 1 < meshWidth) neighbour = node + 1;
+                if (direction == 1 && x > 0) neighbour = node - 1;
+                if (direction == 2 && y + 1 < meshHeight) neighbour = node + meshWidth;
+                if (direction == 3 && y > 0) neighbour = node - meshWidth;
+            }
+
+            if (neighbour >= 0) {
+                Link link;
+                link.from = node;
+                link.to = neighbour;
+                link.reservedCycles.assign(calendarCycles, ~static_cast<cycle_t>(0));
+                link.flits = 0;
+                link.bytes = 0;
+                linkIndex[node * 4 + direction] = static_cast<int>(links.size());
+                links.push_back(link);
+            }
+        }
+    }
+
+    // Spread the memory controllers evenly over the nodes
+    int controllers = std::max(1, std::min(params.memoryControllers, numNodes));
+    for (int i = 0; i < controllers; i++) {
+        memoryControllerNodes.push_back((i * numNodes) / controllers);
+    }
+
+    homeQueues.resize(numNodes);
+    demandRequests.resize(numCores, DemandRequest{0, 0});
+
+    TRACE(NetworkInit, params.topology == NetworkTopology::Ring ? "ring" : "mesh", numNodes, links.size(),
+          controllers);
+}
+
+int Network::getHomeNode(address_t address) const {
+    return static_cast<int>((address >> blockOffsetBits) % numNodes);
+}
+
+int Network::getMemoryControllerNode(address_t address) const {
+    address_t blockAddress = address >> blockOffsetBits;
+    return memoryControllerNodes[blockAddress % memoryControllerNodes.size()];
+}
+
+int Network::getNextHop(int node, int destination, int& direction) const {
+    if (params.topology == NetworkTopology::Ring) {
+        int clockwiseDistance = (destination - node + numNodes) % numNodes;
+        direction = (clockwiseDistance <= numNodes / 2) ? 0 : 1;
+        return direction == 0 ? (node + 1) % numNodes : (node + numNodes - 1) % numNodes;
+    }
+
+    // XY routing: correct the column first, then the row
+    int x = node % meshWidth;
+    int y = node / meshWidth;
+    int destX = destination % meshWidth;
+    int destY = destination / meshWidth;
+
+    if (x != destX) {
+        direction = destX > x ? 0 : 1;
+        return destX > x ? node + 1 : node - 1;
+    }
+    direction = destY > y ? 2 : 3;
+    return destY > y ? node + meshWidth : node - meshWidth;
+}
+
+cycle_t Network::reserveLinkCycle(Link& link, cycle_t cycle) {
+    cycle_t horizon = currentCycle + calendarCycles;
+    while (cycle < horizon && link.reservedCycles[cycle & (calendarCycles - 1)] == cycle) {
+        cycle++;
+    }
+    // Bookings beyond the calendar horizon are treated as uncontended
+    if (cycle < horizon) {
+        link.reservedCycles[cycle & (calendarCycles - 1)] = cycle;
+    }
+    return cycle;
+}
+
+cycle_t Network::sendMessage(int source, int destination, int bytes, cycle_t departCycle) {
+    int flits = std::max(1, (bytes + params.linkWidthBytes - 1) / params.linkWidthBytes);
+    int hops = 0;
+
+    // Wormhole-style traversal: every flit takes the first free cycle on each link
+    // after it reached the router, flits of one message stay in order, and each hop
+    // adds the router + link latency
+    flitCycles.assign(flits, departCycle);
+    int direction = 0;
+    int node = source;
+    while (node != destination) {
+        int next = getNextHop(node, destination, direction);
+        Link& link = links[linkIndex[node * 4 + direction]];
+
+        for (int flit = 0; flit < flits; flit++) {
+            cycle_t ready = flitCycles[flit];
+            if (flit > 0) {
+                ready = std::max(ready, flitCycles[flit - 1] - params.hopLatency + 1);
+            }
+            flitCycles[flit] = reserveLinkCycle(link, ready) + params.hopLatency;
+        }
+        link.flits += flits;
+        link.bytes += bytes;
+
+        node = next;
+        hops++;
+    }
+
+    // Arrival of the tail flit
+    cycle_t arrivalCycle = flitCycles[flits - 1];
+
+    totalMessages++;
+    totalHops += hops;
+    totalMessageLatency += arrivalCycle - departCycle;
+
+    return arrivalCycle;
+}
+
+void Network::enqueueRequest(int requesterId, BusRequestType type, address_t address, cycle_t currentCycle) {
+    this->currentCycle = std::max(this->currentCycle, currentCycle);
+    
+    PendingRequest request;
+    request.transaction.requesterId = requesterId;
+    request.transaction.type = type;
+    request.transaction.address = address;
+    request.transaction.startCycle = currentCycle;
+    request.transaction.completionCycle = 0; // Will be calculated at the home node
+    request.transaction.dataReady = false;
+    request.transaction.servedByCache = false;
+    request.transaction.priority = BusRequestPriority::NORMAL;
+
+    // Writebacks carry the victim block to the home node, everything else is a control message
+    int homeNode = getHomeNode(address);
+    int bytes = (type == BusRequestType::WriteBack) ? blockSizeBytes + controlMessageBytes : controlMessageBytes;
+    request.arrivalCycle = sendMessage(requesterId, homeNode, bytes, currentCycle);
+
+    homeQueues[homeNode].push_back(request);
+    if (type != BusRequestType::WriteBack) {
+        requestProgress[requesterId].resource = homeNode;
+        demandRequests[requesterId] = DemandRequest{address >> blockOffsetBits, request.arrivalCycle};
+    }
+
+    TRACE(NetworkRequestSent, currentCycle, requesterId, type, address, homeNode, request.arrivalCycle);
+}
+
+void Network::tick(cycle_t currentCycle) {
+    this->currentCycle = currentCycle;
+    
+    // The shared DRAM controller schedules requests that have reached it
+    if (memoryController != nullptr) {
+        memoryController->tick(currentCycle);
+    }
+    
+    // Phase 1: complete transactions whose last message has arrived (in grant order)
+    size_t kept = 0;
+    for (size_t i = 0; i < inFlight.size(); i++) {
+        InFlightTransaction& entry = inFlight[i];
+        BusTransaction& transaction = entry.transaction;
+        
+        // Once DRAM has scheduled the access, send the block on to the requester
+        cycle_t memoryDoneCycle = 0;
+        if (entry.waitingForMemory && memoryController->takeCompletion(entry.memoryTicket, memoryDoneCycle)) {
+            entry.waitingForMemory = false;
+            if (transaction.type == BusRequestType::WriteBack) {
+                transaction.completionCycle = memoryDoneCycle;
+            } else {
+                cycle_t dataArrival = sendMessage(entry.memoryNode, transaction.requesterId,
+                                                  blockSizeBytes + controlMessageBytes, memoryDoneCycle);
+                transaction.completionCycle = std::max(dataArrival, entry.ackCycle);
+            }
+        }
+        
+        if (!entry.waitingForMemory && currentCycle >= transaction.completionCycle) {
+            TRACE(NetworkTransactionComplete, currentCycle, transaction.requesterId, transaction.address,
+                  transaction.type);
+
+            activeBlocks.erase(transaction.address >> blockOffsetBits);
+            if (transaction.type == BusRequestType::WriteBack) {
+                writeBacksInFlight.erase(transaction.address >> blockOffsetBits);
+            }
+            totalTransactionLatency += currentCycle - transaction.startCycle;
+            completedTransactions++;
+            if (eventLog != nullptr) {
+                logTransaction(transaction, entry.grantCycle, entry.loggedChanges, std::vector<int>());
+            }
+            if (latencyStats != nullptr) {
+                latencyStats->record(transaction, entry.grantCycle);
+            }
+            notifyRequester(currentCycle, transaction);
+        } else if (kept++ != i) {
+            inFlight[kept - 1] = std::move(entry);
+        }
+    }
+    inFlight.resize(kept);
+
+    // Phase 2: every home node grants at most one arrived request per cycle.
+    // Requests for a block that already has a transaction in flight keep waiting,
+    // which serializes coherence per block exactly like a bus slice does.
+    for (int home = 0; home < numNodes; home++) {
+        std::deque<PendingRequest>& queue = homeQueues[home];
+        int bestIndex = -1;
+
+        for (size_t i = 0; i < queue.size(); i++) {
+            const PendingRequest& candidate = queue[i];
+            if (candidate.arrivalCycle > currentCycle ||
+                activeBlocks.count(candidate.transaction.address >> blockOffsetBits) != 0) {
+                continue;
+            }
+
+            // Same priority rules as the bus: request type first, then lowest core ID
+            if (bestIndex < 0) {
+                bestIndex = static_cast<int>(i);
+                continue;
+            }
+            const BusTransaction& best = queue[bestIndex].transaction;
+            int candidateType = static_cast<int>(candidate.transaction.type);
+            int bestType = static_cast<int>(best.type);
+            if (candidateType > bestType ||
+                (candidateType == bestType && candidate.transaction.requesterId < best.requesterId)) {
+                bestIndex = static_cast<int>(i);
+            }
+        }
+
+        if (bestIndex >= 0) {
+            BusTransaction request = queue[bestIndex].transaction;
+            queue.erase(queue.begin() + bestIndex);
+            grant(currentCycle, home, request);
+        }
+    }
+}
+
+void Network::grant(cycle_t currentCycle, int homeNode, const BusTransaction& request) {
+    BusTransaction transaction = request;
+    int requester = transaction.requesterId;
+    int supplierId = -1;
+
+    // The home node is the ordering point: all caches observe the request now
+    bool suppliedByCache = broadcastSnoop(currentCycle, transaction, &snoopHolders, &supplierId);
+    transaction.servedByCache = suppliedByCache;
+    if (transaction.type != BusRequestType::WriteBack) {
+        markGranted(requester, transaction);
+    }
+
+    int dataBytes = blockSizeBytes + controlMessageBytes;
+    int memoryNode = getMemoryControllerNode(transaction.address);
+    cycle_t completionCycle = currentCycle;
+    
+    InFlightTransaction entry;
+    entry.waitingForMemory = false;
+    entry.memoryTicket = 0;
+    entry.memoryNode = memoryNode;
+    entry.ackCycle = currentCycle;
+    entry.grantCycle = currentCycle;
+    if (eventLog != nullptr) {
+        entry.loggedChanges.swap(snoopChanges);
+    }
+
+    if (transaction.type == BusRequestType::BusRd && suppliedByCache) {
+        // Forward to the owner, which sends the block straight to the requester
+        cycle_t forwardArrival = sendMessage(homeNode, supplierId, controlMessageBytes, currentCycle);
+        completionCycle = sendMessage(supplierId, requester, dataBytes, forwardArrival + 1);
+    } else if (transaction.type == BusRequestType::BusRd || transaction.type == BusRequestType::BusRdX) {
+        // Fetch from the memory controller that owns this block
+        cycle_t requestArrival = sendMessage(homeNode, memoryNode, controlMessageBytes, currentCycle);
+        if (memoryController != nullptr) {
+            entry.waitingForMemory = true;
+            entry.memoryTicket = memoryController->enqueue(transaction.address, false, requestArrival);
+        } else {
+            completionCycle = sendMessage(memoryNode, requester, dataBytes, requestArrival + memoryLatency);
+        }
+    } else if (transaction.type == BusRequestType::WriteBack) {
+        // The block travels on from the home node to memory
+        cycle_t dataArrival = sendMessage(homeNode, memoryNode, dataBytes, currentCycle);
+        if (memoryController != nullptr) {
+            entry.waitingForMemory = true;
+            entry.memoryTicket = memoryController->enqueue(transaction.address, true, dataArrival);
+        } else {
+            completionCycle = dataArrival + memoryLatency;
+        }
+    }
+
+    // Ownership requests also wait for an acknowledgement from every invalidated sharer
+    if (transaction.type == BusRequestType::BusRdX || transaction.type == BusRequestType::InvalidateSig) {
+        for (int holder : snoopHolders) {
+            cycle_t invalidateArrival = sendMessage(homeNode, holder, controlMessageBytes, currentCycle);
+            entry.ackCycle = std::max(entry.ackCycle,
+                sendMessage(holder, requester, controlMessageBytes, invalidateArrival + 1));
+        }
+        if (transaction.type == BusRequestType::InvalidateSig && snoopHolders.empty()) {
+            entry.ackCycle = sendMessage(homeNode, requester, controlMessageBytes, currentCycle);
+        }
+        completionCycle = std::max(completionCycle, entry.ackCycle);
+    }
+
+    // A transaction always takes at least one cycle
+    completionCycle = std::max(completionCycle, currentCycle + 1);
+    transaction.completionCycle = completionCycle;
+    entry.transaction = transaction;
+
+    recordTransaction(currentCycle, transaction);
+    activeBlocks.insert(transaction.address >> blockOffsetBits);
+    if (transaction.type == BusRequestType::WriteBack) {
+        writeBacksInFlight[transaction.address >> blockOffsetBits] = requester;
+    }
+    inFlight.push_back(std::move(entry));
+
+    TRACE(NetworkGrant, currentCycle, homeNode, transaction.type, requester, transaction.address,
+          completionCycle, suppliedByCache ? "yes" : "no");
+}
+
+void Network::saveState(CheckpointWriter& writer) const {
+    Interconnect::saveState(writer);
+    writer.write(currentCycle);
+    writer.write(totalMessages);
+    writer.write(totalHops);
+    writer.write(totalMessageLatency);
+    writer.write(totalTransactionLatency);
+    writer.write(completedTransactions);
+
+    writer.write<uint64_t>(links.size());
+    for (const Link& link : links) {
+        writer.writeVector(link.reservedCycles);
+        writer.write(link.flits);
+        writer.write(link.bytes);
+    }
+
+    writer.write<uint64_t>(homeQueues.size());
+    for (const std::deque<PendingRequest>& queue : homeQueues) {
+        writer.write<uint64_t>(queue.size());
+        for (const PendingRequest& request : queue) {
+            writer.writeTransaction(request.transaction);
+            writer.write(request.arrivalCycle);
+        }
+    }
+
+    writer.write<uint64_t>(inFlight.size());
+    for (const InFlightTransaction& entry : inFlight) {
+        writer.writeTransaction(entry.transaction);
+        writer.write(entry.waitingForMemory);
+        writer.write(entry.memoryTicket);
+        writer.write(entry.memoryNode);
+        writer.write(entry.ackCycle);
+        writer.write(entry.grantCycle);
+        writer.writeVector(entry.loggedChanges);
+    }
+
+    writer.write<uint64_t>(activeBlocks.size());
+    for (address_t block : activeBlocks) {
+        writer.write(block);
+    }
+}
+
+void Network::loadState(CheckpointReader& reader) {
+    Interconnect::loadState(reader);
+    reader.read(currentCycle);
+    reader.read(totalMessages);
+    reader.read(totalHops);
+    reader.read(totalMessageLatency);
+    reader.read(totalTransactionLatency);
+    reader.read(completedTransactions);
+
+    reader.expect<uint64_t>(links.size(), "network topology");
+    for (Link& link : links) {
+        reader.readVector(link.reservedCycles);
+        if (link.reservedCycles.size() != static_cast<size_t>(calendarCycles)) {
+            throw std::runtime_error("checkpoint is corrupt");
+        }
+        reader.read(link.flits);
+        reader.read(link.bytes);
+    }
+
+    reader.expect<uint64_t>(homeQueues.size(), "network topology");
+    for (std::deque<PendingRequest>& queue : homeQueues) {
+        queue.clear();
+        uint64_t requests = reader.readSize();
+        for (uint64_t i = 0; i < requests; i++) {
+            PendingRequest request;
+            request.transaction = reader.readTransaction();
+            reader.read(request.arrivalCycle);
+            queue.push_back(request);
+        }
+    }
+
+    inFlight.clear();
+    uint64_t transactions = reader.readSize();
+    for (uint64_t i = 0; i < transactions; i++) {
+        InFlightTransaction entry;
+        entry.transaction = reader.readTransaction();
+        reader.read(entry.waitingForMemory);
+        reader.read(entry.memoryTicket);
+        reader.read(entry.memoryNode);
+        reader.read(entry.ackCycle);
+        reader.read(entry.grantCycle);
+        reader.readVector(entry.loggedChanges);
+        inFlight.push_back(entry);
+    }
+
+    activeBlocks.clear();
+    uint64_t blocks = reader.readSize();
+    for (uint64_t i = 0; i < blocks; i++) {
+        activeBlocks.insert(reader.read<address_t>());
+    }
+    
+    // The stall attribution state follows from the queues and the transactions in flight
+    writeBacksInFlight.clear();
+    for (const InFlightTransaction& entry : inFlight) {
+        if (entry.transaction.type == BusRequestType::WriteBack) {
+            writeBacksInFlight[entry.transaction.address >> blockOffsetBits] = entry.transaction.requesterId;
+        }
+    }
+    for (const std::deque<PendingRequest>& queue : homeQueues) {
+        for (const PendingRequest& request : queue) {
+            if (request.transaction.type != BusRequestType::WriteBack) {
+                demandRequests[request.transaction.requesterId] =
+                    DemandRequest{request.transaction.address >> blockOffsetBits, request.arrivalCycle};
+            }
+        }
+    }
+}
+
+bool Network::writeBackCompletionUnblocks() const {
+    return false;
+}
+
+bool Network::isBehindWriteBack(int, int requesterId) const {
+    const DemandRequest& request = demandRequests[requesterId];
+    if (request.arrivalCycle > currentCycle) {
+        return false; // Still on its way to the home node
+    }
+    std::unordered_map<address_t, int>::const_iterator it = writeBacksInFlight.find(request.block);
+    return it != writeBacksInFlight.end() && it->second != requesterId;
+}
+
+size_t Network::getQueueSize() const {
+    size_t total = 0;
+    for (const std::deque<PendingRequest>& queue : homeQueues) {
+        total += queue.size();
+    }
+    return total;
+}
+
+std::string Network::getNodeName(int node) const {
+    if (params.topology == NetworkTopology::Ring) {
+        return std::to_string(node);
+    }
+    return "(" + std::to_string(node % meshWidth) + "," + std::to_string(node / meshWidth) + ")";
+}
+
+void Network::printParameters(std::ostream& out) const {
+    if (params.topology == NetworkTopology::Ring) {
+        out << "Interconnect: Bidirectional Ring (" << numNodes << " nodes, shortest-direction routing)" << std::endl;
+    } else {
+        out << "Interconnect: 2D Mesh (" << meshWidth << "x" << meshHeight << " nodes, XY routing)" << std::endl;
+    }
+    out << "Coherence Ordering: Address-interleaved home node per block" << std::endl;
+    out << "Hop Latency: " << params.hopLatency << " cycles" << std::endl;
+    out << "Link Width (Bytes/cycle): " << params.linkWidthBytes << std::endl;
+    out << "Memory Controllers: " << memoryControllerNodes.size() << " (nodes";
+    for (int node : memoryControllerNodes) {
+        out << " " << getNodeName(node);
+    }
+    out << ")" << std::endl;
+    if (memoryController == nullptr) {
+        out << "Memory Latency: " << memoryLatency << " cycles" << std::endl;
+    }
+}
+
+void Network::printStats(std::ostream& out, cycle_t totalCycles) const {
+    out << std::endl << "Network Summary:" << std::endl;
+    out << "Total Messages: " << totalMessages << std::endl;
+    out << "Average Hops per Message: " << std::fixed << std::setprecision(2)
+        << (totalMessages > 0 ? static_cast<double>(totalHops) / totalMessages : 0.0) << std::endl;
+    out << "Average Message Latency (cycles): " << std::fixed << std::setprecision(2)
+        << (totalMessages > 0 ? static_cast<double>(totalMessageLatency) / totalMessages : 0.0) << std::endl;
+    out << "Average Transaction Latency (cycles): " << std::fixed << std::setprecision(2)
+        << (completedTransactions > 0 ? static_cast<double>(totalTransactionLatency) / completedTransactions : 0.0)
+        << std::endl;
+
+    double maxUtilization = 0.0;
+    for (const Link& link : links) {
+        double utilization = totalCycles == 0 ? 0.0 :
+            std::min(1.0, static_cast<double>(link.flits) / totalCycles);
+        maxUtilization = std::max(maxUtilization, utilization);
+    }
+    out << "Max Link Utilization: " << std::fixed << std::setprecision(2) << (maxUtilization * 100.0) << "%" << std::endl;
+
+    out << std::endl << "Link Statistics:" << std::endl;
+    for (const Link& link : links) {
+        double utilization = totalCycles == 0 ? 0.0 :
+            std::min(1.0, static_cast<double>(link.flits) / totalCycles);
+        out << "Link " << getNodeName(link.from) << "->" << getNodeName(link.to)
+            << ": Flits: " << link.flits
+            << ", Bytes: " << link.bytes
+            << ", Utilization: " << std::fixed << std::setprecision(2) << (utilization * 100.0) << "%" << std::endl;
+    }
+}
@@ -0,0 +1,137 @@
+#ifndef NETWORK_H
+#define NETWORK_H
+
+#include <vector>
+#include <deque>
+#include <string>
+#include <unordered_set>
+#include <unordered_map>
+#include "Types.h"
+#include "Interconnect.h"
+
+// Point-to-point topologies that can replace the shared bus
+enum class NetworkTopology {
+    Ring,  // Bidirectional ring, shortest-direction routing
+    Mesh   // 2D mesh, dimension-ordered (XY) routing
+};
+
+// Network configuration
+struct NetworkParameters {
+    NetworkTopology topology = NetworkTopology::Ring;
+    int meshWidth = 0;          // Mesh columns (0 = ceil(sqrt(nodes)))
+    int memoryControllers = 1;  // Memory controllers spread evenly over the nodes
+    int hopLatency = 2;         // Router + link traversal cycles per hop
+    int linkWidthBytes = 16;    // Bytes a link carries per cycle (flit size)
+};
+
+// Network-on-chip interconnect. Every node hosts a core and a home slice (the
+// coherence ordering point for the blocks interleaved onto it, where an LLC slice
+// would sit); memory controllers are attached to a subset of the nodes.
+// A transaction travels requester -> home, is ordered and snooped at the home node,
+// then its data/acknowledgement messages are routed hop by hop. Each directed link
+// is reserved flit by flit, so latency grows with distance and with link contention.
+class Network : public Interconnect {
+private:
+    // A request travelling to, or waiting at, its home node
+    struct PendingRequest {
+        BusTransaction transaction;
+        cycle_t arrivalCycle;   // Cycle the request reaches the home node
+    };
+
+    // A core's outstanding demand request, for stall attribution
+    struct DemandRequest {
+        address_t block;
+        cycle_t arrivalCycle;   // Cycle the request reaches the home node
+    };
+
+    // A granted transaction whose messages are still in the network
+    struct InFlightTransaction {
+        BusTransaction transaction;
+        bool waitingForMemory;  // DRAM access not yet scheduled by the memory controller
+        uint64_t memoryTicket;
+        int memoryNode;         // Node of the memory controller serving the access
+        cycle_t ackCycle;       // Last invalidation acknowledgement arrival
+        cycle_t grantCycle;
+        std::vector<uint32_t> loggedChanges; // Snoop state changes (event log)
+    };
+
+    // A directed link between two neighbouring nodes. Messages may be booked
+    // ahead of time (e.g. a memory response), so the link keeps a calendar of
+    // the future cycles already reserved for a flit rather than a single watermark.
+    struct Link {
+        int from;
+        int to;
+        std::vector<cycle_t> reservedCycles; // Calendar slot c % size holds c when cycle c is taken
+        uint64_t flits;         // Flits carried
+        uint64_t bytes;         // Payload bytes carried
+    };
+
+    NetworkParameters params;
+    int numNodes;
+    int meshWidth;
+    int meshHeight;
+
+    std::vector<Link> links;
+    std::vector<int> linkIndex;                     // (node, direction) -> link id, -1 if none
+    std::vector<int> memoryControllerNodes;         // Node of each memory controller
+    std::vector<std::deque<PendingRequest>> homeQueues; // Per-home-node request queues
+    std::vector<InFlightTransaction> inFlight;      // Granted, not yet completed (grant order)
+    std::unordered_set<address_t> activeBlocks;     // Blocks with a transaction in flight
+    std::unordered_map<address_t, int> writeBacksInFlight; // Block -> core of a writeback in flight
+    std::vector<DemandRequest> demandRequests;      // Per core
+    std::vector<int> snoopHolders;                  // Scratch list reused by every grant
+
+    std::vector<cycle_t> flitCycles;                // Scratch per-flit timing reused by every message
+    cycle_t currentCycle;                           // Latest cycle seen, start of the link calendars
+
+    const int controlMessageBytes = 8;              // Request / forward / acknowledgement size
+    static const int calendarCycles = 8192;         // Booking horizon of the link calendars (power of two)
+
+    // Statistics
+    uint64_t totalMessages;
+    uint64_t totalHops;
+    uint64_t totalMessageLatency;
+    uint64_t totalTransactionLatency;               // Request push to completion
+    uint64_t completedTransactions;
+
+    // Topology helpers
+    int getHomeNode(address_t address) const;
+    int getMemoryControllerNode(address_t address) const;
+    int getNextHop(int node, int destination, int& direction) const;
+
+    // Reserve the first free cycle at or after the given one on a link
+    cycle_t reserveLinkCycle(Link& link, cycle_t cycle);
+
+    // Route a message hop by hop, reserving each link; returns the tail arrival cycle
+    cycle_t sendMessage(int source, int destination, int bytes, cycle_t departCycle);
+
+    // Order, snoop and schedule a transaction at its home node
+    void grant(cycle_t currentCycle, int homeNode, const BusTransaction& request);
+
+    std::string getNodeName(int node) const;
+
+    // Send a request to its home node
+    void enqueueRequest(int requesterId, BusRequestType type, address_t address, cycle_t currentCycle) override;
+    
+    // Writebacks complete independently of the requester's misses
+    bool writeBackCompletionUnblocks() const override;
+    
+    // Has the request reached its home node (the resource) and found another core's writeback
+    // of its block in flight?
+    bool isBehindWriteBack(int resource, int requesterId) const override;
+
+public:
+    Network(int blockSize, int numCores, const NetworkParameters& params);
+
+    void tick(cycle_t currentCycle) override;
+    size_t getQueueSize() const override;
+
+    // Checkpointing: home queues, transactions in flight, link calendars and statistics
+    void saveState(CheckpointWriter& writer) const override;
+    void loadState(CheckpointReader& reader) override;
+
+    void printParameters(std::ostream& out) const override;
+    void printStats(std::ostream& out, cycle_t totalCycles) const override;
+};
+
+#endif // NETWORK_H
@@ -0,0 +1,67 @@
+#include "ParallelEngine.h"
+
+ParallelEngine::ParallelEngine(int numThreads) :
+    numThreads(numThreads < 1 ? 1 : numThreads),
+    task(nullptr),
+    phase(0),
+    pendingWorkers(0),
+    stopping(false) {
+    for (int worker = 1; worker < this->numThreads; worker++) {
+        workers.emplace_back(&ParallelEngine::workerLoop, this, worker);
+    }
+}
+
+ParallelEngine::~ParallelEngine() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    startCondition.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+void ParallelEngine::runPhase(const std::function<void(int)>& phaseTask) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        task = &phaseTask;
+        pendingWorkers = numThreads - 1;
+        phase++;
+    }
+    startCondition.notify_all();
+
+    // The calling thread is worker 0
+    phaseTask(0);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    doneCondition.wait(lock, [this] { return pendingWorkers == 0; });
+    task = nullptr;
+}
+
+void ParallelEngine::workerLoop(int worker) {
+    uint64_t seenPhase = 0;
+    while (true) {
+        const std::function<void(int)>* phaseTask;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            startCondition.wait(lock, [this, seenPhase] { return stopping || phase != seenPhase; });
+            if (stopping) {
+                return;
+            }
+            seenPhase = phase;
+            phaseTask = task;
+        }
+
+        (*phaseTask)(worker);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--pendingWorkers == 0) {
+            doneCondition.notify_one();
+        }
+    }
+}
+
+int ParallelEngine::getNumThreads() const {
+    return numThreads;
+}
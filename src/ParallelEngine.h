@@ -0,0 +1,39 @@
+#ifndef PARALLELENGINE_H
+#define PARALLELENGINE_H
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <cstdint>
+
+// Fixed pool of worker threads that run one task per phase.
+// The calling thread takes part as worker 0, so a pool of N threads starts N - 1 workers.
+class ParallelEngine {
+private:
+    int numThreads;
+    std::vector<std::thread> workers;
+
+    // Phase hand-off state (guarded by mutex)
+    std::mutex mutex;
+    std::condition_variable startCondition;
+    std::condition_variable doneCondition;
+    const std::function<void(int)>* task;   // Task of the current phase
+    uint64_t phase;                         // Incremented to start a phase
+    int pendingWorkers;                     // Workers still running the current phase
+    bool stopping;
+
+    void workerLoop(int worker);
+
+public:
+    ParallelEngine(int numThreads);
+    ~ParallelEngine();
+
+    // Run task(worker) on every thread and return once all of them have finished
+    void runPhase(const std::function<void(int)>& task);
+
+    int getNumThreads() const;
+};
+
+#endif // PARALLELENGINE_H
@@ -0,0 +1,221 @@
+#include "Shards.h"
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+const uint32_t ShardsSampler::modulus;
+const int ShardsProfiler::partitions;
+
+ShardsSampler::ShardsSampler(const std::vector<uint64_t>& capacities, double rate, size_t maxBlocks,
+                             double weightScale) :
+    capacities(&capacities),
+    weightScale(weightScale),
+    maxBlocks(maxBlocks),
+    threshold(maxBlocks > 0 ? modulus :
+              std::max<uint32_t>(1, static_cast<uint32_t>(std::min(1.0, rate) * modulus + 0.5))),
+    tree(1025, 0),
+    nextTime(1),
+    reuseWeights(capacities.size() + 1, 0.0),
+    coldWeight(0.0),
+    sampledReferences(0) {
+}
+
+void ShardsSampler::mark(uint32_t time, int delta) {
+    for (uint32_t t = time; t < tree.size(); t += t & (~t + 1)) {
+        tree[t] += delta;
+    }
+}
+
+uint32_t ShardsSampler::countUpTo(uint32_t time) const {
+    uint32_t count = 0;
+    for (uint32_t t = time; t > 0; t -= t & (~t + 1)) {
+        count += tree[t];
+    }
+    return count;
+}
+
+void ShardsSampler::compact() {
+    // Renumber the live reference times 1..L in order and rebuild the tree with room to grow
+    std::vector<std::pair<uint32_t, address_t>> live;
+    live.reserve(lastReference.size());
+    for (const std::pair<const address_t, uint32_t>& entry : lastReference) {
+        live.push_back(std::make_pair(entry.second, entry.first));
+    }
+    std::sort(live.begin(), live.end());
+
+    tree.assign(std::max<size_t>(1024, 2 * live.size()) + 1, 0);
+    for (size_t i = 0; i < live.size(); i++) {
+        uint32_t time = static_cast<uint32_t>(i + 1);
+        lastReference[live[i].second] = time;
+        tree[time] = 1;
+    }
+    // Linear-time Fenwick build: push every node's count into its parent
+    for (uint32_t t = 1; t < tree.size(); t++) {
+        uint32_t parent = t + (t & (~t + 1));
+        if (parent < tree.size()) {
+            tree[parent] += tree[t];
+        }
+    }
+    nextTime = static_cast<uint32_t>(live.size() + 1);
+}
+
+void ShardsSampler::evictLargestHash() {
+    // Lower the threshold to the largest sampled hash; every block at or above it leaves
+    threshold = byHash.rbegin()->first;
+    while (!byHash.empty() && byHash.rbegin()->first >= threshold) {
+        std::unordered_map<address_t, uint32_t>::iterator it = lastReference.find(byHash.rbegin()->second);
+        mark(it->second, -1);
+        lastReference.erase(it);
+        byHash.erase(std::prev(byHash.end()));
+    }
+}
+
+void ShardsSampler::access(address_t block, uint32_t hash) {
+    if (hash >= threshold) {
+        return;
+    }
+
+    double rate = static_cast<double>(threshold) / modulus;
+    double weight = weightScale / rate;
+    sampledReferences++;
+
+    if (nextTime >= tree.size()) {
+        compact();
+    }
+    uint32_t time = nextTime++;
+
+    std::unordered_map<address_t, uint32_t>::iterator it = lastReference.find(block);
+    if (it == lastReference.end()) {
+        coldWeight += weight;
+        lastReference.insert(std::make_pair(block, time));
+        mark(time, 1);
+        if (maxBlocks > 0) {
+            byHash.insert(std::make_pair(hash, block));
+            if (byHash.size() > maxBlocks) {
+                evictLargestHash();
+            }
+        }
+        return;
+    }
+
+    // Every marked time after the previous reference is a distinct sampled block
+    uint32_t previous = it->second;
+    double distance = (lastReference.size() - countUpTo(previous)) / rate;
+    size_t bin = std::upper_bound(capacities->begin(), capacities->end(), static_cast<uint64_t>(distance)) -
+                 capacities->begin();
+    reuseWeights[bin] += weight;
+
+    mark(previous, -1);
+    mark(time, 1);
+    it->second = time;
+}
+
+double ShardsSampler::getMisses(size_t index) const {
+    double misses = coldWeight;
+    for (size_t bin = index + 1; bin < reuseWeights.size(); bin++) {
+        misses += reuseWeights[bin];
+    }
+    return misses;
+}
+
+double ShardsSampler::getHits(size_t index) const {
+    double hits = 0.0;
+    for (size_t bin = 0; bin <= index && bin < reuseWeights.size(); bin++) {
+        hits += reuseWeights[bin];
+    }
+    return hits;
+}
+
+double ShardsSampler::getRate() const {
+    return static_cast<double>(threshold) / modulus;
+}
+
+double ShardsSampler::getEstimatedBlocks() const {
+    return coldWeight / weightScale;
+}
+
+size_t ShardsSampler::getSampledBlocks() const {
+    return lastReference.size();
+}
+
+uint64_t ShardsSampler::getSampledReferences() const {
+    return sampledReferences;
+}
+
+const std::vector<uint64_t>& ShardsProfiler::getCapacities() {
+    // Shared by every sampler; built once (thread-safe static initialization)
+    static const std::vector<uint64_t> capacities = makeCapacities();
+    return capacities;
+}
+
+std::vector<uint64_t> ShardsProfiler::makeCapacities() {
+    std::vector<uint64_t> capacities;
+    for (uint64_t lines = 1; lines <= 64; lines++) {
+        capacities.push_back(lines);
+    }
+    for (int step = 1; step <= 16 * 26; step++) {
+        uint64_t lines = static_cast<uint64_t>(std::llround(64.0 * std::pow(2.0, step / 16.0)));
+        if (lines > capacities.back()) {
+            capacities.push_back(lines);
+        }
+    }
+    return capacities;
+}
+
+ShardsProfiler::ShardsProfiler(int blockBits, double rate, size_t maxBlocks) :
+    blockBits(blockBits),
+    accesses(0),
+    sample(getCapacities(), rate, maxBlocks, 1.0) {
+    size_t partitionBlocks = maxBlocks > 0 ? std::max<size_t>(1, maxBlocks / partitions) : 0;
+    for (int i = 0; i < partitions; i++) {
+        partitionSamples.push_back(ShardsSampler(getCapacities(), rate, partitionBlocks, partitions));
+    }
+}
+
+void ShardsProfiler::profile(const DecodedTrace& trace) {
+    for (const TraceEntry& entry : trace) {
+        address_t block = entry.addr >> blockBits;
+
+        // splitmix64 finalizer: the low 24 bits pick the sample, bits 32+ the partition
+        uint64_t hash = block;
+        hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebULL;
+        hash ^= hash >> 31;
+        uint32_t sampleHash = static_cast<uint32_t>(hash & (ShardsSampler::modulus - 1));
+
+        sample.access(block, sampleHash);
+        partitionSamples[(hash >> 32) % partitions].access(block, sampleHash);
+        accesses++;
+    }
+}
+
+double ShardsProfiler::getMissRatio(size_t index) const {
+    double references = sample.getMisses(0) + sample.getHits(0);
+    return references > 0.0 ? sample.getMisses(index) / references : 0.0;
+}
+
+double ShardsProfiler::getStandardError(size_t index) const {
+    if (accesses == 0) {
+        return 0.0;
+    }
+    double ratios[partitions];
+    double mean = 0.0;
+    for (int i = 0; i < partitions; i++) {
+        double references = partitionSamples[i].getMisses(0) + partitionSamples[i].getHits(0);
+        ratios[i] = references > 0.0 ? partitionSamples[i].getMisses(index) / references : 0.0;
+        mean += ratios[i] / partitions;
+    }
+    double variance = 0.0;
+    for (int i = 0; i < partitions; i++) {
+        variance += (ratios[i] - mean) * (ratios[i] - mean) / (partitions - 1);
+    }
+    return std::sqrt(variance / partitions);
+}
+
+uint64_t ShardsProfiler::getAccesses() const {
+    return accesses;
+}
+
+const ShardsSampler& ShardsProfiler::getSample() const {
+    return sample;
+}
@@ -0,0 +1,95 @@
+#ifndef SHARDS_H
+#define SHARDS_H
+
+#include <vector>
+#include <set>
+#include <unordered_map>
+#include <ostream>
+#include "Types.h"
+#include "TraceReader.h"
+
+// One spatially-hashed sample of a reference stream (SHARDS). A block is sampled when
+// its hash falls below the threshold T, so the rate is R = T / modulus and every
+// reference to a sampled block is seen. Stack distances measured among the sampled
+// blocks are scaled by 1/R, and each sampled reference stands for 1/R references.
+// Memory is proportional to the sampled distinct blocks: with a size limit, the block
+// with the largest hash is dropped when the limit is exceeded and T is lowered to its
+// hash, so the rate adapts to keep at most maxBlocks blocks.
+class ShardsSampler {
+private:
+    const std::vector<uint64_t>* capacities; // Curve capacities in lines (ascending)
+    double weightScale;          // Extra weight of each sample (partitions see 1/G of the blocks)
+    size_t maxBlocks;            // 0 = fixed rate
+    uint32_t threshold;          // Sample blocks with hash < threshold
+
+    // Latest reference time of every sampled block, and a Fenwick tree over those times
+    // in which only the latest reference of each block is marked. Times are renumbered
+    // when the tree fills up, so its size stays proportional to the sampled blocks.
+    std::unordered_map<address_t, uint32_t> lastReference;
+    std::vector<uint32_t> tree;
+    uint32_t nextTime;
+    std::set<std::pair<uint32_t, address_t>> byHash; // Sampled blocks by hash (size-limited mode)
+
+    // Estimated references per capacity bin: bin i holds the reuses whose scaled
+    // distance reaches capacities[0..i-1], i.e. that miss in caches up to capacities[i-1]
+    std::vector<double> reuseWeights;
+    double coldWeight;
+    uint64_t sampledReferences;
+
+    void mark(uint32_t time, int delta);
+    uint32_t countUpTo(uint32_t time) const;
+    void compact();
+    void evictLargestHash();
+
+public:
+    static const uint32_t modulus = 1u << 24;
+
+    ShardsSampler(const std::vector<uint64_t>& capacities, double rate, size_t maxBlocks, double weightScale);
+
+    // Feed one reference; hash is the block's 24-bit sampling hash
+    void access(address_t block, uint32_t hash);
+
+    // Estimated misses of a fully-associative LRU cache of capacities[index] lines
+    double getMisses(size_t index) const;
+    double getHits(size_t index) const;
+
+    double getRate() const;
+    double getEstimatedBlocks() const;  // Distinct blocks of the whole stream
+    size_t getSampledBlocks() const;
+    uint64_t getSampledReferences() const;
+};
+
+// Sampled miss-ratio curve of one core's trace. The main sample gives the estimate;
+// the same blocks are also split by another hash into independent partitions, each a
+// SHARDS sample of its own, and the spread of their curves gives the standard error.
+// Ratios are taken over the sample's own estimated reference count: with a few very hot
+// blocks (as in our traces) dividing by the true count instead (SHARDS-adj) overshoots.
+class ShardsProfiler {
+private:
+    static const int partitions = 8;
+
+    int blockBits;
+    uint64_t accesses;
+    ShardsSampler sample;
+    std::vector<ShardsSampler> partitionSamples;
+
+    static std::vector<uint64_t> makeCapacities();
+
+public:
+    // rate: fixed sampling rate (used when maxBlocks is 0); maxBlocks: sample size limit
+    ShardsProfiler(int blockBits, double rate, size_t maxBlocks);
+
+    void profile(const DecodedTrace& trace);
+
+    // Curve capacities: every size up to 64 lines, then 16 per octave
+    static const std::vector<uint64_t>& getCapacities();
+
+    // Miss ratio estimate and its standard error at capacities[index]
+    double getMissRatio(size_t index) const;
+    double getStandardError(size_t index) const;
+
+    uint64_t getAccesses() const;
+    const ShardsSampler& getSample() const;
+};
+
+#endif // SHARDS_H
@@ -4,18 +4,93 @@
 #include <iomanip>
 #include <cmath>
 #include <cassert>
+#include <algorithm>
+#include <stdexcept>
+#include <chrono>
+#include <limits>
+#include "ParallelEngine.h"
+#include "Checkpoint.h"
+#include "Trace.h"
 
-// Initialize static debug flag (default: enabled)
-bool Simulator::debugEnabled = true;
+// Initialize static debug flag (default: disabled; -d turns it on with the trace output)
+bool Simulator::debugEnabled = false;
 
-Simulator::Simulator(const std::string& traceBase, int s, int E, int b) :
+const int Simulator::setGroups;
+
+Simulator::Simulator(const std::string& traceBase, int s, int E, int b, const SimulatorConfig& config) :
     currentCycle(0),
-    bus(b), // Initialize bus with block size bits
     traceBaseName(traceBase),
-    numCores(4), // Fixed for this assignment
+    numCores(config.numCores > 0 ? config.numCores :
+             (!config.traces.empty() ? static_cast<int>(config.traces.size()) : detectCoreCount(traceBase))),
+    finishedCores(0),
     indexBits(s),
     associativity(E),
-    blockOffsetBits(b) {
+    blockOffsetBits(b),
+    config(config),
+    wallSeconds(0.0),
+    truncated(false),
+    checkpointSaved(false),
+    restoredCycle(0),
+    detailedRecords(0),
+    detailedCycles(0),
+    estimatedCycles(0) {
+    
+    // Every core needs its own trace file
+    int tracesFound = !config.traces.empty() ? static_cast<int>(config.traces.size()) : detectCoreCount(traceBase);
+    if (tracesFound == 0) {
+        throw std::runtime_error("no trace files found (expected " + traceBase + "_proc0.trace)");
+    }
+    if (numCores > tracesFound) {
+        throw std::runtime_error("trace file not found: " + traceBase + "_proc" +
+                                 std::to_string(tracesFound) + ".trace (" +
+                                 std::to_string(numCores) + " cores requested)");
+    }
+    
+    // Create the coherence fabric (block size bits determine the transfer size)
+    interconnect.reset(createInterconnect(config, b, numCores));
+    
+    // Optional banked DRAM shared behind the interconnect
+    if (config.dramModel) {
+        memoryController.reset(new MemoryController(b, config.dram));
+        interconnect->setMemoryController(memoryController.get());
+    }
+    
+    // Optional log of every bus transaction (with set sampling the caches hold the sampled sets only)
+    if (!config.busLogFile.empty()) {
+        busLog.reset(new BusLogWriter());
+        if (!busLog->open(config.busLogFile, numCores, s - config.setSampleBits, E, b)) {
+            throw std::runtime_error("cannot create bus log: " + config.busLogFile);
+        }
+        interconnect->setEventLog(busLog.get());
+    }
+    
+    // Optional timeline; its bus lanes are fed from the transaction records of the log
+    if (!config.timelineFile.empty()) {
+        timeline.reset(new Timeline());
+        if (!timeline->open(config.timelineFile, numCores, config.timelineStart, config.timelineEnd,
+                            config.timelinePeriod, config.timelineLength)) {
+            throw std::runtime_error("cannot create timeline: " + config.timelineFile);
+        }
+        if (!busLog) {
+            busLog.reset(new BusLogWriter());
+            interconnect->setEventLog(busLog.get());
+        }
+        busLog->setListener(timeline.get());
+    }
+    
+    // Optional per-interval time series
+    if (!config.intervalFile.empty()) {
+        intervalSampler.reset(new IntervalSampler());
+        if (!intervalSampler->open(config.intervalFile, numCores, config.intervalCycles, config.intervalInstructions)) {
+            throw std::runtime_error("cannot create interval statistics file: " + config.intervalFile);
+        }
+    }
+    
+    // Optional latency histograms
+    if (config.latencyHistograms) {
+        latencyStats.reset(new LatencyStats(numCores));
+        interconnect->setLatencyStats(latencyStats.get());
+    }
     
     // Calculate derived parameters
     blockSize = 1 << blockOffsetBits;
@@ -26,63 +101,188 @@ Simulator::Simulator(const std::string& traceBase, int s, int E, int b) :
     cores.reserve(numCores);
     caches.reserve(numCores);
     
-    DEBUG_PRINT("Simulator initialized with parameters: ");
-    DEBUG_PRINT("  Index bits (s): " << indexBits);
-    DEBUG_PRINT("  Associativity (E): " << associativity);
-    DEBUG_PRINT("  Block offset bits (b): " << blockOffsetBits);
-    DEBUG_PRINT("  Block size: " << blockSize << " bytes");
-    DEBUG_PRINT("  Cache size per core: " << (cacheSize / 1024.0) << " KB");
+    TRACE(SimulatorInit);
+    TRACE(SimulatorCores, numCores);
+    TRACE(SimulatorIndexBits, indexBits);
+    TRACE(SimulatorAssociativity, associativity);
+    TRACE(SimulatorBlockBits, blockOffsetBits);
+    TRACE(SimulatorBlockSize, blockSize);
+    TRACE(SimulatorCacheSize, cacheSize / 1024.0);
+}
+
+Interconnect* Simulator::createInterconnect(const SimulatorConfig& config, int b, int numCores) {
+    if (config.interconnect == InterconnectType::Network) {
+        return new Network(b, numCores, config.network);
+    }
+    Bus* bus = new Bus(b, config.busSlices, config.sliceHash);
+    bus->setReadCoalescing(config.coalesceReads);
+    bus->setFillPolicy(config.memoryFillPolicy, config.cacheFillPolicy);
+    return bus;
 }
 
 void Simulator::initialize() {
+    // Set sampling: the cores replay only the accesses to the sampled sets, with those sets
+    // packed into a cache of 2^(s - setSampleBits) sets
+    std::vector<std::shared_ptr<const DecodedTrace>> traces = config.traces;
+    int cacheIndexBits = indexBits;
+    if (config.setSampleBits > 0) {
+        if (traces.empty()) {
+            traces = TraceReader::decodeTraces(traceBaseName, numCores, numCores);
+        }
+        for (int i = 0; i < numCores; i++) {
+            uint64_t writes = 0;
+            for (const TraceEntry& entry : *traces[i]) {
+                writes += (entry.op == MemOperation::WRITE);
+            }
+            fullTraceReads.push_back(traces[i]->size() - writes);
+            fullTraceWrites.push_back(writes);
+            traces[i] = std::make_shared<const DecodedTrace>(
+                TraceReader::sampleSets(*traces[i], indexBits, blockOffsetBits, config.setSampleBits));
+        }
+        cacheIndexBits = indexBits - config.setSampleBits;
+    }
+    
     // Create caches
     for (int i = 0; i < numCores; i++) {
-        caches.emplace_back(i, indexBits, associativity, blockOffsetBits, &bus);
-        bus.addCache(&caches.back());
+        caches.emplace_back(i, cacheIndexBits, associativity, blockOffsetBits, interconnect.get());
+        interconnect->addCache(&caches.back());
+        if (config.setSampleBits > 0) {
+            caches.back().trackSetGroups(std::min(setGroups, 1 << cacheIndexBits));
+        }
+    }
+    
+    // Optional miss classification; the shadow caches have as many lines as the real ones
+    if (config.classifyMisses) {
+        sharingTracker.reset(new SharingTracker());
+        missClassifiers.reserve(numCores);
+        for (int i = 0; i < numCores; i++) {
+            missClassifiers.emplace_back(sharingTracker.get(), (1 << cacheIndexBits) * associativity, blockOffsetBits);
+            caches[i].setMissClassifier(&missClassifiers.back());
+        }
+    }
+    
+    // Optional hot line tracking; tracking more lines than are reported keeps the
+    // space-saving overcounts of the reported ones small
+    if (config.hotLines > 0) {
+        hotLineTracker.reset(new HotLineTracker(config.hotLines * hotLineTrackingFactor, numCores, blockOffsetBits));
+        for (Cache& cache : caches) {
+            cache.setHotLineTracker(hotLineTracker.get());
+        }
     }
     
-    // Create cores with their trace files
+    // Optional per-pair invalidation and supply counts
+    if (config.interactionMatrix) {
+        for (Cache& cache : caches) {
+            cache.setInteractionCounting(true);
+        }
+    }
+    
+    // Create cores with their trace files (or the traces already decoded in memory)
     for (int i = 0; i < numCores; i++) {
-        std::string tracePath = traceBaseName + "_proc" + std::to_string(i) + ".trace";
-        cores.emplace_back(i, &caches[i], tracePath);
+        if (!traces.empty()) {
+            cores.emplace_back(i, &caches[i], traces[i]);
+        } else {
+            std::string tracePath = traceBaseName + "_proc" + std::to_string(i) + ".trace";
+            cores.emplace_back(i, &caches[i], tracePath);
+        }
     }
     
-    DEBUG_PRINT("Initialized " << numCores << " cores and caches.");
+    TRACE(SimulatorCoresInitialized, numCores);
 }
 
 void Simulator::run() {
     // Initialize the simulation components
     initialize();
     
-    DEBUG_PRINT("Starting simulation...");
+    TRACE(SimulationStart);
+    
+    // Without a cycle limit the simulation runs until every core has finished its trace
+    cycle_t maxCycles = config.maxCycles > 0 ? config.maxCycles : std::numeric_limits<cycle_t>::max();
+    
+    if (!config.restoreFile.empty()) {
+        loadCheckpoint(config.restoreFile);
+    }
+    
+    std::chrono::steady_clock::time_point wallStart = std::chrono::steady_clock::now();
     
-    // Define a maximum cycle count to prevent infinite loops
-    const cycle_t MAX_CYCLES = 20000000; // 20 million cycles maximum
+    // Debug output is not thread-safe, and the timeline and interval statistics sample every
+    // cycle, so they always run on the serial loop. So does the stall breakdown: the parallel
+    // engine counts a core's idle cycles only when it catches up after its miss completed.
+    // Miss classification and hot line tracking share their records between the cores' caches.
+    bool sampled = config.sampling.interval > 0;
+    bool perCycle = timeline || intervalSampler || config.stallBreakdown || config.classifyMisses || hotLineTracker;
+    bool parallel = config.threads > 0 && !debugEnabled && !perCycle && !sampled;
+    if (config.threads > 0 && debugEnabled) {
+        Tracer::flush();
+        std::cerr << "WARNING: Debug output requires the serial engine; ignoring --threads." << std::endl;
+    } else if (config.threads > 0 && perCycle) {
+        std::cerr << "WARNING: The timeline, interval statistics, stall breakdown, miss classification and "
+                  << "hot lines require the serial engine; ignoring --threads." << std::endl;
+    }
+    if (intervalSampler) {
+        intervalSampler->begin(currentCycle, cores, caches, *interconnect);
+    }
+    
+    if (sampled) {
+        runSampled(maxCycles);
+    } else if (parallel) {
+        runParallel(maxCycles);
+    }
     
     // Run until all cores are finished or max cycles reached
-    while (!checkFinished() && currentCycle < MAX_CYCLES) {
+    while (!parallel && !sampled && !checkFinished() && currentCycle < maxCycles) {
+        checkpointIfDue();
         tick();
         
-        // Print debug info every 10000 cycles when debugging is enabled
-        if (debugEnabled && currentCycle % 10000 == 0) {
-            std::cout << "DEBUG: Cycle " << currentCycle << ": ";
+        // Trace the core states every 10000 cycles
+        if (TRACE_ACTIVE(SimulationStatus) && currentCycle % 10000 == 0) {
+            std::string states;
             for (int i = 0; i < numCores; i++) {
-                std::cout << "Core " << i << " " 
-                          << (cores[i].isFinished() ? "finished" : 
-                             (cores[i].isBlocked() ? "blocked" : "running"))
-                          << ", ";
+                states += "Core " + std::to_string(i) + " " +
+                          (cores[i].isFinished() ? "finished" : (cores[i].isBlocked() ? "blocked" : "running")) +
+                          ", ";
             }
-            std::cout << "Bus queue size: " << bus.getQueueSize() << std::endl;
+            TRACE(SimulationStatus, currentCycle, states, interconnect->getQueueSize());
         }
     }
     
-    if (currentCycle >= MAX_CYCLES) {
-        std::cout << "WARNING: Simulation stopped after reaching maximum cycle count (" 
-                  << MAX_CYCLES << "). This may indicate that some cores didn't finish their traces. "
-                  << "Consider using fewer traces or increasing the maximum cycle count." << std::endl;
+    wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    
+    // A checkpoint at the very last cycle is still taken; one the run never reached is reported
+    checkpointIfDue();
+    if (!config.checkpointFile.empty() && !checkpointSaved) {
+        std::cerr << "WARNING: The simulation ended at cycle " << currentCycle << " before reaching the checkpoint cycle ("
+                  << config.checkpointCycle << "); no checkpoint was saved." << std::endl;
     }
     
-    DEBUG_PRINT("Simulation completed at cycle " << currentCycle);
+    // A truncated run is reported in the statistics as well, never only on the console
+    truncated = !checkFinished();
+    if (truncated) {
+        std::cerr << "WARNING: Simulation stopped at the cycle limit (" << maxCycles << ") with "
+                  << (numCores - finishedCores) << " of " << numCores
+                  << " cores unfinished; statistics cover the truncated run only." << std::endl;
+    }
+    
+    TRACE(SimulationComplete, currentCycle);
+    
+    if (busLog) {
+        busLog->close();
+    }
+    if (timeline) {
+        timeline->close(currentCycle);
+    }
+    if (intervalSampler) {
+        intervalSampler->finish(currentCycle, cores, caches, *interconnect);
+    }
+    
+    if (sampled && !sampleWindows.empty()) {
+        applyEstimates();
+        return;
+    }
+    if (sampled) {
+        std::cerr << "WARNING: No sample window was measured (traces shorter than the sampling interval); "
+                  << "cycle counts cover the detailed phases only." << std::endl;
+    }
     
     // Update total cycles for each core
     // This is the cycle when the last core finished
@@ -90,8 +290,7 @@ void Simulator::run() {
         // The individual core's execution cycles are:
         // totalCycles = simulationCycles - idleCycles
         // idleCycles are counted separately in Core::incrementIdleCycle
-        DEBUG_PRINT("Core " << core.getId() << " execution cycles: " 
-                  << (currentCycle - core.getIdleCycles()));
+        TRACE(CoreExecutionCycles, core.getId(), currentCycle - core.getIdleCycles());
         core.setTotalCycles(currentCycle - core.getIdleCycles());
     }
 }
@@ -103,7 +302,7 @@ void Simulator::tick() {
     // 1. Check if current transactions are complete
     // 2. Start processing the next request from the queue (if any)
     // 3. Broadcast snoops to all caches
-    bus.tick(currentCycle);
+    interconnect->tick(currentCycle);
     
     // Phase 2: Have each core perform one operation in this cycle
     // All cores conceptually act simultaneously, but we simulate them sequentially
@@ -114,38 +313,334 @@ void Simulator::tick() {
         if (!core.isFinished()) {
             core.tick(currentCycle);
             // Core may have issued a transaction to the bus, but it won't be processed 
-            // until the next cycle's bus.tick(), preserving the illusion of concurrent execution
+            // until the next cycle's interconnect->tick(), preserving the illusion of concurrent execution
+            if (core.isFinished()) {
+                finishedCores++;
+            }
         }
     }
     
     // Update idle cycle counts
     for (Core& core : cores) {
         if (!core.isFinished() && core.isBlocked()) {
-            core.incrementIdleCycle();
+            core.incrementIdleCycle(interconnect->getStallCause(core.getId()));
         }
     }
     
+    if (timeline) {
+        for (int i = 0; i < numCores; i++) {
+            const Core& core = cores[i];
+            timeline->recordCore(currentCycle, i, core.isFinished() ? CoreActivity::Finished :
+                                 (core.isBlocked() ? CoreActivity::Blocked : CoreActivity::Running));
+        }
+        timeline->recordQueueDepth(currentCycle, interconnect->getQueueSize());
+    }
+    if (intervalSampler) {
+        intervalSampler->sample(currentCycle, cores, caches, *interconnect);
+    }
+    
     // Advance simulation time
     currentCycle++;
 }
 
-bool Simulator::checkFinished() {
-    bool allFinished = true;
-    for (const Core& core : cores) {
-        if (!core.isFinished()) {
-            allFinished = false;
+void Simulator::runParallel(cycle_t maxCycles) {
+    ParallelEngine engine(config.threads);
+    int numThreads = engine.getNumThreads();
+    cycle_t quantum = static_cast<cycle_t>(std::max(1, config.quantum));
+    std::vector<cycle_t> finishCycles(numCores, 0);
+    std::vector<cycle_t> localCycles(numCores, currentCycle); // Next cycle each core will execute
+    
+    TRACE(ParallelEngineStart, numThreads, quantum);
+    
+    // One cycle of a core at its local cycle, as in tick()
+    auto stepCore = [&](int i) {
+        Core& core = cores[i];
+        cycle_t& cycle = localCycles[i];
+        core.tick(cycle);
+        if (core.isFinished()) {
+            finishCycles[i] = cycle;
+        } else if (core.isBlocked()) {
+            core.incrementIdleCycle(interconnect->getStallCause(i));
+        }
+        cycle++;
+    };
+    
+    while (!checkFinished() && currentCycle < maxCycles) {
+        cycle_t quantumStart = currentCycle;
+        cycle_t quantumEnd = std::min(currentCycle + quantum, maxCycles);
+        
+        // Phase 1: the interconnect acts first in a cycle, as in tick()
+        interconnect->tick(quantumStart);
+        
+        // Phase 2: every core runs through the quantum on its worker thread. Cores only touch
+        // their own cache; requests they issue are staged per core instead of reaching the bus.
+        // A core waiting on a bus transaction stops at its local cycle until the replay below
+        // reaches it. Cores running ahead see other cores' snoops of this quantum late (the
+        // timing skew of the relaxed mode; a quantum of 1 matches the serial loop).
+        interconnect->setRequestStaging(true);
+        engine.runPhase([&](int worker) {
+            for (int i = worker; i < numCores; i += numThreads) {
+                while (localCycles[i] < quantumEnd && !cores[i].isFinished()) {
+                    if (cores[i].isBlocked() && caches[i].isBlocked()) {
+                        break; // Only the interconnect can complete this miss
+                    }
+                    stepCore(i);
+                }
+            }
+        });
+        interconnect->setRequestStaging(false);
+        
+        // Once every core is done the interconnect stops at the last core's final cycle
+        finishedCores = 0;
+        cycle_t lastCycle = quantumEnd - 1;
+        for (int i = 0; i < numCores; i++) {
+            if (cores[i].isFinished()) {
+                finishedCores++;
+            }
+        }
+        if (finishedCores == numCores) {
+            lastCycle = *std::max_element(finishCycles.begin(), finishCycles.end());
+        }
+        
+        // Phase 3: replay the interconnect over the quantum, releasing the staged requests
+        // of each cycle before the interconnect tick of the next one. Cores that stopped on a
+        // miss step along with the replay, so they restart in the cycle their miss completes
+        // rather than at the next quantum.
+        for (cycle_t cycle = quantumStart; cycle <= lastCycle; cycle++) {
+            interconnect->setRequestStaging(true);
+            for (int i = 0; i < numCores; i++) {
+                if (localCycles[i] == cycle && !cores[i].isFinished()) {
+                    stepCore(i);
+                    if (cores[i].isFinished() && ++finishedCores == numCores) {
+                        lastCycle = *std::max_element(finishCycles.begin(), finishCycles.end());
+                    }
+                }
+            }
+            interconnect->setRequestStaging(false);
+            interconnect->releaseStagedRequests(cycle);
+            if (cycle < lastCycle) {
+                interconnect->tick(cycle + 1);
+            }
+        }
+        
+        currentCycle = lastCycle + 1;
+    }
+}
+
+void Simulator::runSampled(cycle_t maxCycles) {
+    const SamplingParameters& sampling = config.sampling;
+    uint64_t fastForwardRecords = sampling.interval - std::min(sampling.interval, sampling.warmup + sampling.window);
+    
+    progressRates.assign(numCores, 1.0);
+    
+    TRACE(SampledStart, fastForwardRecords, sampling.warmup, sampling.window);
+    
+    while (!checkFinished() && currentCycle < maxCycles) {
+        fastForward(fastForwardRecords);
+        
+        cycle_t detailedStart = currentCycle;
+        uint64_t recordsBefore = 0;
+        for (const Core& core : cores) {
+            recordsBefore += core.getInstructionCount();
+        }
+        
+        runDetailed(sampling.warmup, maxCycles);
+        
+        // Measured window
+        SampleWindow window;
+        window.cycles = currentCycle;
+        for (int i = 0; i < numCores; i++) {
+            window.instructions.push_back(cores[i].getInstructionCount());
+            window.idleCycles.push_back(cores[i].getIdleCycles());
+            window.accesses.push_back(caches[i].getAccesses());
+            window.misses.push_back(caches[i].getMisses());
+        }
+        runDetailed(sampling.window, maxCycles);
+        window.cycles = currentCycle - window.cycles;
+        for (int i = 0; i < numCores; i++) {
+            window.instructions[i] = cores[i].getInstructionCount() - window.instructions[i];
+            window.idleCycles[i] = cores[i].getIdleCycles() - window.idleCycles[i];
+            window.accesses[i] = caches[i].getAccesses() - window.accesses[i];
+            window.misses[i] = caches[i].getMisses() - window.misses[i];
+            if (cores[i].isFinished()) {
+                // The window also covers time after this core's last record; leave it out
+                window.instructions[i] = 0;
+            }
+        }
+        if (window.cycles > 0) {
+            sampleWindows.push_back(window);
+            
+            // Relative progress of the running cores steers the next fast-forward
+            uint64_t leading = *std::max_element(window.instructions.begin(), window.instructions.end());
+            for (int i = 0; i < numCores && leading > 0; i++) {
+                progressRates[i] = static_cast<double>(window.instructions[i]) / leading;
+            }
+        }
+        
+        drain(maxCycles);
+        
+        detailedCycles += currentCycle - detailedStart;
+        for (const Core& core : cores) {
+            detailedRecords += core.getInstructionCount();
+        }
+        detailedRecords -= recordsBefore;
+    }
+}
+
+void Simulator::fastForward(uint64_t records) {
+    // The leading core executes the given number of records; the others advance in proportion
+    // to their progress in the last measured window, so the cores stay as far apart in their
+    // traces as they would in a detailed run. The cycle count only advances to keep the LRU
+    // timestamps ordered.
+    std::vector<double> credit(numCores, 0.0);
+    for (uint64_t step = 0; step < records && !checkFinished(); step++) {
+        for (int i = 0; i < numCores; i++) {
+            credit[i] += progressRates[i];
+            while (credit[i] >= 1.0 && !cores[i].isFinished()) {
+                credit[i] -= 1.0;
+                if (!cores[i].functionalStep(currentCycle)) {
+                    finishedCores++;
+                }
+            }
+        }
+        currentCycle++;
+    }
+}
+
+void Simulator::runDetailed(uint64_t records, cycle_t maxCycles) {
+    // Runs until the leading core has executed the given number of records
+    std::vector<uint64_t> targets(numCores);
+    for (int i = 0; i < numCores; i++) {
+        targets[i] = cores[i].getInstructionCount() + records;
+    }
+    
+    while (!checkFinished() && currentCycle < maxCycles) {
+        bool reached = false;
+        for (int i = 0; i < numCores; i++) {
+            if (!cores[i].isFinished() && cores[i].getInstructionCount() >= targets[i]) {
+                reached = true;
+                break;
+            }
+        }
+        if (reached) {
             break;
         }
+        tick();
+    }
+}
+
+void Simulator::drain(cycle_t maxCycles) {
+    // Let outstanding misses complete without issuing new accesses, so the functional
+    // fast-forward never overtakes a transaction still in flight. Queued writebacks stay:
+    // the backlog they form under load is part of the state the next window must see.
+    while (currentCycle < maxCycles) {
+        bool busy = false;
+        for (const Cache& cache : caches) {
+            busy = busy || cache.isBlocked();
+        }
+        if (!busy) {
+            break;
+        }
+        interconnect->tick(currentCycle);
+        currentCycle++;
+    }
+}
+
+// Ratio estimate sum(y) / sum(x) over the windows and its 95% confidence half-width
+// (normal approximation, delta-method variance). Weighting every window by its x keeps
+// windows in which a core barely ran from dominating, as they would in a mean of ratios.
+static void estimateRatio(const std::vector<double>& y, const std::vector<double>& x,
+                          double& ratio, double& halfWidth) {
+    ratio = 0.0;
+    halfWidth = 0.0;
+    double sumY = 0.0;
+    double sumX = 0.0;
+    for (size_t k = 0; k < x.size(); k++) {
+        sumY += y[k];
+        sumX += x[k];
+    }
+    if (sumX <= 0.0) {
+        return;
+    }
+    ratio = sumY / sumX;
+    size_t n = x.size();
+    if (n < 2) {
+        return;
+    }
+    double residuals = 0.0;
+    for (size_t k = 0; k < n; k++) {
+        residuals += (y[k] - ratio * x[k]) * (y[k] - ratio * x[k]);
+    }
+    double meanX = sumX / n;
+    halfWidth = 1.96 * std::sqrt(residuals / (n - 1) / n) / meanX;
+}
+
+Simulator::SampleEstimate Simulator::estimateCore(int core) const {
+    std::vector<double> cycles, idleCycles, instructions;
+    std::vector<double> misses, accesses;
+    for (const SampleWindow& window : sampleWindows) {
+        if (window.instructions[core] == 0) {
+            continue;
+        }
+        cycles.push_back(static_cast<double>(window.cycles));
+        idleCycles.push_back(static_cast<double>(window.idleCycles[core]));
+        instructions.push_back(static_cast<double>(window.instructions[core]));
+        misses.push_back(static_cast<double>(window.misses[core]));
+        accesses.push_back(static_cast<double>(window.accesses[core]));
     }
     
+    SampleEstimate estimate;
+    double idleHalfWidth;
+    estimateRatio(cycles, instructions, estimate.cpi, estimate.cpiHalfWidth);
+    estimateRatio(idleCycles, instructions, estimate.idlePerInstruction, idleHalfWidth);
+    estimateRatio(misses, accesses, estimate.missRate, estimate.missRateHalfWidth);
+    estimate.windows = instructions.size();
+    return estimate;
+}
+
+void Simulator::applyEstimates() {
+    // Every core's cycle count in a full run is measured up to the end of the simulation,
+    // i.e. until the slowest core finishes
+    estimatedCycles = 0;
+    estimatedIdleCycles.assign(numCores, 0);
+    for (int i = 0; i < numCores; i++) {
+        SampleEstimate estimate = estimateCore(i);
+        uint64_t instructions = cores[i].getInstructionCount();
+        estimatedCycles = std::max(estimatedCycles, static_cast<cycle_t>(estimate.cpi * instructions + 0.5));
+        estimatedIdleCycles[i] = static_cast<cycle_t>(estimate.idlePerInstruction * instructions + 0.5);
+    }
+    for (int i = 0; i < numCores; i++) {
+        cores[i].setTotalCycles(estimatedCycles - std::min(estimatedCycles, estimatedIdleCycles[i]));
+    }
+}
+
+bool Simulator::checkFinished() {
+    // Kept as a running count so the per-cycle check stays O(1) in the number of cores
+    bool allFinished = (finishedCores == numCores);
+    
     if (allFinished && currentCycle % 100 == 0) {
-        DEBUG_PRINT("All cores finished at cycle " << currentCycle);
+        TRACE(AllCoresFinished, currentCycle);
     }
     
     return allFinished;
 }
 
+int Simulator::detectCoreCount(const std::string& traceBase) {
+    int count = 0;
+    while (true) {
+        std::ifstream trace(traceBase + "_proc" + std::to_string(count) + ".trace");
+        if (!trace.is_open()) {
+            break;
+        }
+        count++;
+    }
+    return count;
+}
+
 void Simulator::printStats(const std::string& outfile) {
+    // Pending trace records come before the statistics
+    Tracer::flush();
+    
     // Prepare output stream
     std::ostream* out = &std::cout;
     std::ofstream fileStream;
@@ -159,9 +654,19 @@ void Simulator::printStats(const std::string& outfile) {
         }
     }
     
+    // JSON and CSV are written straight from the counters, with a fixed set of fields
+    if (config.outputFormat != OutputFormat::Text) {
+        writeRunStats(*out, getRunStats(), config.outputFormat);
+        return;
+    }
+    
     // Print simulation parameters
     *out << "Simulation Parameters:" << std::endl;
     *out << "Trace Prefix: " << traceBaseName << std::endl;
+    if (numCores != 4) {
+        // The quad-core default keeps the reference output (test_cases/output) unchanged
+        *out << "Number of Cores: " << numCores << std::endl;
+    }
     *out << "Set Index Bits: " << indexBits << std::endl;
     *out << "Associativity: " << associativity << std::endl;
     *out << "Block Bits: " << blockOffsetBits << std::endl;
@@ -171,62 +676,166 @@ void Simulator::printStats(const std::string& outfile) {
     *out << "MESI Protocol: Enabled" << std::endl;
     *out << "Write Policy: Write-back, Write-allocate" << std::endl;
     *out << "Replacement Policy: LRU (invalid lines replaced first)" << std::endl;
-    *out << "Bus Arbitration: Fixed Priority (Core 0 highest, Core 3 lowest) with Transaction Priority (BusRdX > BusRd > WriteBack)" << std::endl;
-    *out << "Memory Latency: 100 cycles" << std::endl;
+    interconnect->printParameters(*out);
+    if (memoryController) {
+        memoryController->printParameters(*out);
+    }
+    if (config.threads > 0) {
+        *out << "Parallel Engine: " << config.threads << " threads, quantum " << config.quantum << " cycles ("
+             << (config.quantum <= 1 ? "strict" : "relaxed") << ")" << std::endl;
+    }
+    if (config.sampling.interval > 0) {
+        *out << "Sampled Simulation: interval " << config.sampling.interval << ", warm-up "
+             << config.sampling.warmup << ", window " << config.sampling.window
+             << " records per core (cycle counts are estimates)" << std::endl;
+    }
+    if (config.setSampleBits > 0) {
+        *out << "Set Sampling: 1 in " << (1 << config.setSampleBits) << " sets ("
+             << (numSets >> config.setSampleBits) << " of " << numSets
+             << " simulated; counts scaled to the full traces)" << std::endl;
+    }
+    if (!config.restoreFile.empty()) {
+        *out << "Restored From: " << config.restoreFile << " (cycle " << restoredCycle << ")" << std::endl;
+    }
+    if (!config.checkpointFile.empty()) {
+        *out << "Checkpoint: cycle " << config.checkpointCycle << " -> " << config.checkpointFile
+             << (checkpointSaved ? "" : " (not reached)") << std::endl;
+    }
+    if (busLog && !busLog->getFileName().empty()) {
+        *out << "Bus Log: " << busLog->getFileName() << " (" << busLog->getRecords() << " transactions)" << std::endl;
+    }
+    if (intervalSampler) {
+        *out << "Interval Statistics: " << intervalSampler->getFileName() << " (" << intervalSampler->getIntervals()
+             << " intervals)" << std::endl;
+    }
+    if (timeline) {
+        *out << "Timeline: " << timeline->getFileName() << " (" << timeline->getEvents() << " events)" << std::endl;
+    }
+    if (config.maxCycles > 0) {
+        *out << "Cycle Limit: " << config.maxCycles;
+        if (truncated) {
+            *out << " (reached, " << (numCores - finishedCores) << " of " << numCores << " cores unfinished)";
+        }
+        *out << std::endl;
+    }
     *out << std::endl;
     
+    // The counts, scaled for set sampling and sampled simulation (see getRunStats)
+    RunStatsRecord stats = getRunStats();
+    
     // Print per-core statistics
     for (int i = 0; i < numCores; i++) {
-        const Core& core = cores[i];
+        const CoreStatsRecord& record = stats.cores[i];
         const Cache& cache = caches[i];
+        double scale = getSetSampleScale(i);
         
         *out << "Core " << i << " Statistics:" << std::endl;
-        *out << "Total Instructions: " << core.getInstructionCount() << std::endl;
-        *out << "Total Reads: " << core.getReadCount() << std::endl;
-        *out << "Total Writes: " << core.getWriteCount() << std::endl;
-        *out << "Total Execution Cycles: " << core.getTotalCycles() << std::endl;
-        *out << "Idle Cycles: " << core.getIdleCycles() << std::endl;
-        *out << "Cache Misses: " << cache.getMisses() << std::endl;
+        *out << "Total Instructions: " << record.instructions << std::endl;
+        *out << "Total Reads: " << record.reads << std::endl;
+        *out << "Total Writes: " << record.writes << std::endl;
+        *out << "Total Execution Cycles: " << record.executionCycles << std::endl;
+        *out << "Idle Cycles: " << record.idleCycles << std::endl;
+        if (config.stallBreakdown) {
+            printStallBreakdown(*out, record);
+        }
+        *out << "Cache Misses: " << record.misses << std::endl;
         *out << "Cache Miss Rate: " << std::fixed << std::setprecision(2) 
-             << (cache.getMissRate() * 100.0) << "%" << std::endl;
-        *out << "Cache Evictions: " << cache.getEvictions() << std::endl;
-        *out << "Writebacks: " << cache.getWritebacks() << std::endl;
-        *out << "Bus Invalidations: " << cache.getInvalidationsReceived() << std::endl;
-        *out << "Data Traffic (Bytes): " << bus.getTotalDataTrafficBytes() << std::endl;
+             << (record.missRate * 100.0) << "%" << std::endl;
+        if (config.setSampleBits > 0) {
+            // Spread between the groups of sampled sets
+            std::vector<double> misses, accesses;
+            for (int group = 0; group < std::min(setGroups, numSets >> config.setSampleBits); group++) {
+                misses.push_back(static_cast<double>(cache.getGroupMisses(group)));
+                accesses.push_back(static_cast<double>(cache.getGroupAccesses(group)));
+            }
+            double missRate, halfWidth;
+            estimateRatio(misses, accesses, missRate, halfWidth);
+            *out << "Cache Miss Rate 95% CI: +/- " << std::fixed << std::setprecision(2) << (halfWidth * 100.0)
+                 << "%" << std::endl;
+        }
+        if (config.classifyMisses) {
+            *out << "Miss Classification: ";
+            for (int type = 0; type < static_cast<int>(MissType::Count); type++) {
+                *out << (type > 0 ? ", " : "") << getMissTypeName(static_cast<MissType>(type)) << ": "
+                     << static_cast<uint64_t>(missClassifiers[i].getCount(static_cast<MissType>(type)) * scale + 0.5);
+            }
+            *out << std::endl;
+        }
+        *out << "Cache Evictions: " << record.evictions << std::endl;
+        *out << "Writebacks: " << record.writebacks << std::endl;
+        *out << "Bus Invalidations: " << record.invalidations << std::endl;
+        *out << "Data Traffic (Bytes): " << stats.busTrafficBytes << std::endl;
+        if (latencyStats) {
+            latencyStats->printCoreStats(*out, i);
+        }
         *out << std::endl;
     }
     
     // Print overall bus summary
     *out << "Overall Bus Summary:" << std::endl;
-    *out << "Total Bus Transactions: " << bus.getTotalBusTransactions() << std::endl;
-    *out << "Total Bus Traffic (Bytes): " << bus.getTotalDataTrafficBytes() << std::endl;
+    *out << "Total Bus Transactions: " << stats.busTransactions << std::endl;
+    *out << "Total Bus Traffic (Bytes): " << stats.busTrafficBytes << std::endl;
+    
+    // Interconnect-specific statistics (bus slices, network links)
+    // Sampled runs only time the detailed phases on the interconnect
+    interconnect->printStats(*out, config.sampling.interval > 0 ? detailedCycles : currentCycle);
+    if (memoryController) {
+        memoryController->printStats(*out);
+    }
+    if (config.interactionMatrix) {
+        printInteractionMatrix(*out);
+    }
+    if (latencyStats) {
+        latencyStats->printTypeStats(*out);
+    }
+    if (hotLineTracker) {
+        printHotLines(*out);
+    }
+    
+    // Host performance of the parallel engine (varies from run to run)
+    if (config.threads > 0) {
+        *out << std::endl << "Parallel Engine Summary:" << std::endl;
+        *out << "Simulation Wall Time (s): " << std::fixed << std::setprecision(3) << wallSeconds << std::endl;
+        *out << "Simulated Cycles per Second: " << std::fixed << std::setprecision(0)
+             << (wallSeconds > 0 ? currentCycle / wallSeconds : 0.0) << std::endl;
+    }
+    
+    if (config.sampling.interval > 0) {
+        printSamplingStats(*out);
+    }
     
     // If debug mode is enabled, print additional debug information 
-    // about high invalidation addresses for Core 2
+    // about the core receiving the most invalidations
     if (debugEnabled) {
         *out << std::endl << "===== DEBUG INFORMATION =====" << std::endl;
-        *out << "Core 2 has " << caches[2].getInvalidationsReceived() << " invalidations." << std::endl;
         
-        // If Core 2 has significantly more invalidations, it suggests possible false sharing
-        if (caches[2].getInvalidationsReceived() > 1000) {
-            *out << "High invalidation count detected for Core 2!" << std::endl;
-            *out << "This is likely due to false sharing between Core 2 and other cores." << std::endl;
-            *out << "Consider padding data structures to avoid false sharing." << std::endl;
-        }
-        
-        // Calculate average invalidations per core
+        int worstCore = 0;
         uint64_t totalInvalidations = 0;
         for (int i = 0; i < numCores; i++) {
             totalInvalidations += caches[i].getInvalidationsReceived();
+            if (caches[i].getInvalidationsReceived() > caches[worstCore].getInvalidationsReceived()) {
+                worstCore = i;
+            }
+        }
+        uint64_t worstInvalidations = caches[worstCore].getInvalidationsReceived();
+        *out << "Core " << worstCore << " has " << worstInvalidations << " invalidations." << std::endl;
+        
+        // If a core has significantly more invalidations, it suggests possible false sharing
+        if (worstInvalidations > 1000) {
+            *out << "High invalidation count detected for Core " << worstCore << "!" << std::endl;
+            *out << "This is likely due to false sharing between Core " << worstCore << " and other cores." << std::endl;
+            *out << "Consider padding data structures to avoid false sharing." << std::endl;
         }
+        
+        // Calculate average invalidations per core
         double avgInvalidations = totalInvalidations / static_cast<double>(numCores);
         
         *out << "Average invalidations per core: " << avgInvalidations << std::endl;
         
-        // If Core 2 has more than 3x the average, it's definitely anomalous
-        if (caches[2].getInvalidationsReceived() > 3 * avgInvalidations) {
-            *out << "Core 2 invalidations are " 
-                 << (caches[2].getInvalidationsReceived() / avgInvalidations) 
+        // If the core has more than 3x the average, it's definitely anomalous
+        if (avgInvalidations > 0 && worstInvalidations > 3 * avgInvalidations) {
+            *out << "Core " << worstCore << " invalidations are " 
+                 << (worstInvalidations / avgInvalidations) 
                  << " times the average!" << std::endl;
         }
         
@@ -239,6 +848,291 @@ void Simulator::printStats(const std::string& outfile) {
     }
 }
 
+RunStatsRecord Simulator::getRunStats() const {
+    RunStatsRecord stats;
+    stats.traceBase = traceBaseName;
+    stats.s = indexBits;
+    stats.E = associativity;
+    stats.b = blockOffsetBits;
+    stats.totalCycles = currentCycle;
+    
+    // With set sampling, every count is scaled by the core's full-to-sampled access ratio,
+    // and the bus totals by that of all cores together
+    double busScale = 1.0;
+    if (config.setSampleBits > 0) {
+        uint64_t fullAccesses = 0;
+        uint64_t sampledAccesses = 0;
+        for (int i = 0; i < numCores; i++) {
+            fullAccesses += fullTraceReads[i] + fullTraceWrites[i];
+            sampledAccesses += cores[i].getInstructionCount();
+        }
+        busScale = sampledAccesses > 0 ? static_cast<double>(fullAccesses) / sampledAccesses : 0.0;
+    }
+    stats.busTransactions = static_cast<uint64_t>(interconnect->getTotalBusTransactions() * busScale + 0.5);
+    stats.busTrafficBytes = static_cast<uint64_t>(interconnect->getTotalDataTrafficBytes() * busScale + 0.5);
+    
+    for (int i = 0; i < numCores; i++) {
+        const Core& core = cores[i];
+        const Cache& cache = caches[i];
+        double scale = getSetSampleScale(i);
+        
+        CoreStatsRecord record;
+        record.reads = config.setSampleBits > 0 ? fullTraceReads[i] : core.getReadCount();
+        record.writes = config.setSampleBits > 0 ? fullTraceWrites[i] : core.getWriteCount();
+        record.instructions = config.setSampleBits > 0 ? record.reads + record.writes : core.getInstructionCount();
+        record.executionCycles = static_cast<uint64_t>(core.getTotalCycles() * scale + 0.5);
+        record.idleCycles = static_cast<uint64_t>(scale *
+            (!estimatedIdleCycles.empty() ? estimatedIdleCycles[i] : core.getIdleCycles()) + 0.5);
+        
+        // Scaled like the idle cycles: by the set sampling ratio, and to the sampled estimate
+        double stallScale = scale;
+        if (!estimatedIdleCycles.empty() && core.getIdleCycles() > 0) {
+            stallScale *= static_cast<double>(estimatedIdleCycles[i]) / core.getIdleCycles();
+        }
+        for (int cause = 0; cause < static_cast<int>(StallCause::Count); cause++) {
+            record.stallCycles[cause] =
+                static_cast<uint64_t>(core.getStallCycles(static_cast<StallCause>(cause)) * stallScale + 0.5);
+        }
+        record.misses = static_cast<uint64_t>(cache.getMisses() * scale + 0.5);
+        record.missRate = cache.getMissRate();
+        record.evictions = static_cast<uint64_t>(cache.getEvictions() * scale + 0.5);
+        record.writebacks = static_cast<uint64_t>(cache.getWritebacks() * scale + 0.5);
+        record.invalidations = static_cast<uint64_t>(cache.getInvalidationsReceived() * scale + 0.5);
+        stats.cores.push_back(record);
+    }
+    return stats;
+}
+
+void Simulator::printStallBreakdown(std::ostream& out, const CoreStatsRecord& record) const {
+    const int causes = static_cast<int>(StallCause::Count);
+    out << "Stall Cycles: ";
+    for (int cause = 0; cause < causes; cause++) {
+        out << (cause > 0 ? ", " : "") << getStallCauseName(static_cast<StallCause>(cause)) << ": "
+            << record.stallCycles[cause];
+    }
+    out << std::endl;
+    
+    // A running core executes one instruction per cycle, so the base CPI is 1
+    uint64_t instructions = record.reads + record.writes;
+    double perInstruction = instructions > 0 ? 1.0 / instructions : 0.0;
+    double total = instructions > 0 ? 1.0 : 0.0;
+    out << "CPI Stack: Base: " << std::fixed << std::setprecision(3) << total;
+    for (int cause = 0; cause < causes; cause++) {
+        out << ", " << getStallCauseName(static_cast<StallCause>(cause)) << ": "
+            << record.stallCycles[cause] * perInstruction;
+        total += record.stallCycles[cause] * perInstruction;
+    }
+    out << ", Total: " << total << std::endl;
+}
+
+void Simulator::printInteractionMatrix(std::ostream& out) const {
+    // One row per requesting core; a column is counted at, and scaled like, the snooped cache
+    out << std::endl << "Core Interaction Matrix:" << std::endl;
+    for (int requester = 0; requester < numCores; requester++) {
+        out << "Invalidations Caused by Core " << requester << ":";
+        for (int core = 0, column = 0; core < numCores; core++) {
+            if (core != requester) {
+                out << (column++ > 0 ? ", " : " ") << "Core " << core << ": "
+                    << static_cast<uint64_t>(caches[core].getInvalidationsFrom(requester) * getSetSampleScale(core) + 0.5);
+            }
+        }
+        out << std::endl;
+    }
+    for (int requester = 0; requester < numCores; requester++) {
+        out << "Cache-to-Cache Supplies to Core " << requester << ":";
+        for (int core = 0, column = 0; core < numCores; core++) {
+            if (core != requester) {
+                out << (column++ > 0 ? ", " : " ") << "Core " << core << ": "
+                    << static_cast<uint64_t>(caches[core].getSuppliesTo(requester) * getSetSampleScale(core) + 0.5);
+            }
+        }
+        out << std::endl;
+    }
+}
+
+void Simulator::printHotLines(std::ostream& out) const {
+    out << std::endl << "Hot Lines:" << std::endl;
+    out << "Tracked Lines: " << hotLineTracker->getCapacity() << std::endl;
+    
+    // Set sampling packs the sampled sets together; report the lines at their trace addresses
+    int sampledIndexBits = indexBits - config.setSampleBits;
+    int rank = 1;
+    for (const HotLineTracker::HotLine& line : hotLineTracker->getHottest(config.hotLines)) {
+        address_t block = line.block;
+        if (config.setSampleBits > 0) {
+            address_t set = block & ((static_cast<address_t>(1) << sampledIndexBits) - 1);
+            block = ((block >> sampledIndexBits) << indexBits) | (set << config.setSampleBits);
+        }
+        out << "Line " << rank++ << ": Address: 0x" << std::hex << (static_cast<uint64_t>(block) << blockOffsetBits)
+            << std::dec;
+        for (int event = 0; event < static_cast<int>(HotLineEvent::Count); event++) {
+            static const char* const names[] = {"Invalidations", "Misses", "Cache-to-Cache"};
+            out << ", " << names[event] << ": " << line.events[event];
+        }
+        out << ", Overcount: " << line.overcount << ", Word Masks:";
+        for (int core = 0; core < numCores; core++) {
+            uint64_t mask = hotLineTracker->getWordMask(line.block, core);
+            if (mask != 0) {
+                out << " 0x" << std::hex << mask << std::dec;
+            } else {
+                out << " -";
+            }
+        }
+        out << ", False Sharing Candidate: " << (hotLineTracker->isFalseSharingCandidate(line) ? "yes" : "no")
+            << std::endl;
+    }
+}
+
+void Simulator::printSamplingStats(std::ostream& out) const {
+    uint64_t totalRecords = 0;
+    for (const Core& core : cores) {
+        totalRecords += core.getInstructionCount();
+    }
+    
+    out << std::endl << "Sampled Simulation Summary:" << std::endl;
+    out << "Measured Windows: " << sampleWindows.size() << std::endl;
+    out << "Detailed Records: " << detailedRecords << " (" << std::fixed << std::setprecision(2)
+        << (totalRecords > 0 ? 100.0 * detailedRecords / totalRecords : 0.0) << "% of " << totalRecords << ")" << std::endl;
+    out << "Detailed Cycles Simulated: " << detailedCycles << std::endl;
+    
+    // Program length: the slowest core's estimate, with that core's interval
+    int slowest = 0;
+    double slowestCycles = -1.0;
+    for (int i = 0; i < numCores; i++) {
+        double cycles = estimateCore(i).cpi * cores[i].getInstructionCount();
+        if (cycles > slowestCycles) {
+            slowestCycles = cycles;
+            slowest = i;
+        }
+    }
+    SampleEstimate slowestEstimate = estimateCore(slowest);
+    out << "Estimated Simulation Cycles: " << estimatedCycles << " +/- " << std::fixed << std::setprecision(0)
+        << slowestEstimate.cpiHalfWidth * cores[slowest].getInstructionCount() << " (95% CI, Core " << slowest << ")"
+        << std::endl;
+    
+    for (int i = 0; i < numCores; i++) {
+        SampleEstimate estimate = estimateCore(i);
+        out << "Core " << i << " Estimated CPI: " << std::fixed << std::setprecision(4) << estimate.cpi
+            << " +/- " << estimate.cpiHalfWidth << " (" << estimate.windows << " windows)" << std::endl;
+        out << "Core " << i << " Estimated Miss Rate: " << std::fixed << std::setprecision(2)
+            << estimate.missRate * 100.0 << "% +/- " << estimate.missRateHalfWidth * 100.0 << "%" << std::endl;
+    }
+    out << "Simulation Wall Time (s): " << std::fixed << std::setprecision(3) << wallSeconds << std::endl;
+}
+
+double Simulator::getSetSampleScale(int core) const {
+    if (config.setSampleBits == 0) {
+        return 1.0;
+    }
+    uint64_t sampled = cores[core].getInstructionCount();
+    uint64_t full = fullTraceReads[core] + fullTraceWrites[core];
+    return sampled > 0 ? static_cast<double>(full) / sampled : static_cast<double>(1 << config.setSampleBits);
+}
+
+// Checkpoint file layout: magic and version, the organization the state depends on (checked
+// on restore), then the simulator, core, cache, interconnect and DRAM state in that order
+static const uint64_t checkpointMagic = 0x504b434d4953314cULL; // "L1SIMCKP" on a little-endian host
+static const uint32_t checkpointVersion = 6;
+
+void Simulator::checkpointIfDue() {
+    if (!config.checkpointFile.empty() && !checkpointSaved && currentCycle == config.checkpointCycle) {
+        saveCheckpoint(config.checkpointFile);
+        checkpointSaved = true;
+    }
+}
+
+void Simulator::saveCheckpoint(const std::string& file) {
+    std::ofstream stream(file, std::ios::binary | std::ios::trunc);
+    if (!stream.is_open()) {
+        throw std::runtime_error("cannot write checkpoint file: " + file);
+    }
+    CheckpointWriter writer(stream);
+    
+    writer.write(checkpointMagic);
+    writer.write(checkpointVersion);
+    writer.write(numCores);
+    writer.write(indexBits);
+    writer.write(associativity);
+    writer.write(blockOffsetBits);
+    writer.write(config.setSampleBits);
+    writer.write(config.interconnect);
+    writer.write(config.busSlices);
+    writer.write(config.sliceHash);
+    writer.write(config.network.topology);
+    writer.write(config.network.meshWidth);
+    writer.write(config.network.memoryControllers);
+    writer.write(config.dramModel);
+    writer.write(config.dram.channels);
+    writer.write(config.dram.ranks);
+    writer.write(config.dram.banksPerRank);
+    writer.write(config.dram.rowSizeBytes);
+    
+    writer.write(currentCycle);
+    writer.write(finishedCores);
+    for (Core& core : cores) {
+        core.saveState(writer);
+    }
+    for (const Cache& cache : caches) {
+        cache.saveState(writer);
+    }
+    interconnect->saveState(writer);
+    if (memoryController) {
+        memoryController->saveState(writer);
+    }
+    
+    stream.flush();
+    if (!writer.good()) {
+        throw std::runtime_error("error writing checkpoint file: " + file);
+    }
+    TRACE(CheckpointSaved, currentCycle, file);
+}
+
+void Simulator::loadCheckpoint(const std::string& file) {
+    std::ifstream stream(file, std::ios::binary);
+    if (!stream.is_open()) {
+        throw std::runtime_error("cannot open checkpoint file: " + file);
+    }
+    CheckpointReader reader(stream);
+    
+    uint64_t magic = 0;
+    if (!stream.read(reinterpret_cast<char*>(&magic), sizeof(magic)) || magic != checkpointMagic) {
+        throw std::runtime_error(file + " is not a simulator checkpoint");
+    }
+    reader.expect(checkpointVersion, "checkpoint version");
+    reader.expect(numCores, "number of cores");
+    reader.expect(indexBits, "set index bits (s)");
+    reader.expect(associativity, "associativity (E)");
+    reader.expect(blockOffsetBits, "block bits (b)");
+    reader.expect(config.setSampleBits, "set sampling ratio");
+    reader.expect(config.interconnect, "interconnect");
+    reader.expect(config.busSlices, "number of bus slices");
+    reader.expect(config.sliceHash, "slice hash");
+    reader.expect(config.network.topology, "network topology");
+    reader.expect(config.network.meshWidth, "mesh width");
+    reader.expect(config.network.memoryControllers, "number of memory controllers");
+    reader.expect(config.dramModel, "memory model");
+    reader.expect(config.dram.channels, "DRAM organization");
+    reader.expect(config.dram.ranks, "DRAM organization");
+    reader.expect(config.dram.banksPerRank, "DRAM organization");
+    reader.expect(config.dram.rowSizeBytes, "DRAM row size");
+    
+    reader.read(currentCycle);
+    reader.read(finishedCores);
+    for (Core& core : cores) {
+        core.loadState(reader);
+    }
+    for (Cache& cache : caches) {
+        cache.loadState(reader);
+    }
+    interconnect->loadState(reader);
+    if (memoryController) {
+        memoryController->loadState(reader);
+    }
+    restoredCycle = currentCycle;
+    
+    TRACE(CheckpointRestored, file, currentCycle);
+}
+
 // Debug control methods
 void Simulator::setDebugEnabled(bool enabled) {
     debugEnabled = enabled;
@@ -273,6 +1167,22 @@ int Simulator::getCacheSize() const {
     return cacheSize;
 }
 
+int Simulator::getNumCores() const {
+    return numCores;
+}
+
+const Core& Simulator::getCore(int core) const {
+    return cores[core];
+}
+
+const Cache& Simulator::getCache(int core) const {
+    return caches[core];
+}
+
+const Interconnect& Simulator::getInterconnect() const {
+    return *interconnect;
+}
+
 cycle_t Simulator::getCurrentCycle() const {
     return currentCycle;
 } 
@@ -7,6 +7,72 @@
 #include "Core.h"
 #include "Cache.h"
 #include "Bus.h"
+#include "Network.h"
+#include "MemoryController.h"
+#include "BusLog.h"
+#include "Timeline.h"
+#include "IntervalStats.h"
+#include "StatsFormat.h"
+#include "LatencyHistogram.h"
+#include "MissClassifier.h"
+#include "HotLineTracker.h"
+#include <memory>
+
+// Coherence fabric connecting the caches
+enum class InterconnectType {
+    Bus,     // Snooping shared bus (optionally sliced)
+    Network  // Ring or mesh network-on-chip
+};
+
+// Sampled simulation (SMARTS). The run is split into sampling units of interval records of
+// the leading core: most of a unit is fast-forwarded functionally (caches and coherence state
+// stay warm, no timing; the other cores advance in proportion to their measured progress),
+// then warmup records run on the detailed model to settle the bus and memory state, then
+// window records are measured. Cycle counts are estimated from the windows' CPI, with
+// confidence intervals from their spread.
+struct SamplingParameters {
+    uint64_t interval = 0;  // Records per sampling unit, counted on the leading core (0 = off)
+    uint64_t warmup = 0;    // Detailed, unmeasured records before each window
+    uint64_t window = 0;    // Measured detailed records per unit
+};
+
+// Optional model extensions. The defaults reproduce the classic single shared bus.
+struct SimulatorConfig {
+    int numCores = 0;                                        // Cores to simulate (0 = one per _procN.trace file found)
+    std::vector<std::shared_ptr<const DecodedTrace>> traces; // Pre-decoded per-core traces (empty = read the trace files)
+    int threads = 0;                                         // Parallel engine worker threads (0 = serial loop)
+    int quantum = 1;                                         // Cycles cores run between interconnect syncs (1 = bit-exact)
+    InterconnectType interconnect = InterconnectType::Bus;
+    int busSlices = 1;                                       // Number of address-interleaved bus slices
+    SliceHashFunction sliceHash = SliceHashFunction::Modulo; // Block address to slice mapping
+    bool coalesceReads = false;                              // Merge BusRd requests for a block already being read
+    FillPolicy memoryFillPolicy = FillPolicy::Full;          // Miss restart for blocks supplied by memory
+    FillPolicy cacheFillPolicy = FillPolicy::Full;           // Miss restart for cache-to-cache transfers
+    NetworkParameters network;                               // Topology used when interconnect is Network
+    bool dramModel = false;                                  // Banked DRAM instead of fixed memory latency
+    DramParameters dram;                                     // DRAM organization, timing and scheduling
+    cycle_t maxCycles = 0;                                   // Stop the simulation at this cycle (0 = no limit)
+    SamplingParameters sampling;                             // Sampled simulation (serial engine only)
+    int setSampleBits = 0;                                   // Simulate one set in every 2^setSampleBits (0 = all)
+    std::string checkpointFile;                              // Save the full state here (empty = never)
+    cycle_t checkpointCycle = 0;                             // Cycle at which the checkpoint is saved
+    std::string restoreFile;                                 // Resume from this checkpoint (empty = start at cycle 0)
+    std::string busLogFile;                                  // Log every bus transaction here (empty = off)
+    std::string timelineFile;                                // Chrome trace-event timeline (empty = off, serial engine only)
+    cycle_t timelineStart = 0;                               // Timeline window [start, end) (end 0 = no end)
+    cycle_t timelineEnd = 0;
+    cycle_t timelinePeriod = 0;                              // Record timelineLength cycles of every period (0 = all)
+    cycle_t timelineLength = 0;
+    OutputFormat outputFormat = OutputFormat::Text;          // Statistics report format (see StatsFormat.h)
+    std::string intervalFile;                                // Per-interval CSV time series (empty = off, serial engine only)
+    cycle_t intervalCycles = 0;                              // Interval length in cycles, or
+    uint64_t intervalInstructions = 0;                       // in instructions over all cores
+    bool latencyHistograms = false;                          // Report latency percentiles per core and request type
+    bool stallBreakdown = false;                             // Report idle cycles per core by stall cause
+    bool classifyMisses = false;                             // Report misses per core by kind (3C plus sharing)
+    int hotLines = 0;                                        // Report the n lines with the most coherence events (0 = off)
+    bool interactionMatrix = false;                          // Report invalidations and supplies per pair of cores
+};
 
 // Simulator class to manage the overall simulation
 class Simulator {
@@ -15,19 +81,67 @@ private:
     cycle_t currentCycle;
     
     // Components
-    Bus bus;
+    std::unique_ptr<BusLogWriter> busLog;
+    std::unique_ptr<Timeline> timeline;
+    std::unique_ptr<IntervalSampler> intervalSampler;
+    std::unique_ptr<LatencyStats> latencyStats;
+    std::unique_ptr<SharingTracker> sharingTracker;       // Miss classification (see MissClassifier)
+    std::vector<MissClassifier> missClassifiers;
+    std::unique_ptr<HotLineTracker> hotLineTracker;       // Shared by all caches (see HotLineTracker)
+    std::unique_ptr<MemoryController> memoryController;
+    std::unique_ptr<Interconnect> interconnect;
     std::vector<Core> cores;
     std::vector<Cache> caches;
     
     // Configuration
     std::string traceBaseName;
     int numCores;
+    int finishedCores;    // Cores that have run out of trace entries
     int indexBits;        // s
     int associativity;    // E
     int blockOffsetBits;  // b
     int blockSize;        // B = 2^b
     int numSets;          // S = 2^s
     int cacheSize;        // Size in bytes = S * E * B
+    SimulatorConfig config;
+    
+    // Set sampling: the caches hold only the sampled sets and the cores replay only the
+    // accesses to them; counts are scaled back by each core's full-to-sampled access ratio
+    static const int setGroups = 8;          // Sampled sets are split into groups for error bars
+    std::vector<uint64_t> fullTraceReads;    // Per core, before set sampling
+    std::vector<uint64_t> fullTraceWrites;
+    double getSetSampleScale(int core) const; // 1 without set sampling
+    
+    static const int hotLineTrackingFactor = 64; // Lines tracked per hot line reported
+    
+    double wallSeconds;   // Host time spent in the simulation loop
+    bool truncated;       // Stopped at config.maxCycles before every core finished
+    
+    // Checkpointing: the complete simulation state (cycle, cores with their trace positions,
+    // caches, interconnect queues and DRAM) at the start of a cycle, in a binary file.
+    // Restoring needs the same traces and cache/interconnect organization; the policies
+    // and timing of the interconnect and DRAM may differ, so one warm state can be
+    // resumed under several variants.
+    bool checkpointSaved;
+    cycle_t restoredCycle;
+    void saveCheckpoint(const std::string& file);
+    void loadCheckpoint(const std::string& file);
+    void checkpointIfDue();
+    
+    // Sampled simulation: what every measured window saw, per core
+    struct SampleWindow {
+        cycle_t cycles;
+        std::vector<uint64_t> instructions;
+        std::vector<uint64_t> idleCycles;
+        std::vector<uint64_t> accesses;
+        std::vector<uint64_t> misses;
+    };
+    std::vector<SampleWindow> sampleWindows;
+    uint64_t detailedRecords;  // Records executed on the detailed model (all cores)
+    cycle_t detailedCycles;    // Cycles simulated in detail (warm-up, windows and drains)
+    std::vector<double> progressRates; // Records per record of the leading core, last window
+    cycle_t estimatedCycles;   // Estimated length of the full detailed simulation
+    std::vector<cycle_t> estimatedIdleCycles; // Per core
     
     // Debug flag
     static bool debugEnabled;
@@ -36,16 +150,51 @@ private:
     void initialize();
     void tick();
     bool checkFinished();
+    
+    // Parallel engine: cores advance a quantum at a time on worker threads,
+    // the interconnect then catches up serially
+    void runParallel(cycle_t maxCycles);
+    
+    // Sampled simulation (see SamplingParameters) and its phases
+    void runSampled(cycle_t maxCycles);
+    void fastForward(uint64_t records);
+    void runDetailed(uint64_t records, cycle_t maxCycles);
+    void drain(cycle_t maxCycles);
+    
+    // Estimates from the sample windows: per-core CPI, idle cycles per instruction and miss
+    // rate with 95% confidence half-widths (0 with fewer than 2 windows)
+    struct SampleEstimate {
+        double cpi, cpiHalfWidth;
+        double idlePerInstruction;
+        double missRate, missRateHalfWidth;
+        size_t windows;   // Windows in which the core executed
+    };
+    SampleEstimate estimateCore(int core) const;
+    void applyEstimates();
+    void printSamplingStats(std::ostream& out) const;
+    
+    // Idle cycles of a core by stall cause, and as a CPI stack (cycles per instruction)
+    void printStallBreakdown(std::ostream& out, const CoreStatsRecord& record) const;
+    
+    // The hottest lines, with their event counts and false sharing candidates
+    void printHotLines(std::ostream& out) const;
+    
+    // Per pair of cores: lines one core's requests invalidated in, and were supplied by, the other's cache
+    void printInteractionMatrix(std::ostream& out) const;
 
 public:
-    Simulator(const std::string& traceBase, int s, int E, int b);
+    Simulator(const std::string& traceBase, int s, int E, int b,
+              const SimulatorConfig& config = SimulatorConfig());
     
     // Run the simulation
     void run();
     
-    // Print statistics
+    // Print statistics (the text report, or the run's statistics as JSON/CSV)
     void printStats(const std::string& outfile = "");
     
+    // The per-core and interconnect counts of the report, scaled like the text report
+    RunStatsRecord getRunStats() const;
+    
     // Get simulation parameters
     int getIndexBits() const;
     int getAssociativity() const;
@@ -57,12 +206,23 @@ public:
     // Get number of cycles executed
     cycle_t getCurrentCycle() const;
     
+    // Number of simulated cores
+    int getNumCores() const;
+    
+    // Simulated components, for collecting statistics after run()
+    const Core& getCore(int core) const;
+    const Cache& getCache(int core) const;
+    const Interconnect& getInterconnect() const;
+    
+    // Build the coherence fabric a configuration describes (b = block bits)
+    static Interconnect* createInterconnect(const SimulatorConfig& config, int b, int numCores);
+    
+    // Count the consecutive <traceBase>_procN.trace files present, starting at N = 0
+    static int detectCoreCount(const std::string& traceBase);
+    
     // Debug control
     static void setDebugEnabled(bool enabled);
     static bool isDebugEnabled();
 };
 
-// Macro for debug output
-#define DEBUG_PRINT(x) if (Simulator::isDebugEnabled()) { std::cout << "DEBUG: " << x << std::endl; }
-
 #endif // SIMULATOR_H 
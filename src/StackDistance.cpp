@@ -0,0 +1,158 @@
+#include "StackDistance.h"
+#include <unordered_map>
+#include <iomanip>
+#include <algorithm>
+
+StackDistanceProfiler::StackDistanceProfiler(int blockBits, int setBits, int maxAssociativity) :
+    blockBits(blockBits),
+    setBits(setBits),
+    maxAssociativity(maxAssociativity),
+    accesses(0),
+    coldMisses(0),
+    wayCounts(maxAssociativity, 0) {
+}
+
+void StackDistanceProfiler::profile(const DecodedTrace& trace) {
+    const address_t invalidBlock = ~static_cast<address_t>(0);
+    size_t numSets = static_cast<size_t>(1) << setBits;
+    address_t setMask = static_cast<address_t>(numSets - 1);
+
+    // Fenwick tree over reference times 1..n; time t is marked while it is the latest
+    // reference of its block, so the marks in (p, t) count the distinct blocks in between
+    std::vector<uint32_t> tree(trace.size() + 1, 0);
+    std::unordered_map<address_t, uint32_t> lastReference;
+    lastReference.reserve(trace.size() / 4);
+
+    // Per-set LRU stacks, most recent first, truncated at maxAssociativity
+    std::vector<address_t> stacks(numSets * maxAssociativity, invalidBlock);
+
+    for (size_t i = 0; i < trace.size(); i++) {
+        address_t block = trace[i].addr >> blockBits;
+        uint32_t time = static_cast<uint32_t>(i + 1);
+        accesses++;
+
+        // Fully associative distance
+        std::pair<std::unordered_map<address_t, uint32_t>::iterator, bool> entry =
+            lastReference.insert(std::make_pair(block, time));
+        if (entry.second) {
+            coldMisses++;
+        } else {
+            uint32_t previous = entry.first->second;
+            uint64_t marked = 0;
+            for (uint32_t t = time - 1; t > 0; t -= t & (~t + 1)) {
+                marked += tree[t];
+            }
+            for (uint32_t t = previous; t > 0; t -= t & (~t + 1)) {
+                marked -= tree[t];
+            }
+            for (uint32_t t = previous; t < tree.size(); t += t & (~t + 1)) {
+                tree[t]--;
+            }
+            entry.first->second = time;
+
+            if (marked >= distanceCounts.size()) {
+                distanceCounts.resize(std::max<size_t>(marked + 1, distanceCounts.size() * 2), 0);
+            }
+            distanceCounts[marked]++;
+        }
+        for (uint32_t t = time; t < tree.size(); t += t & (~t + 1)) {
+            tree[t]++;
+        }
+
+        // Set-associative distance: position in the set's LRU stack
+        address_t* stack = &stacks[(block & setMask) * maxAssociativity];
+        int depth = 0;
+        while (depth < maxAssociativity && stack[depth] != block) {
+            depth++;
+        }
+        if (depth < maxAssociativity) {
+            wayCounts[depth]++;
+        } else {
+            depth = maxAssociativity - 1;   // Miss: the LRU block falls off the stack
+        }
+        for (; depth > 0; depth--) {
+            stack[depth] = stack[depth - 1];
+        }
+        stack[0] = block;
+    }
+}
+
+uint64_t StackDistanceProfiler::getFullyAssociativeMisses(uint64_t lines) const {
+    uint64_t misses = coldMisses;
+    for (size_t distance = static_cast<size_t>(std::min<uint64_t>(lines, distanceCounts.size()));
+         distance < distanceCounts.size(); distance++) {
+        misses += distanceCounts[distance];
+    }
+    return misses;
+}
+
+uint64_t StackDistanceProfiler::getSetAssociativeMisses(int associativity) const {
+    uint64_t hits = 0;
+    for (int depth = 0; depth < associativity && depth < maxAssociativity; depth++) {
+        hits += wayCounts[depth];
+    }
+    return accesses - hits;
+}
+
+uint64_t StackDistanceProfiler::getAccesses() const {
+    return accesses;
+}
+
+uint64_t StackDistanceProfiler::getColdMisses() const {
+    return coldMisses;
+}
+
+void StackDistanceProfiler::writeCsvRows(std::ostream& out, int core) const {
+    uint64_t blockSize = 1ULL << blockBits;
+
+    // Walk the capacities upwards: misses(C) = cold + references with distance >= C.
+    // Rows only where the curve steps (and always for one line); misses(0 lines) = accesses
+    uint64_t misses = accesses;
+    size_t distances = std::max<size_t>(1, distanceCounts.size());
+    for (size_t distance = 0; distance < distances; distance++) {
+        uint64_t count = distance < distanceCounts.size() ? distanceCounts[distance] : 0;
+        uint64_t lines = distance + 1;
+        misses -= count;
+        if (distance == 0 || count > 0) {
+            out << core << ",fully-associative,1," << lines << "," << lines << "," << lines * blockSize << ","
+                << accesses << "," << misses << ","
+                << std::fixed << std::setprecision(6)
+                << (accesses > 0 ? static_cast<double>(misses) / accesses : 0.0) << std::endl;
+        }
+    }
+
+    uint64_t numSets = 1ULL << setBits;
+    for (int ways = 1; ways <= maxAssociativity; ways++) {
+        uint64_t setMisses = getSetAssociativeMisses(ways);
+        out << core << ",set-associative," << numSets << "," << ways << "," << numSets * ways << ","
+            << numSets * ways * blockSize << "," << accesses << "," << setMisses << ","
+            << std::fixed << std::setprecision(6)
+            << (accesses > 0 ? static_cast<double>(setMisses) / accesses : 0.0) << std::endl;
+    }
+}
+
+void StackDistanceProfiler::writeJson(std::ostream& out, int core) const {
+    out << "    {\"core\": " << core << ", \"accesses\": " << accesses
+        << ", \"cold_misses\": " << coldMisses << "," << std::endl;
+
+    // [lines, misses] at every capacity where the fully-associative curve steps
+    out << "     \"fully_associative\": [";
+    uint64_t misses = accesses;
+    size_t distances = std::max<size_t>(1, distanceCounts.size());
+    bool first = true;
+    for (size_t distance = 0; distance < distances; distance++) {
+        uint64_t count = distance < distanceCounts.size() ? distanceCounts[distance] : 0;
+        misses -= count;
+        if (distance == 0 || count > 0) {
+            out << (first ? "" : ", ") << "[" << distance + 1 << ", " << misses << "]";
+            first = false;
+        }
+    }
+    out << "]," << std::endl;
+
+    out << "     \"set_associative\": {\"sets\": " << (1ULL << setBits) << ", \"misses_by_ways\": [";
+    for (int ways = 1; ways <= maxAssociativity; ways++) {
+        out << (ways > 1 ? ", " : "") << getSetAssociativeMisses(ways);
+    }
+    out << "]}}";
+}
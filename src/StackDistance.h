@@ -0,0 +1,50 @@
+#ifndef STACKDISTANCE_H
+#define STACKDISTANCE_H
+
+#include <vector>
+#include <string>
+#include <ostream>
+#include "Types.h"
+#include "TraceReader.h"
+
+// Exact LRU stack-distance (Mattson) profile of one core's trace.
+// A block's stack distance is the number of distinct blocks referenced since its previous
+// reference; an LRU cache of C lines hits exactly the references with distance < C, so
+// one pass gives the miss-ratio curve of every cache size at once.
+//  - Fully associative: distances are counted with a Fenwick tree over reference times in
+//    which only the latest reference of every block is marked, O(log n) per reference.
+//  - Set associative (2^s sets): each set keeps its LRU stack up to the largest
+//    associativity of interest, so a reference costs at most maxAssociativity compares.
+class StackDistanceProfiler {
+private:
+    int blockBits;          // log2 of the block size
+    int setBits;            // Set count of the set-associative curves (2^setBits)
+    int maxAssociativity;   // Set-associative curves cover 1..maxAssociativity ways
+
+    uint64_t accesses;
+    uint64_t coldMisses;                    // First references (infinite distance)
+    std::vector<uint64_t> distanceCounts;   // Fully associative: references per stack distance
+    std::vector<uint64_t> wayCounts;        // Set associative: references per in-set distance < maxAssociativity
+
+public:
+    StackDistanceProfiler(int blockBits, int setBits, int maxAssociativity);
+
+    // Profile a whole trace (the profiler keeps only the histograms)
+    void profile(const DecodedTrace& trace);
+
+    // Misses of a fully-associative LRU cache of the given number of lines
+    uint64_t getFullyAssociativeMisses(uint64_t lines) const;
+
+    // Misses of a 2^setBits-set LRU cache with the given associativity (1..maxAssociativity)
+    uint64_t getSetAssociativeMisses(int associativity) const;
+
+    uint64_t getAccesses() const;
+    uint64_t getColdMisses() const;     // Also the number of distinct blocks
+
+    // Write the curves: fully-associative rows at every capacity where the miss count
+    // changes, then one set-associative row per associativity
+    void writeCsvRows(std::ostream& out, int core) const;
+    void writeJson(std::ostream& out, int core) const;
+};
+
+#endif // STACKDISTANCE_H
@@ -0,0 +1,103 @@
+#include "StatsFormat.h"
+#include <iomanip>
+
+// Version of the JSON/CSV layout; raise it when a key or column changes
+static const int schemaVersion = 2;
+
+// Key suffix of each stall cause, in StallCause order
+static const char* const stallKeys[] = {
+    "arbitration", "writeback", "memory", "cache_to_cache", "upgrade", "fill"
+};
+static const int stallCauses = static_cast<int>(StallCause::Count);
+static_assert(sizeof(stallKeys) / sizeof(stallKeys[0]) == stallCauses, "one key per stall cause");
+
+bool parseOutputFormat(const std::string& name, OutputFormat& format) {
+    if (name == "text") {
+        format = OutputFormat::Text;
+    } else if (name == "json") {
+        format = OutputFormat::Json;
+    } else if (name == "csv") {
+        format = OutputFormat::Csv;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static void writeJsonString(std::ostream& out, const std::string& text) {
+    out << '"';
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out << '\\';
+        }
+        out << c;
+    }
+    out << '"';
+}
+
+static void writeJson(std::ostream& out, const RunStatsRecord& stats) {
+    uint64_t cacheSize = (1ULL << stats.s) * stats.E * (1ULL << stats.b);
+    out << "{" << std::endl;
+    out << "  \"schema_version\": " << schemaVersion << "," << std::endl;
+    out << "  \"trace\": ";
+    writeJsonString(out, stats.traceBase);
+    out << "," << std::endl;
+    out << "  \"num_cores\": " << stats.cores.size() << ", \"s\": " << stats.s << ", \"E\": " << stats.E
+        << ", \"b\": " << stats.b << ", \"cache_size_bytes\": " << cacheSize << "," << std::endl;
+    out << "  \"total_cycles\": " << stats.totalCycles << ", \"bus_transactions\": " << stats.busTransactions
+        << ", \"bus_traffic_bytes\": " << stats.busTrafficBytes << "," << std::endl;
+    out << "  \"cores\": [" << std::endl;
+
+    for (size_t i = 0; i < stats.cores.size(); i++) {
+        const CoreStatsRecord& core = stats.cores[i];
+        out << "    {\"core\": " << i
+            << ", \"instructions\": " << core.instructions
+            << ", \"reads\": " << core.reads
+            << ", \"writes\": " << core.writes
+            << ", \"execution_cycles\": " << core.executionCycles
+            << ", \"idle_cycles\": " << core.idleCycles;
+        for (int cause = 0; cause < stallCauses; cause++) {
+            out << ", \"stall_" << stallKeys[cause] << "\": " << core.stallCycles[cause];
+        }
+        out << ", \"misses\": " << core.misses
+            << ", \"miss_rate\": " << std::fixed << std::setprecision(6) << core.missRate
+            << ", \"evictions\": " << core.evictions
+            << ", \"writebacks\": " << core.writebacks
+            << ", \"invalidations\": " << core.invalidations << "}"
+            << (i + 1 < stats.cores.size() ? "," : "") << std::endl;
+    }
+
+    out << "  ]" << std::endl;
+    out << "}" << std::endl;
+}
+
+static void writeCsv(std::ostream& out, const RunStatsRecord& stats) {
+    out << "schema_version,num_cores,s,E,b,cache_size_bytes,total_cycles,bus_transactions,bus_traffic_bytes,"
+        << "core,instructions,reads,writes,execution_cycles,idle_cycles";
+    for (int cause = 0; cause < stallCauses; cause++) {
+        out << ",stall_" << stallKeys[cause];
+    }
+    out << ",misses,miss_rate,evictions,writebacks,invalidations" << std::endl;
+
+    uint64_t cacheSize = (1ULL << stats.s) * stats.E * (1ULL << stats.b);
+    for (size_t i = 0; i < stats.cores.size(); i++) {
+        const CoreStatsRecord& core = stats.cores[i];
+        out << schemaVersion << "," << stats.cores.size() << "," << stats.s << "," << stats.E << "," << stats.b << ","
+            << cacheSize << "," << stats.totalCycles << "," << stats.busTransactions << ","
+            << stats.busTrafficBytes << "," << i << "," << core.instructions << "," << core.reads << ","
+            << core.writes << "," << core.executionCycles << "," << core.idleCycles;
+        for (int cause = 0; cause < stallCauses; cause++) {
+            out << "," << core.stallCycles[cause];
+        }
+        out << "," << core.misses << "," << std::fixed << std::setprecision(6) << core.missRate << ","
+            << core.evictions << "," << core.writebacks << "," << core.invalidations << std::endl;
+    }
+}
+
+void writeRunStats(std::ostream& out, const RunStatsRecord& stats, OutputFormat format) {
+    if (format == OutputFormat::Json) {
+        writeJson(out, stats);
+    } else if (format == OutputFormat::Csv) {
+        writeCsv(out, stats);
+    }
+}
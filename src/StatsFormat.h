@@ -0,0 +1,53 @@
+#ifndef STATS_FORMAT_H
+#define STATS_FORMAT_H
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include "Types.h"
+
+// Output format of the statistics report
+enum class OutputFormat {
+    Text,   // The human-readable report
+    Json,
+    Csv
+};
+
+// Parse "text", "json" or "csv"; returns false for anything else
+bool parseOutputFormat(const std::string& name, OutputFormat& format);
+
+// Statistics of one core at the end of a run
+struct CoreStatsRecord {
+    uint64_t instructions;
+    uint64_t reads;
+    uint64_t writes;
+    uint64_t executionCycles;
+    uint64_t idleCycles;
+    uint64_t stallCycles[static_cast<int>(StallCause::Count)]; // Idle cycles by cause
+    uint64_t misses;
+    double missRate;
+    uint64_t evictions;
+    uint64_t writebacks;
+    uint64_t invalidations;
+};
+
+// Statistics of a simulation run, with the counts (and scaling) of the text report
+struct RunStatsRecord {
+    std::string traceBase;
+    int s;
+    int E;
+    int b;
+    cycle_t totalCycles;
+    uint64_t busTransactions;
+    uint64_t busTrafficBytes;
+    std::vector<CoreStatsRecord> cores;
+};
+
+// Machine-readable form of a run's statistics. The keys and columns are fixed: they depend
+// neither on the options enabled nor on the number of cores, and every value is a number
+// (apart from the trace name). JSON is one object with schema_version first and a cores array;
+// CSV is a header row and one row per core, with the run's fields repeated on every row,
+// so runs can be appended to one table.
+void writeRunStats(std::ostream& out, const RunStatsRecord& stats, OutputFormat format);
+
+#endif // STATS_FORMAT_H
@@ -0,0 +1,196 @@
+#include "Sweep.h"
+#include <iostream>
+#include <iomanip>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <stdexcept>
+
+SweepRunner::SweepRunner(const std::string& traceBase, const SimulatorConfig& baseConfig, int jobs) :
+    traceBase(traceBase),
+    baseConfig(baseConfig),
+    jobs(jobs < 1 ? 1 : jobs) {
+}
+
+uint64_t SweepRunner::loadTraces() {
+    int numCores = baseConfig.numCores > 0 ? baseConfig.numCores : Simulator::detectCoreCount(traceBase);
+    if (numCores == 0) {
+        throw std::runtime_error("no trace files found (expected " + traceBase + "_proc0.trace)");
+    }
+
+    traces = TraceReader::decodeTraces(traceBase, numCores, jobs);
+
+    uint64_t records = 0;
+    for (const std::shared_ptr<const DecodedTrace>& trace : traces) {
+        records += trace->size();
+    }
+    return records;
+}
+
+SweepResult SweepRunner::runPoint(const SweepPoint& point) const {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    SimulatorConfig config = baseConfig;
+    config.traces = traces;
+
+    Simulator simulator(traceBase, point.s, point.E, point.b, config);
+    simulator.run();
+
+    SweepResult result;
+    result.point = point;
+    result.totalCycles = simulator.getCurrentCycle();
+    result.busTransactions = simulator.getInterconnect().getTotalBusTransactions();
+    result.busTrafficBytes = simulator.getInterconnect().getTotalDataTrafficBytes();
+
+    for (int i = 0; i < simulator.getNumCores(); i++) {
+        const Core& core = simulator.getCore(i);
+        const Cache& cache = simulator.getCache(i);
+
+        SweepCoreResult coreResult;
+        coreResult.instructions = core.getInstructionCount();
+        coreResult.reads = core.getReadCount();
+        coreResult.writes = core.getWriteCount();
+        coreResult.executionCycles = core.getTotalCycles();
+        coreResult.idleCycles = core.getIdleCycles();
+        coreResult.misses = cache.getMisses();
+        coreResult.missRate = cache.getMissRate();
+        coreResult.evictions = cache.getEvictions();
+        coreResult.writebacks = cache.getWritebacks();
+        coreResult.invalidations = cache.getInvalidationsReceived();
+        result.cores.push_back(coreResult);
+    }
+
+    result.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+void SweepRunner::run(const std::vector<SweepPoint>& points) {
+    results.assign(points.size(), SweepResult());
+
+    // Work stealing: points are dealt round-robin into per-worker deques. A worker takes
+    // its own work from the back and, once empty, steals from the front of the others,
+    // so a few slow geometries (large blocks, low associativity) do not leave threads idle.
+    int numWorkers = std::max(1, std::min(jobs, static_cast<int>(points.size())));
+    std::vector<std::deque<size_t>> queues(numWorkers);
+    std::vector<std::mutex> queueLocks(numWorkers);
+    for (size_t i = 0; i < points.size(); i++) {
+        queues[i % numWorkers].push_back(i);
+    }
+
+    std::mutex errorLock;
+    std::string error;
+
+    std::vector<std::thread> workers;
+    for (int worker = 0; worker < numWorkers; worker++) {
+        workers.emplace_back([&, worker]() {
+            while (true) {
+                bool found = false;
+                size_t index = 0;
+                for (int offset = 0; offset < numWorkers && !found; offset++) {
+                    int victim = (worker + offset) % numWorkers;
+                    std::lock_guard<std::mutex> lock(queueLocks[victim]);
+                    if (!queues[victim].empty()) {
+                        if (victim == worker) {
+                            index = queues[victim].back();
+                            queues[victim].pop_back();
+                        } else {
+                            index = queues[victim].front();
+                            queues[victim].pop_front();
+                        }
+                        found = true;
+                    }
+                }
+                // Points never create new work, so empty queues everywhere means done
+                if (!found) {
+                    return;
+                }
+
+                try {
+                    results[index] = runPoint(points[index]);
+                } catch (const std::exception& e) {
+                    std::lock_guard<std::mutex> lock(errorLock);
+                    error = e.what();
+                }
+            }
+        });
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    if (!error.empty()) {
+        throw std::runtime_error(error);
+    }
+}
+
+void SweepRunner::writeCsv(std::ostream& out) const {
+    out << "s,E,b,cache_size_bytes,total_cycles,bus_transactions,bus_traffic_bytes,core,"
+        << "instructions,reads,writes,execution_cycles,idle_cycles,misses,miss_rate,"
+        << "evictions,writebacks,invalidations" << std::endl;
+
+    for (const SweepResult& result : results) {
+        const SweepPoint& p = result.point;
+        uint64_t cacheSize = (1ULL << p.s) * p.E * (1ULL << p.b);
+        for (size_t i = 0; i < result.cores.size(); i++) {
+            const SweepCoreResult& core = result.cores[i];
+            out << p.s << "," << p.E << "," << p.b << "," << cacheSize << ","
+                << result.totalCycles << "," << result.busTransactions << "," << result.busTrafficBytes << ","
+                << i << "," << core.instructions << "," << core.reads << "," << core.writes << ","
+                << core.executionCycles << "," << core.idleCycles << "," << core.misses << ","
+                << std::fixed << std::setprecision(6) << core.missRate << ","
+                << core.evictions << "," << core.writebacks << "," << core.invalidations << std::endl;
+        }
+    }
+}
+
+void SweepRunner::writeJson(std::ostream& out) const {
+    out << "{" << std::endl;
+    out << "  \"trace\": \"" << traceBase << "\"," << std::endl;
+    out << "  \"points\": [" << std::endl;
+
+    for (size_t r = 0; r < results.size(); r++) {
+        const SweepResult& result = results[r];
+        const SweepPoint& p = result.point;
+        out << "    {\"s\": " << p.s << ", \"E\": " << p.E << ", \"b\": " << p.b
+            << ", \"cache_size_bytes\": " << ((1ULL << p.s) * p.E * (1ULL << p.b))
+            << ", \"total_cycles\": " << result.totalCycles
+            << ", \"bus_transactions\": " << result.busTransactions
+            << ", \"bus_traffic_bytes\": " << result.busTrafficBytes
+            << ", \"wall_seconds\": " << std::fixed << std::setprecision(3) << result.wallSeconds
+            << "," << std::endl << "     \"cores\": [" << std::endl;
+
+        for (size_t i = 0; i < result.cores.size(); i++) {
+            const SweepCoreResult& core = result.cores[i];
+            out << "       {\"core\": " << i
+                << ", \"instructions\": " << core.instructions
+                << ", \"reads\": " << core.reads
+                << ", \"writes\": " << core.writes
+                << ", \"execution_cycles\": " << core.executionCycles
+                << ", \"idle_cycles\": " << core.idleCycles
+                << ", \"misses\": " << core.misses
+                << ", \"miss_rate\": " << std::fixed << std::setprecision(6) << core.missRate
+                << ", \"evictions\": " << core.evictions
+                << ", \"writebacks\": " << core.writebacks
+                << ", \"invalidations\": " << core.invalidations << "}"
+                << (i + 1 < result.cores.size() ? "," : "") << std::endl;
+        }
+        out << "     ]}" << (r + 1 < results.size() ? "," : "") << std::endl;
+    }
+
+    out << "  ]" << std::endl;
+    out << "}" << std::endl;
+}
+
+int SweepRunner::getJobs() const {
+    return jobs;
+}
+
+int SweepRunner::getNumCores() const {
+    return static_cast<int>(traces.size());
+}
+
+
+const std::vector<std::shared_ptr<const DecodedTrace>>& SweepRunner::getTraces() const {
+    return traces;
+}
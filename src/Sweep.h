@@ -0,0 +1,75 @@
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <ostream>
+#include "Types.h"
+#include "TraceReader.h"
+#include "Simulator.h"
+
+// One cache geometry of a parameter sweep
+struct SweepPoint {
+    int s;  // Set index bits
+    int E;  // Associativity
+    int b;  // Block offset bits
+};
+
+// Statistics of one core in one sweep point
+struct SweepCoreResult {
+    uint64_t instructions;
+    uint64_t reads;
+    uint64_t writes;
+    cycle_t executionCycles;
+    cycle_t idleCycles;
+    uint64_t misses;
+    double missRate;
+    uint64_t evictions;
+    uint64_t writebacks;
+    uint64_t invalidations;
+};
+
+// Statistics of one sweep point
+struct SweepResult {
+    SweepPoint point;
+    cycle_t totalCycles;            // Simulated cycles until the last core finished
+    uint64_t busTransactions;
+    uint64_t busTrafficBytes;
+    double wallSeconds;             // Host time spent simulating this point
+    std::vector<SweepCoreResult> cores;
+};
+
+// Runs one independent Simulator per sweep point on a work-stealing thread pool.
+// The traces are decoded once and shared read-only by every simulation.
+class SweepRunner {
+private:
+    std::string traceBase;
+    SimulatorConfig baseConfig;     // Interconnect/memory options shared by every point
+    int jobs;                       // Worker threads
+
+    std::vector<std::shared_ptr<const DecodedTrace>> traces;
+    std::vector<SweepResult> results;   // In sweep point order
+
+    // Simulate one point (called concurrently from the workers)
+    SweepResult runPoint(const SweepPoint& point) const;
+
+public:
+    SweepRunner(const std::string& traceBase, const SimulatorConfig& baseConfig, int jobs);
+
+    // Decode every core's trace into memory; returns the number of records decoded
+    uint64_t loadTraces();
+
+    // Simulate every point; results are kept in the order of the points
+    void run(const std::vector<SweepPoint>& points);
+
+    // Consolidated output: one CSV row per point and core, or one JSON object per point
+    void writeCsv(std::ostream& out) const;
+    void writeJson(std::ostream& out) const;
+
+    int getJobs() const;
+    int getNumCores() const;
+    const std::vector<std::shared_ptr<const DecodedTrace>>& getTraces() const;
+};
+
+#endif // SWEEP_H
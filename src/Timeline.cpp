@@ -0,0 +1,199 @@
+#include "Timeline.h"
+#include <algorithm>
+#include <cstdio>
+#include <limits>
+
+static const size_t bufferBytes = 1 << 16;
+
+// Tracks: cores are threads of process 0, bus lanes threads of process 1
+static const int corePid = 0;
+static const int busPid = 1;
+
+static const char* getActivityName(CoreActivity activity) {
+    switch (activity) {
+        case CoreActivity::Running: return "Running";
+        case CoreActivity::Blocked: return "Blocked";
+        default: return "Finished";
+    }
+}
+
+Timeline::Timeline() :
+    events(0),
+    windowStart(0),
+    windowEnd(0),
+    samplePeriod(0),
+    sampleLength(0),
+    queueDepth(0),
+    queueDepthRecorded(false) {
+}
+
+Timeline::~Timeline() {
+    if (file.is_open()) {
+        drain();
+        file.close();
+    }
+}
+
+bool Timeline::open(const std::string& name, int numCores, cycle_t start, cycle_t end,
+                    cycle_t period, cycle_t length) {
+    file.open(name, std::ios::trunc);
+    if (!file.is_open()) {
+        return false;
+    }
+    fileName = name;
+    windowStart = start;
+    windowEnd = end > 0 ? end : std::numeric_limits<cycle_t>::max();
+    samplePeriod = period;
+    sampleLength = length;
+    buffer.reserve(bufferBytes + 512);
+    events = 0;
+
+    // A core starts with no span; its first recorded activity opens one
+    coreSpans.assign(numCores, Span{CoreActivity::Finished, 0});
+    laneEnds.clear();
+    queueDepthRecorded = false;
+
+    buffer += "{\"traceEvents\":[\n";
+    addEvent("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"args\":{\"name\":\"Cores\"}}");
+    addEvent("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"Interconnect\"}}");
+    for (int i = 0; i < numCores; i++) {
+        addThreadName(corePid, i, "Core " + std::to_string(i));
+    }
+    return true;
+}
+
+bool Timeline::isRecorded(cycle_t start, cycle_t end) const {
+    start = std::max(start, windowStart);
+    end = std::min(end, windowEnd);
+    if (start >= end) {
+        return false;
+    }
+    if (samplePeriod == 0) {
+        return true;
+    }
+    // Inside the sampled part of start's period, or reaching into the next period
+    cycle_t offset = (start - windowStart) % samplePeriod;
+    return offset < sampleLength || end - start > samplePeriod - offset;
+}
+
+void Timeline::addSpan(const char* name, int pid, int tid, cycle_t start, cycle_t end, const std::string& args) {
+    start = std::max(start, windowStart);
+    end = std::min(end, windowEnd);
+    while (start < end) {
+        // Cut the span to the sampled part of the period holding start
+        cycle_t partEnd = end;
+        if (samplePeriod > 0) {
+            cycle_t periodStart = start - (start - windowStart) % samplePeriod;
+            cycle_t sampleEnd = periodStart + sampleLength;
+            if (start >= sampleEnd) {
+                start = periodStart + samplePeriod;
+                continue;
+            }
+            partEnd = std::min(end, sampleEnd);
+        }
+        std::string event = "{\"name\":\"";
+        event += name;
+        event += "\",\"ph\":\"X\",\"pid\":" + std::to_string(pid) + ",\"tid\":" + std::to_string(tid) +
+                 ",\"ts\":" + std::to_string(start) + ",\"dur\":" + std::to_string(partEnd - start);
+        if (!args.empty()) {
+            event += ",\"args\":{" + args + "}";
+        }
+        event += "}";
+        addEvent(event);
+        start = partEnd;
+    }
+}
+
+void Timeline::addEvent(const std::string& event) {
+    if (events++ > 0) {
+        buffer += ",\n";
+    }
+    buffer += event;
+    if (buffer.size() >= bufferBytes) {
+        drain();
+    }
+}
+
+void Timeline::addThreadName(int pid, int tid, const std::string& name) {
+    addEvent("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" + std::to_string(pid) + ",\"tid\":" +
+             std::to_string(tid) + ",\"args\":{\"name\":\"" + name + "\"}}");
+}
+
+void Timeline::drain() {
+    file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    buffer.clear();
+}
+
+void Timeline::changeCoreActivity(cycle_t cycle, int core, CoreActivity activity) {
+    Span& span = coreSpans[core];
+    if (span.activity != CoreActivity::Finished) {
+        addSpan(getActivityName(span.activity), corePid, core, span.start, cycle, "");
+    }
+    span.activity = activity;
+    span.start = cycle;
+}
+
+void Timeline::recordQueueDepth(cycle_t cycle, size_t depth) {
+    if (!isRecorded(cycle, cycle + 1)) {
+        queueDepthRecorded = false;
+        return;
+    }
+    // Counters hold their value until the next sample, so only changes are written
+    if (!queueDepthRecorded || depth != queueDepth) {
+        addEvent("{\"name\":\"Request Queue\",\"ph\":\"C\",\"pid\":1,\"ts\":" + std::to_string(cycle) +
+                 ",\"args\":{\"requests\":" + std::to_string(depth) + "}}");
+        queueDepth = depth;
+        queueDepthRecorded = true;
+    }
+}
+
+void Timeline::transactionComplete(const BusLogRecord& record) {
+    cycle_t end = std::max(record.completionCycle, record.grantCycle + 1);
+    if (!file.is_open() || !isRecorded(record.grantCycle, end)) {
+        return;
+    }
+
+    // First lane free since the grant; every span already on a lane ends by its lane end
+    size_t lane = 0;
+    while (lane < laneEnds.size() && laneEnds[lane] > record.grantCycle) {
+        lane++;
+    }
+    if (lane == laneEnds.size()) {
+        laneEnds.push_back(0);
+        addThreadName(busPid, static_cast<int>(lane), "Bus lane " + std::to_string(lane));
+    }
+    laneEnds[lane] = end;
+
+    char address[16];
+    std::snprintf(address, sizeof(address), "0x%x", static_cast<unsigned>(record.address));
+    std::string args = "\"core\":" + std::to_string(record.requesterId) + ",\"address\":\"" + address +
+                       "\",\"requested\":" + std::to_string(record.startCycle) +
+                       ",\"wait\":" + std::to_string(record.grantCycle - record.startCycle);
+    if (record.type != BusRequestType::WriteBack) {
+        args += std::string(",\"source\":\"") + (record.servedByCache ? "cache" : "memory") + "\"";
+    }
+    if (record.joinedReaders > 0) {
+        args += ",\"joined\":" + std::to_string(record.joinedReaders);
+    }
+    addSpan(BusLog::getTypeName(record.type), busPid, static_cast<int>(lane), record.grantCycle, end, args);
+}
+
+void Timeline::close(cycle_t cycle) {
+    if (!file.is_open()) {
+        return;
+    }
+    for (size_t i = 0; i < coreSpans.size(); i++) {
+        changeCoreActivity(cycle, static_cast<int>(i), CoreActivity::Finished);
+    }
+    buffer += "\n]}\n";
+    drain();
+    file.close();
+}
+
+const std::string& Timeline::getFileName() const {
+    return fileName;
+}
+
+uint64_t Timeline::getEvents() const {
+    return events;
+}
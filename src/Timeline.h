@@ -0,0 +1,85 @@
+#ifndef TIMELINE_H
+#define TIMELINE_H
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include "Types.h"
+#include "BusLog.h"
+
+// What a core did in a cycle, as seen after its tick
+enum class CoreActivity {
+    Running,
+    Blocked,    // Waiting for a miss
+    Finished
+};
+
+// Timeline of a run in the Chrome trace-event JSON format (chrome://tracing, Perfetto UI).
+// One cycle is shown as one microsecond. Tracks:
+// - one per core, with its running and blocked spans;
+// - bus lanes with each transaction's occupancy from grant to completion (concurrent
+//   transactions on slices or the network take separate lanes), with the request cycle
+//   and queue wait as arguments;
+// - a counter with the number of queued interconnect requests.
+// Only cycles in [windowStart, windowEnd) are recorded, and with sampling only the first
+// sampleLength cycles of every samplePeriod from windowStart. Spans are cut at the edges
+// of the recorded cycles. Events are buffered and written in 64 KiB blocks.
+class Timeline : public BusLogListener {
+private:
+    struct Span {
+        CoreActivity activity;
+        cycle_t start;
+    };
+
+    std::ofstream file;
+    std::string fileName;
+    std::string buffer;
+    uint64_t events;
+    cycle_t windowStart;
+    cycle_t windowEnd;
+    cycle_t samplePeriod;    // 0 = every cycle of the window
+    cycle_t sampleLength;
+
+    std::vector<Span> coreSpans;
+    std::vector<cycle_t> laneEnds;   // Last completion placed on each bus lane
+    size_t queueDepth;
+    bool queueDepthRecorded;
+
+    // Does [start, end) contain a recorded cycle?
+    bool isRecorded(cycle_t start, cycle_t end) const;
+    // Emit a complete event for each recorded part of [start, end)
+    void addSpan(const char* name, int pid, int tid, cycle_t start, cycle_t end, const std::string& args);
+    void addEvent(const std::string& event);
+    void addThreadName(int pid, int tid, const std::string& name);
+    void drain();
+
+public:
+    Timeline();
+    ~Timeline();
+
+    // Create the file; returns false if it cannot be created. windowEnd 0 = no end,
+    // samplePeriod 0 = no sampling
+    bool open(const std::string& fileName, int numCores, cycle_t windowStart, cycle_t windowEnd,
+              cycle_t samplePeriod, cycle_t sampleLength);
+
+    // Called once per cycle for each core after the cores have ticked
+    void recordCore(cycle_t cycle, int core, CoreActivity activity) {
+        if (coreSpans[core].activity != activity) {
+            changeCoreActivity(cycle, core, activity);
+        }
+    }
+    void changeCoreActivity(cycle_t cycle, int core, CoreActivity activity);
+
+    // Called once per cycle with the interconnect's queued requests
+    void recordQueueDepth(cycle_t cycle, size_t depth);
+
+    void transactionComplete(const BusLogRecord& record) override;
+
+    // End the open spans at cycle, finish the JSON and close the file
+    void close(cycle_t cycle);
+
+    const std::string& getFileName() const;
+    uint64_t getEvents() const;
+};
+
+#endif // TIMELINE_H
@@ -0,0 +1,206 @@
+#include "Trace.h"
+#include <sstream>
+
+unsigned Tracer::activeCategories = 0;
+std::ostream* Tracer::textOut = nullptr;
+std::ofstream Tracer::binaryOut;
+std::vector<char> Tracer::buffer;
+size_t Tracer::used = 0;
+
+const size_t Tracer::maxStringBytes;
+const size_t Tracer::bufferBytes;
+const uint64_t Tracer::fileMagic;
+const uint32_t Tracer::fileVersion;
+
+#define TRACE_EVENT_FORMAT(name, category, level, format) format,
+static const char* const eventFormats[] = { TRACE_EVENTS(TRACE_EVENT_FORMAT) };
+
+void Tracer::startText(std::ostream& out, unsigned categories) {
+    stop();
+    textOut = &out;
+    buffer.assign(bufferBytes, 0);
+    activeCategories = categories;
+}
+
+bool Tracer::startBinary(const std::string& file, unsigned categories) {
+    stop();
+    binaryOut.open(file, std::ios::binary | std::ios::trunc);
+    if (!binaryOut.is_open()) {
+        return false;
+    }
+    writeHeader();
+    buffer.assign(bufferBytes, 0);
+    activeCategories = categories;
+    return true;
+}
+
+void Tracer::writeHeader() {
+    uint16_t events = static_cast<uint16_t>(TraceEvent::Count);
+    binaryOut.write(reinterpret_cast<const char*>(&fileMagic), sizeof(fileMagic));
+    binaryOut.write(reinterpret_cast<const char*>(&fileVersion), sizeof(fileVersion));
+    binaryOut.write(reinterpret_cast<const char*>(&events), sizeof(events));
+    for (uint16_t event = 0; event < events; event++) {
+        uint8_t category = static_cast<uint8_t>(traceEventCategories[event]);
+        uint8_t level = static_cast<uint8_t>(traceEventLevels[event]);
+        uint16_t length = static_cast<uint16_t>(std::strlen(eventFormats[event]));
+        binaryOut.write(reinterpret_cast<const char*>(&category), 1);
+        binaryOut.write(reinterpret_cast<const char*>(&level), 1);
+        binaryOut.write(reinterpret_cast<const char*>(&length), 2);
+        binaryOut.write(eventFormats[event], length);
+    }
+}
+
+void Tracer::drain() {
+    if (used == 0) {
+        return;
+    }
+    if (textOut == nullptr) {
+        binaryOut.write(buffer.data(), static_cast<std::streamsize>(used));
+        used = 0;
+        return;
+    }
+
+    // Decode the whole batch, then hand it to the stream in one write
+    std::string text;
+    text.reserve(used * 2);
+    for (size_t offset = 0; offset + 4 <= used; ) {
+        uint16_t header[2];
+        std::memcpy(header, &buffer[offset], 4);
+        text += "DEBUG: ";
+        formatRecord(text, eventFormats[header[0]], &buffer[offset + 4], header[1]);
+        text += '\n';
+        offset += 4 + header[1];
+    }
+    textOut->write(text.data(), static_cast<std::streamsize>(text.size()));
+    used = 0;
+}
+
+void Tracer::flush() {
+    if (activeCategories == 0) {
+        return;
+    }
+    drain();
+    if (textOut != nullptr) {
+        textOut->flush();
+    } else {
+        binaryOut.flush();
+    }
+}
+
+void Tracer::stop() {
+    if (activeCategories != 0) {
+        flush();
+    }
+    activeCategories = 0;
+    textOut = nullptr;
+    if (binaryOut.is_open()) {
+        binaryOut.close();
+    }
+    std::vector<char>().swap(buffer);
+    used = 0;
+}
+
+static const char* getRequestTypeName(uint64_t type) {
+    switch (static_cast<BusRequestType>(type)) {
+        case BusRequestType::BusRd: return "BusRd";
+        case BusRequestType::BusRdX: return "BusRdX";
+        case BusRequestType::WriteBack: return "WriteBack";
+        case BusRequestType::InvalidateSig: return "InvalidateSig";
+        case BusRequestType::None: return "None";
+        default: return "Unknown";
+    }
+}
+
+static const char* getStateName(uint64_t state) {
+    switch (static_cast<CacheLineState>(state)) {
+        case CacheLineState::MODIFIED: return "Modified";
+        case CacheLineState::EXCLUSIVE: return "Exclusive";
+        case CacheLineState::SHARED: return "Shared";
+        case CacheLineState::INVALID: return "Invalid";
+        default: return "Unknown";
+    }
+}
+
+bool Tracer::formatRecord(std::string& out, const std::string& format, const char* payload, size_t bytes) {
+    size_t offset = 0;
+    for (size_t i = 0; i < format.size(); i++) {
+        if (format[i] != '%' || i + 1 == format.size()) {
+            out += format[i];
+            continue;
+        }
+        char specifier = format[++i];
+        if (specifier == 's') {
+            uint16_t length;
+            if (offset + 2 > bytes) {
+                return false;
+            }
+            std::memcpy(&length, payload + offset, 2);
+            if (offset + 2 + length > bytes) {
+                return false;
+            }
+            out.append(payload + offset + 2, length);
+            offset += 2 + length;
+            continue;
+        }
+
+        uint64_t value;
+        if (offset + 8 > bytes) {
+            return false;
+        }
+        std::memcpy(&value, payload + offset, 8);
+        offset += 8;
+        switch (specifier) {
+            case 'u':
+                out += std::to_string(value);
+                break;
+            case 'd':
+                out += std::to_string(static_cast<int64_t>(value));
+                break;
+            case 'x': {
+                std::ostringstream hex;
+                hex << std::hex << value;
+                out += hex.str();
+                break;
+            }
+            case 'f': {
+                double number;
+                std::memcpy(&number, &value, 8);
+                std::ostringstream text;
+                text << number;
+                out += text.str();
+                break;
+            }
+            case 'R':
+                out += getRequestTypeName(value);
+                break;
+            case 'S':
+                out += getStateName(value);
+                break;
+            default:
+                return false;
+        }
+    }
+    return offset == bytes;
+}
+
+bool Tracer::parseCategories(const std::string& list, unsigned& mask) {
+    mask = 0;
+    std::stringstream stream(list);
+    std::string name;
+    while (std::getline(stream, name, ',')) {
+        if (name == "all") {
+            mask |= 0xf;
+        } else if (name == "coherence") {
+            mask |= 1u << static_cast<unsigned>(TraceCategory::Coherence);
+        } else if (name == "bus") {
+            mask |= 1u << static_cast<unsigned>(TraceCategory::Bus);
+        } else if (name == "core") {
+            mask |= 1u << static_cast<unsigned>(TraceCategory::Core);
+        } else if (name == "lru") {
+            mask |= 1u << static_cast<unsigned>(TraceCategory::Lru);
+        } else {
+            return false;
+        }
+    }
+    return mask != 0;
+}
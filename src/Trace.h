@@ -0,0 +1,261 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <ostream>
+#include <cstring>
+#include <algorithm>
+#include <type_traits>
+#include "Types.h"
+
+// Debug tracing. Every trace point is an event from the table below with a category, a level
+// and a format. Events above TRACE_LEVEL or outside the TRACE_CATEGORIES mask (both set at
+// build time) compile to nothing; TRACE_LEVEL=0 removes tracing altogether. Enabled events
+// are recorded in binary (event id plus raw arguments) into a buffer that is drained in
+// batches, either decoded to text ("DEBUG: ..." lines) or written to a binary trace file
+// that L1tracedecode turns into the same text.
+//
+// Format specifiers: %u unsigned, %d signed, %x hex, %f double, %s string,
+// %R bus request type, %S MESI state.
+
+#ifndef TRACE_LEVEL
+#define TRACE_LEVEL 2          // 1 = transactions and summaries, 2 = every access and state change
+#endif
+#ifndef TRACE_CATEGORIES
+#define TRACE_CATEGORIES 0xf   // Bit per TraceCategory
+#endif
+
+enum class TraceCategory : uint8_t {
+    Coherence = 0,  // Snoops, MESI transitions, transaction completion at the caches
+    Bus = 1,        // Bus and network queues and transactions, DRAM controller
+    Core = 2,       // Cores, cache accesses and simulator progress
+    Lru = 3         // Block allocation, eviction and writeback
+};
+
+#define TRACE_EVENTS(X) \
+    X(BusInit, Bus, 1, "Bus initialized with block size: %u bytes") \
+    X(BusMemoryLatency, Bus, 1, "Memory latency set to: %u cycles") \
+    X(BusArbitration, Bus, 1, "Using fixed priority arbitration (lower core ID wins)") \
+    X(BusSliceSetup, Bus, 1, "Bus slices: %u (%s hash)") \
+    X(BusReadJoined, Bus, 2, "Cycle %u: Core %d BusRd for address 0x%x coalesced with in-flight BusRd from Core %d") \
+    X(BusRequestQueued, Bus, 2, "Cycle %u: Core %d pushed %R request for address 0x%x to bus slice %d queue (queue size: %u)") \
+    X(BusQueuedReadCoalesced, Bus, 2, "Cycle %u: Core %d queued BusRd for address 0x%x coalesced with BusRd from Core %d") \
+    X(BusEarlyRestart, Bus, 1, "Cycle %u: Bus early restart for Core %d, addr: 0x%x, %u cycles before the fill completes") \
+    X(BusTransactionComplete, Bus, 1, "Cycle %u: Bus transaction completed for Core %d, addr: 0x%x, type: %R, served by cache: %s") \
+    X(BusTransactionStart, Bus, 1, "Cycle %u: Bus started transaction for Core %d, addr: 0x%x, type: %R%s, will complete at cycle %u (latency: %u cycles), served by cache: %s") \
+    X(BusCacheTransferLatency, Bus, 2, "Cache-to-cache transfer latency: %u cycles (block size: %u bytes, %u words)") \
+    X(BusMemoryAccessLatency, Bus, 2, "Memory access latency: %u cycles") \
+    X(BusReadExclusiveLatency, Bus, 2, "Memory access latency (BusRdX): %u cycles") \
+    X(BusWriteBackLatency, Bus, 2, "WriteBack latency: %u cycles") \
+    X(BusInvalidateLatency, Bus, 2, "InvalidateSig latency: %u cycles") \
+    X(InterconnectCacheAdded, Bus, 1, "Added cache %d to interconnect") \
+    X(InterconnectTraffic, Bus, 2, "Cycle %u: Incrementing data traffic by %u bytes for %R, total now: %u bytes") \
+    X(NetworkInit, Bus, 1, "Network initialized: %s, %d nodes, %u links, %d memory controllers") \
+    X(NetworkRequestSent, Bus, 2, "Cycle %u: Core %d sent %R request for address 0x%x to home node %d, arrives at cycle %u") \
+    X(NetworkTransactionComplete, Bus, 1, "Cycle %u: Network transaction completed for Core %d, addr: 0x%x, type: %R") \
+    X(NetworkGrant, Bus, 1, "Cycle %u: Home node %d granted %R for Core %d, addr: 0x%x, will complete at cycle %u, served by cache: %s") \
+    X(MemoryInit, Bus, 1, "Memory controller initialized: %d channels, %d ranks, %d banks per rank, %d blocks per row") \
+    X(MemoryQueued, Bus, 2, "Cycle %u: Memory controller queued %s for addr 0x%x (channel %d, bank %d, row %d)") \
+    X(MemoryIssued, Bus, 2, "Cycle %u: Memory controller issued %s for addr 0x%x, data complete at cycle %u") \
+    X(SnoopBroadcast, Coherence, 2, "Cycle %u: Broadcasting snoop for addr 0x%x, type: %R") \
+    X(SnoopResponse, Coherence, 2, "Cycle %u: Cache %d responded to snoop") \
+    X(WriteBackComplete, Coherence, 1, "Cycle %u: WriteBack completed for Core %d") \
+    X(InvalidateComplete, Coherence, 1, "Cycle %u: InvalidateSig completed for Core %d") \
+    X(ReadComplete, Coherence, 1, "Cycle %u: BusRd completed for Core %d, served by cache: %s, new state: %S") \
+    X(ReadExclusiveComplete, Coherence, 1, "Cycle %u: BusRdX completed for Core %d, new state: %S") \
+    X(LineStateChange, Coherence, 2, "Cache line state transition: %S -> %S") \
+    X(WriteHitExclusive, Coherence, 2, "Cycle %u: Cache %d transition E->M on write hit") \
+    X(WriteHitShared, Coherence, 2, "Cycle %u: Cache %d write to shared line, need to invalidate other copies") \
+    X(MissRequest, Coherence, 2, "Cycle %u: Cache %d handling miss, issuing %R for addr: 0x%x") \
+    X(SnoopReceived, Coherence, 2, "Cycle %u: Cache %d received snoop, req: %R, addr: 0x%x, have block: %s") \
+    X(SnoopSupplyModified, Coherence, 2, "Cycle %u: Cache %d serving BusRd from M state, transitioning to S") \
+    X(SnoopSupplyExclusive, Coherence, 2, "Cycle %u: Cache %d serving BusRd from E state, transitioning to S") \
+    X(SnoopShared, Coherence, 2, "Cycle %u: Cache %d responding to BusRd, remaining in S state") \
+    X(SnoopInvalidateModified, Coherence, 2, "Cycle %u: Cache %d invalidating line due to BusRdX (was Modified), writing back data to memory") \
+    X(SnoopInvalidate, Coherence, 2, "Cycle %u: Cache %d invalidating line due to %R (was %S)") \
+    X(InvalidationReceived, Coherence, 1, "Cycle %u: Cache %d INVALIDATION due to %R from Core %d, previous state: %S, invalidation count: %u") \
+    X(InvalidationProfile, Coherence, 1, "Cache %d invalidation profile after %u invalidations:") \
+    X(InvalidationProfileEntry, Coherence, 1, "  Address 0x%x: %u invalidations") \
+    X(TransactionComplete, Coherence, 2, "Cycle %u: Cache %d transaction complete for addr: 0x%x, new state: %S") \
+    X(WriteBackNoChange, Coherence, 2, "Cycle %u: Cache %d writeback complete, no state change needed") \
+    X(LineStateUpdate, Coherence, 2, "Cycle %u: Cache %d updating existing line state to %S (from %S)") \
+    X(CacheAccess, Core, 2, "Cycle %u: Cache %d access, op: %s, addr: 0x%x (tag: 0x%x, set: %d)") \
+    X(CacheHit, Core, 2, "Cycle %u: Cache %d HIT, line state: %S") \
+    X(CacheMiss, Core, 2, "Cycle %u: Cache %d MISS, addr: 0x%x") \
+    X(CachePartialFillStall, Core, 2, "Cycle %u: Cache %d word %d of filling line not yet arrived, stalled until cycle %u") \
+    X(CacheUnblocked, Core, 2, "Cycle %u: Cache %d unblocked, ready from cycle %u") \
+    X(CacheEarlyRestart, Core, 2, "Cycle %u: Cache %d early restart on word %d, line fill completes at cycle %u") \
+    X(CacheAllocate, Lru, 2, "Cycle %u: Cache %d allocating block, addr: 0x%x, state: %S") \
+    X(CacheUpdateExisting, Lru, 2, "Cycle %u: Cache %d updating existing line for tag: 0x%x, old state: %S, new state: %S") \
+    X(CacheEvict, Lru, 2, "Cycle %u: Cache %d evicting line, tag: 0x%x, state: %S") \
+    X(CacheWriteBack, Lru, 2, "Cycle %u: Cache %d initiating writeback, addr: 0x%x") \
+    X(CoreInitFile, Core, 1, "Core %d initialized with trace file: %s") \
+    X(CoreInitDecoded, Core, 1, "Core %d initialized with a decoded trace of %u entries") \
+    X(CoreUnblocked, Core, 2, "Cycle %u: Core %d unblocked") \
+    X(CoreProgress, Core, 1, "Core %d executed %u instructions, %u reads, %u writes") \
+    X(CoreBlocked, Core, 2, "Cycle %u: Core %d blocked due to cache miss, addr: 0x%x, op: %s") \
+    X(CoreFinished, Core, 1, "Cycle %u: Core %d finished execution after %u instructions") \
+    X(CoreFinishedFastForward, Core, 1, "Cycle %u: Core %d finished execution after %u instructions (fast-forward)") \
+    X(CoreIdle, Core, 1, "Core %d idle cycle count: %u") \
+    X(CoreFinalStats, Core, 1, "Core %d final stats - Total cycles: %u, Idle cycles: %u, Instructions: %u, Execution cycles: %u") \
+    X(SimulatorInit, Core, 1, "Simulator initialized with parameters: ") \
+    X(SimulatorCores, Core, 1, "  Cores: %d") \
+    X(SimulatorIndexBits, Core, 1, "  Index bits (s): %d") \
+    X(SimulatorAssociativity, Core, 1, "  Associativity (E): %d") \
+    X(SimulatorBlockBits, Core, 1, "  Block offset bits (b): %d") \
+    X(SimulatorBlockSize, Core, 1, "  Block size: %d bytes") \
+    X(SimulatorCacheSize, Core, 1, "  Cache size per core: %f KB") \
+    X(SimulatorCoresInitialized, Core, 1, "Initialized %d cores and caches.") \
+    X(SimulationStart, Core, 1, "Starting simulation...") \
+    X(SimulationStatus, Core, 1, "Cycle %u: %sBus queue size: %u") \
+    X(SimulationComplete, Core, 1, "Simulation completed at cycle %u") \
+    X(CoreExecutionCycles, Core, 1, "Core %d execution cycles: %u") \
+    X(ParallelEngineStart, Core, 1, "Parallel engine: %d threads, quantum %u cycles") \
+    X(SampledStart, Core, 1, "Sampled simulation: %u fast-forward, %u warm-up and %u measured records per core per unit") \
+    X(AllCoresFinished, Core, 1, "All cores finished at cycle %u") \
+    X(CheckpointSaved, Core, 1, "Checkpoint saved at cycle %u to %s") \
+    X(CheckpointRestored, Core, 1, "Restored checkpoint %s at cycle %u")
+
+#define TRACE_EVENT_NAME(name, category, level, format) name,
+#define TRACE_EVENT_CATEGORY(name, category, level, format) TraceCategory::category,
+#define TRACE_EVENT_LEVEL(name, category, level, format) level,
+
+enum class TraceEvent : uint16_t {
+    TRACE_EVENTS(TRACE_EVENT_NAME)
+    Count
+};
+
+constexpr TraceCategory traceEventCategories[] = { TRACE_EVENTS(TRACE_EVENT_CATEGORY) };
+constexpr int traceEventLevels[] = { TRACE_EVENTS(TRACE_EVENT_LEVEL) };
+
+// Is the event compiled into this build?
+constexpr bool traceCompiled(TraceEvent event) {
+    return traceEventLevels[static_cast<size_t>(event)] <= TRACE_LEVEL &&
+           ((TRACE_CATEGORIES >> static_cast<unsigned>(traceEventCategories[static_cast<size_t>(event)])) & 1) != 0;
+}
+
+class Tracer {
+private:
+    static unsigned activeCategories;    // Runtime category mask (0 = tracing off)
+    static std::ostream* textOut;        // Text sink, or nullptr when writing binaryOut
+    static std::ofstream binaryOut;
+    static std::vector<char> buffer;     // Pending records: u16 event, u16 payload bytes, payload
+    static size_t used;
+
+    static const size_t maxStringBytes = 1024;
+
+    static void drain();
+    static void writeHeader();
+
+    // Record payload encoding: scalars take 8 bytes, strings a u16 length and their bytes
+    static size_t argumentBytes(const char* value) {
+        return 2 + std::min(std::strlen(value), maxStringBytes);
+    }
+    static size_t argumentBytes(const std::string& value) {
+        return 2 + std::min(value.size(), maxStringBytes);
+    }
+    template <typename T>
+    static size_t argumentBytes(const T&) {
+        return 8;
+    }
+
+    static void putString(char*& out, const char* value, size_t length) {
+        uint16_t stored = static_cast<uint16_t>(std::min(length, maxStringBytes));
+        std::memcpy(out, &stored, 2);
+        std::memcpy(out + 2, value, stored);
+        out += 2 + stored;
+    }
+    static void putArgument(char*& out, const char* value) {
+        putString(out, value, std::strlen(value));
+    }
+    static void putArgument(char*& out, const std::string& value) {
+        putString(out, value.data(), value.size());
+    }
+    static void putArgument(char*& out, double value) {
+        std::memcpy(out, &value, 8);
+        out += 8;
+    }
+    template <typename T>
+    static void putArgument(char*& out, const T& value) {
+        static_assert(std::is_integral<T>::value || std::is_enum<T>::value, "unsupported trace argument");
+        uint64_t raw = static_cast<uint64_t>(value);
+        std::memcpy(out, &raw, 8);
+        out += 8;
+    }
+
+    static size_t payloadBytes() {
+        return 0;
+    }
+    template <typename T, typename... Rest>
+    static size_t payloadBytes(const T& first, const Rest&... rest) {
+        return argumentBytes(first) + payloadBytes(rest...);
+    }
+    static void putArguments(char*&) {
+    }
+    template <typename T, typename... Rest>
+    static void putArguments(char*& out, const T& first, const Rest&... rest) {
+        putArgument(out, first);
+        putArguments(out, rest...);
+    }
+
+public:
+    static const size_t bufferBytes = 1 << 16;
+
+    // Start tracing the given categories (bit per TraceCategory) as text, or into a binary file.
+    // startBinary returns false if the file cannot be created.
+    static void startText(std::ostream& out, unsigned categories);
+    static bool startBinary(const std::string& file, unsigned categories);
+
+    // Drain the pending records (before writing other output to the text sink)
+    static void flush();
+
+    // Drain and stop tracing
+    static void stop();
+
+    static bool isActive(TraceEvent event) {
+        return (activeCategories >> static_cast<unsigned>(traceEventCategories[static_cast<size_t>(event)])) & 1;
+    }
+
+    template <typename... Args>
+    static void record(TraceEvent event, const Args&... args) {
+        size_t bytes = payloadBytes(args...);
+        if (used + 4 + bytes > buffer.size()) {
+            drain();
+        }
+        char* out = &buffer[used];
+        uint16_t header[2] = { static_cast<uint16_t>(event), static_cast<uint16_t>(bytes) };
+        std::memcpy(out, header, 4);
+        out += 4;
+        putArguments(out, args...);
+        used += 4 + bytes;
+    }
+
+    // Append the text of one record; returns false if the payload does not match the format
+    static bool formatRecord(std::string& out, const std::string& format, const char* payload, size_t bytes);
+
+    // Parse a comma-separated category list (coherence,bus,core,lru or all) into a mask
+    static bool parseCategories(const std::string& list, unsigned& mask);
+
+    // Binary trace file layout: magic, version, the event table (category, level and format
+    // of every event id), then the records
+    static const uint64_t fileMagic = 0x314543415254314cULL; // "L1TRACE1" on a little-endian host
+    static const uint32_t fileVersion = 1;
+};
+
+// Record an event when it is compiled in and its category is being traced. Compiled-out
+// events leave a dead branch, so their arguments still count as used.
+#define TRACE(event, ...) \
+    do { \
+        if (std::integral_constant<bool, traceCompiled(TraceEvent::event)>::value && \
+            Tracer::isActive(TraceEvent::event)) { \
+            Tracer::record(TraceEvent::event, ##__VA_ARGS__); \
+        } \
+    } while (0)
+
+// Guard for work done only to produce trace events
+#define TRACE_ACTIVE(event) \
+    (std::integral_constant<bool, traceCompiled(TraceEvent::event)>::value && Tracer::isActive(TraceEvent::event))
+
+#endif // TRACE_H
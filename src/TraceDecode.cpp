@@ -0,0 +1,128 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include "Trace.h"
+
+// Decoder for the binary files written by L1simulate --trace-out. Prints the records in
+// the same "DEBUG: ..." form as -d, optionally limited to some categories and levels.
+// The event table is read from the file, so traces from other builds decode as well.
+
+struct EventInfo {
+    unsigned category;
+    int level;
+    std::string format;
+};
+
+void printUsage(const char* programName) {
+    std::cout << "Usage: " << programName << " [-c <categories>] [-l <level>] <tracefile>" << std::endl;
+    std::cout << "-c <categories>: Print only these categories (coherence,bus,core,lru or all; default: all)" << std::endl;
+    std::cout << "-l <level>: Print only events up to this verbosity level (default: all)" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    unsigned categories = 0xf;
+    int maxLevel = 255;
+    std::string file;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-c" && i + 1 < argc) {
+            if (!Tracer::parseCategories(argv[++i], categories)) {
+                std::cerr << "Error: unknown trace category in '" << argv[i] << "'" << std::endl;
+                return 1;
+            }
+        } else if (arg == "-l" && i + 1 < argc) {
+            maxLevel = std::atoi(argv[++i]);
+        } else if (arg == "-h") {
+            printUsage(argv[0]);
+            return 0;
+        } else if (file.empty() && arg[0] != '-') {
+            file = arg;
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (file.empty()) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::ifstream in(file, std::ios::binary);
+    if (!in.is_open()) {
+        std::cerr << "Error: cannot open trace file " << file << std::endl;
+        return 1;
+    }
+
+    uint64_t magic = 0;
+    uint32_t version = 0;
+    uint16_t eventCount = 0;
+    in.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+    in.read(reinterpret_cast<char*>(&version), sizeof(version));
+    in.read(reinterpret_cast<char*>(&eventCount), sizeof(eventCount));
+    if (!in || magic != Tracer::fileMagic) {
+        std::cerr << "Error: " << file << " is not a simulator trace" << std::endl;
+        return 1;
+    }
+    if (version != Tracer::fileVersion) {
+        std::cerr << "Error: unsupported trace version " << version << std::endl;
+        return 1;
+    }
+
+    std::vector<EventInfo> events(eventCount);
+    for (EventInfo& event : events) {
+        uint8_t category = 0;
+        uint8_t level = 0;
+        uint16_t length = 0;
+        in.read(reinterpret_cast<char*>(&category), 1);
+        in.read(reinterpret_cast<char*>(&level), 1);
+        in.read(reinterpret_cast<char*>(&length), 2);
+        event.category = category;
+        event.level = level;
+        event.format.resize(length);
+        if (length > 0) {
+            in.read(&event.format[0], length);
+        }
+    }
+    if (!in) {
+        std::cerr << "Error: trace event table is truncated" << std::endl;
+        return 1;
+    }
+
+    // Decode in batches and write each batch at once
+    std::string text;
+    std::vector<char> payload;
+    uint64_t records = 0;
+    uint16_t header[2];
+    while (in.read(reinterpret_cast<char*>(header), sizeof(header))) {
+        payload.resize(header[1]);
+        if (header[1] > 0 && !in.read(payload.data(), header[1])) {
+            std::cerr << "Error: trace is truncated after " << records << " records" << std::endl;
+            break;
+        }
+        records++;
+        if (header[0] >= events.size()) {
+            std::cerr << "Error: unknown event id " << header[0] << " in record " << records << std::endl;
+            return 1;
+        }
+        const EventInfo& event = events[header[0]];
+        if (((categories >> event.category) & 1) == 0 || event.level > maxLevel) {
+            continue;
+        }
+        text += "DEBUG: ";
+        if (!Tracer::formatRecord(text, event.format, payload.data(), payload.size())) {
+            std::cerr << "Error: record " << records << " does not match its event format" << std::endl;
+            return 1;
+        }
+        text += '\n';
+        if (text.size() >= Tracer::bufferBytes) {
+            std::cout.write(text.data(), static_cast<std::streamsize>(text.size()));
+            text.clear();
+        }
+    }
+    std::cout.write(text.data(), static_cast<std::streamsize>(text.size()));
+    std::cout.flush();
+    return 0;
+}
@@ -2,6 +2,11 @@
 #include <iostream>
 #include <cctype>
 #include <sstream>
+#include <iterator>
+#include <algorithm>
+#include <thread>
+#include <stdexcept>
+#include "Checkpoint.h"
 
 TraceReader::TraceReader(const std::string& filename) {
     fileStream.open(filename);
@@ -11,6 +16,10 @@ TraceReader::TraceReader(const std::string& filename) {
     }
 }
 
+TraceReader::TraceReader(std::shared_ptr<const DecodedTrace> entries) :
+    decoded(entries) {
+}
+
 TraceReader::~TraceReader() {
     if (fileStream.is_open()) {
         fileStream.close();
@@ -18,6 +27,15 @@ TraceReader::~TraceReader() {
 }
 
 bool TraceReader::getNextTrace(TraceEntry& entry) {
+    if (decoded) {
+        if (position >= decoded->size()) {
+            eof = true;
+            return false;
+        }
+        entry = (*decoded)[position++];
+        return true;
+    }
+    
     if (eof || !fileStream.is_open()) {
         return false;
     }
@@ -27,6 +45,7 @@ bool TraceReader::getNextTrace(TraceEntry& entry) {
         eof = true;
         return false;
     }
+    position++;
 
     // Parse the line
     std::istringstream iss(line);
@@ -71,4 +90,167 @@ bool TraceReader::getNextTrace(TraceEntry& entry) {
 
 bool TraceReader::isEOF() const {
     return eof;
-} 
+}
+
+void TraceReader::saveState(CheckpointWriter& writer) {
+    int64_t offset = -1;
+    if (!decoded && !eof && fileStream.is_open()) {
+        offset = static_cast<int64_t>(fileStream.tellg());
+    }
+    writer.write<uint64_t>(position);
+    writer.write(eof);
+    writer.write(offset);
+}
+
+void TraceReader::loadState(CheckpointReader& reader) {
+    uint64_t savedPosition = reader.read<uint64_t>();
+    bool savedEof = reader.read<bool>();
+    int64_t offset = reader.read<int64_t>();
+    
+    if (decoded) {
+        if (savedPosition > decoded->size()) {
+            throw std::runtime_error("checkpoint position lies beyond the end of the trace");
+        }
+        position = savedPosition;
+        eof = savedEof;
+        return;
+    }
+    if (!fileStream.is_open()) {
+        return;
+    }
+    
+    // Seek straight to the saved offset, or skip the lines read when it came from a decoded trace
+    fileStream.clear();
+    fileStream.seekg(0);
+    position = 0;
+    eof = false;
+    if (savedEof) {
+        fileStream.seekg(0, std::ios::end);
+        position = savedPosition;
+        eof = true;
+    } else if (offset >= 0) {
+        fileStream.seekg(offset);
+        position = savedPosition;
+    } else {
+        std::string line;
+        while (position < savedPosition && std::getline(fileStream, line)) {
+            position++;
+        }
+    }
+    if (!fileStream) {
+        throw std::runtime_error("checkpoint position lies beyond the end of the trace");
+    }
+}
+
+bool TraceReader::decodeFile(const std::string& filename, DecodedTrace& entries) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Error opening trace file: " << filename << std::endl;
+        return false;
+    }
+    
+    // Read the whole file at once and parse it in place; far faster than line streams
+    std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    entries.clear();
+    entries.reserve(text.size() / 12); // "R 0x12345678\n" is ~13 bytes
+    
+    const char* p = text.data();
+    const char* end = p + text.size();
+    while (p < end) {
+        const char* lineEnd = p;
+        while (lineEnd < end && *lineEnd != '\n') {
+            lineEnd++;
+        }
+        
+        // <op> <hex address>, surrounded by optional whitespace
+        const char* c = p;
+        while (c < lineEnd && std::isspace(static_cast<unsigned char>(*c))) {
+            c++;
+        }
+        char opChar = (c < lineEnd) ? *c++ : '\0';
+        while (c < lineEnd && std::isspace(static_cast<unsigned char>(*c))) {
+            c++;
+        }
+        if (c + 1 < lineEnd && c[0] == '0' && (c[1] == 'x' || c[1] == 'X')) {
+            c += 2;
+        }
+        uint64_t address = 0;
+        int digits = 0;
+        while (c < lineEnd && std::isxdigit(static_cast<unsigned char>(*c))) {
+            int value = std::isdigit(static_cast<unsigned char>(*c)) ? *c - '0' : (std::tolower(*c) - 'a' + 10);
+            address = (address << 4) | value;
+            digits++;
+            c++;
+        }
+        
+        TraceEntry entry;
+        if (opChar == 'R' || opChar == 'r') {
+            entry.op = MemOperation::READ;
+        } else if (opChar == 'W' || opChar == 'w') {
+            entry.op = MemOperation::WRITE;
+        } else {
+            std::cerr << "Error parsing trace line: " << std::string(p, lineEnd) << std::endl;
+            break;
+        }
+        if (digits == 0) {
+            std::cerr << "Error parsing trace line: " << std::string(p, lineEnd) << std::endl;
+            break;
+        }
+        entry.addr = static_cast<address_t>(address);
+        entries.push_back(entry);
+        
+        p = lineEnd + 1;
+    }
+    
+    return true;
+}
+
+DecodedTrace TraceReader::sampleSets(const DecodedTrace& trace, int s, int b, int sampleBits) {
+    address_t offsetMask = (static_cast<address_t>(1) << b) - 1;
+    address_t setMask = (static_cast<address_t>(1) << s) - 1;
+    address_t sampleMask = (static_cast<address_t>(1) << sampleBits) - 1;
+    
+    DecodedTrace sampled;
+    sampled.reserve((trace.size() >> sampleBits) + 1);
+    for (const TraceEntry& entry : trace) {
+        address_t set = (entry.addr >> b) & setMask;
+        if ((set & sampleMask) != 0) {
+            continue;
+        }
+        address_t tag = static_cast<address_t>(static_cast<uint64_t>(entry.addr) >> (s + b));
+        TraceEntry kept = entry;
+        kept.addr = static_cast<address_t>((static_cast<uint64_t>(tag) << (s - sampleBits + b)) |
+                                           ((set >> sampleBits) << b) | (entry.addr & offsetMask));
+        sampled.push_back(kept);
+    }
+    return sampled;
+}
+
+std::vector<std::shared_ptr<const DecodedTrace>> TraceReader::decodeTraces(const std::string& traceBase,
+                                                                           int numCores, int threads) {
+    // Each core's file is independent, so the files are decoded in parallel
+    threads = std::max(1, std::min(threads, numCores));
+    std::vector<std::shared_ptr<DecodedTrace>> decoded(numCores);
+    std::vector<char> opened(numCores, 0); // Not vector<bool>: written concurrently
+    std::vector<std::thread> decoders;
+    for (int worker = 0; worker < threads; worker++) {
+        decoders.emplace_back([&, worker]() {
+            for (int core = worker; core < numCores; core += threads) {
+                decoded[core] = std::make_shared<DecodedTrace>();
+                opened[core] = decodeFile(traceBase + "_proc" + std::to_string(core) + ".trace", *decoded[core]);
+            }
+        });
+    }
+    for (std::thread& decoder : decoders) {
+        decoder.join();
+    }
+    
+    std::vector<std::shared_ptr<const DecodedTrace>> traces;
+    for (int core = 0; core < numCores; core++) {
+        if (!opened[core]) {
+            throw std::runtime_error("trace file not found: " + traceBase + "_proc" + std::to_string(core) + ".trace");
+        }
+        traces.push_back(decoded[core]);
+    }
+    return traces;
+}
@@ -3,17 +3,32 @@
 
 #include <fstream>
 #include <string>
+#include <vector>
+#include <memory>
 #include "Types.h"
 
+class CheckpointWriter;
+class CheckpointReader;
+
+// A whole trace decoded into memory, shared read-only between simulations
+typedef std::vector<TraceEntry> DecodedTrace;
+
 class TraceReader {
 private:
     std::ifstream fileStream;
     bool eof = false;
+    
+    // In-memory source (used instead of the file when set)
+    std::shared_ptr<const DecodedTrace> decoded;
+    size_t position = 0;    // Entries read so far (index of the next one in the decoded trace)
 
 public:
     // Constructor takes filename of trace to read
     TraceReader(const std::string& filename);
     
+    // Read from an already decoded trace
+    TraceReader(std::shared_ptr<const DecodedTrace> entries);
+    
     // Destructor to close file handle
     ~TraceReader();
     
@@ -23,6 +38,24 @@ public:
     
     // Check if we've reached end of file
     bool isEOF() const;
+    
+    // Checkpointing: the number of entries read and, for a trace file, the offset of the next
+    // line. A position saved from a decoded trace can be restored on the file and vice versa.
+    void saveState(CheckpointWriter& writer);
+    void loadState(CheckpointReader& reader);
+    
+    // Decode a whole trace file into memory. Stops at the first malformed line, like
+    // getNextTrace does. Returns false if the file cannot be opened.
+    static bool decodeFile(const std::string& filename, DecodedTrace& entries);
+    
+    // Decode <traceBase>_proc0..N-1.trace on up to `threads` threads. Throws if a file is missing.
+    static std::vector<std::shared_ptr<const DecodedTrace>> decodeTraces(const std::string& traceBase,
+                                                                         int numCores, int threads);
+    
+    // Set sampling: keep only the accesses to one set in every 2^sampleBits (those whose low
+    // sampleBits set-index bits are zero) and drop those bits from the address, so a cache with
+    // s - sampleBits index bits holds exactly the sampled sets. Tags and offsets are unchanged.
+    static DecodedTrace sampleSets(const DecodedTrace& trace, int s, int b, int sampleBits);
 };
 
 #endif // TRACEREADER_H 
\ No newline at end of file
@@ -29,6 +29,17 @@ enum class BusRequestType {
     None = 0         // No request
 };
 
+// What a blocked core is waiting for (idle cycle attribution)
+enum class StallCause {
+    Arbitration,   // Its request is queued behind other requests
+    WriteBack,     // Its request is queued while another core's writeback holds the bus slice
+    Memory,        // Its request was granted and the block comes from memory
+    CacheToCache,  // Its request was granted and another cache supplies the block
+    Upgrade,       // Its InvalidateSig (write to a shared line) was granted
+    Fill,          // The block has arrived: the restart cycle, or a word still being filled
+    Count
+};
+
 // Memory operation types
 enum class MemOperation { 
     READ,
@@ -1,21 +1,497 @@
 #include <iostream>
 #include <string>
+#include <vector>
+#include <sstream>
+#include <algorithm>
+#include <stdexcept>
 #include <unistd.h>
 #include <getopt.h>
 #include <filesystem>
+#include <fstream>
+#include <chrono>
+#include <thread>
+#include <memory>
+#include <iomanip>
+#include <cmath>
 #include "Simulator.h"
+#include "Sweep.h"
+#include "FunctionalSimulator.h"
+#include "StackDistance.h"
+#include "Shards.h"
+#include "Trace.h"
+#include "BusReplay.h"
 
 void printUsage(const char* programName) {
-    std::cout << "Usage: " << programName << " -t <tracefile> -s <s> -E <E> -b <b> [-o <outfile>] [-d] [-h]" << std::endl;
-    std::cout << "-t <tracefile>: Name of the trace file (without the _proc{0,1,2,3}.trace suffix)" << std::endl;
+    std::cout << "Usage: " << programName << " -t <tracefile> -s <s> -E <E> -b <b> [-n <cores>] [-o <outfile>] [-d] [-h]" << std::endl;
+    std::cout << "-t <tracefile>: Name of the trace file (without the _procN.trace suffix)" << std::endl;
+    std::cout << "-n <cores>: Number of cores (default: one per _proc0.trace, _proc1.trace, ... file found)" << std::endl;
     std::cout << "-s <s>: Number of set index bits (number of sets = 2^s)" << std::endl;
     std::cout << "-E <E>: Associativity (number of lines per set)" << std::endl;
     std::cout << "-b <b>: Number of block bits (block size = 2^b bytes)" << std::endl;
     std::cout << "-o <outfile>: Output file for statistics (default: stdout)" << std::endl;
-    std::cout << "-d, --debug: Enable debug output" << std::endl;
+    std::cout << "--format <text|json|csv>: Statistics format; json and csv have a fixed set of numeric fields (default: text)" << std::endl;
+    std::cout << "--sweep: Simulate every combination of -s/-E/-b values; each accepts a list (4,5,6)" << std::endl;
+    std::cout << "         or an inclusive range (4:8 or 1:16:step). Writes CSV, or JSON if -o ends in .json" << std::endl;
+    std::cout << "--jobs <n>: Sweep worker threads (default: all hardware threads)" << std::endl;
+    std::cout << "--functional: Run a timing-free tag-only model (counts only); with --sweep, all configurations in one pass" << std::endl;
+    std::cout << "--interleave <rr|proportional>: With --functional, merge the core traces round-robin or in" << std::endl;
+    std::cout << "    proportion to their lengths (default: rr)" << std::endl;
+    std::cout << "--mrc: Print exact LRU miss-ratio curves of each core's trace: every fully-associative" << std::endl;
+    std::cout << "       capacity, and associativities 1..E at 2^s sets (block size 2^b)" << std::endl;
+    std::cout << "--shards-rate <r>: With --mrc, sample blocks at rate r (0 < r <= 1) for a fully-associative curve" << std::endl;
+    std::cout << "--shards-size <n>: With --mrc, sample at most n blocks, lowering the rate as needed" << std::endl;
+    std::cout << "--shards-validate: Also compute the exact curve and report the sampling error" << std::endl;
+    std::cout << "--sample <interval,warmup,window>: Sampled simulation: per interval records of each core," << std::endl;
+    std::cout << "    fast-forward functionally, then warm up and measure a window in detail" << std::endl;
+    std::cout << "--max-cycles <n>: Stop the simulation after n cycles (default: run to completion)" << std::endl;
+    std::cout << "--set-sample <n>: Simulate one set in every n (a power of two) and scale the counts" << std::endl;
+    std::cout << "--checkpoint <file> --checkpoint-at <cycle>: Save the full simulation state at the start" << std::endl;
+    std::cout << "    of the given cycle (the run then continues)" << std::endl;
+    std::cout << "--restore <file>: Resume from a checkpoint taken with the same traces and cache organization" << std::endl;
+    std::cout << "--bus-log <file>: Log every bus transaction to a binary file (see L1buslog)" << std::endl;
+    std::cout << "--replay <file>: Re-drive the caches and interconnect from a bus log instead of traces;" << std::endl;
+    std::cout << "    -s/-E/-b default to the logged run's, the interconnect and DRAM options apply" << std::endl;
+    std::cout << "--timeline <file>: Write a Chrome trace-event JSON timeline of core stalls and bus transactions" << std::endl;
+    std::cout << "--timeline-window <start:end>: Record the timeline for these cycles only (end optional)" << std::endl;
+    std::cout << "--timeline-sample <period,length>: Record length cycles of every period" << std::endl;
+    std::cout << "--intervals <file>: Write per-core and interconnect counts for every interval as CSV" << std::endl;
+    std::cout << "--interval <n>: Interval length in cycles (default: 100000)" << std::endl;
+    std::cout << "--interval-instructions <n>: End an interval every n instructions over all cores instead" << std::endl;
+    std::cout << "--latency-histograms: Report queueing, service and end-to-end latency percentiles" << std::endl;
+    std::cout << "                      per core and per request type" << std::endl;
+    std::cout << "--stall-breakdown: Attribute each core's idle cycles to a stall cause (CPI stack)" << std::endl;
+    std::cout << "--classify-misses: Split each core's misses into compulsory, capacity, conflict," << std::endl;
+    std::cout << "                   true sharing and false sharing" << std::endl;
+    std::cout << "--hot-lines <n>: Report the n lines with the most invalidations, misses and cache-to-cache" << std::endl;
+    std::cout << "                 transfers, flagging false sharing candidates" << std::endl;
+    std::cout << "--interaction-matrix: Report, per pair of cores, the invalidations and cache-to-cache" << std::endl;
+    std::cout << "                      transfers one core's requests caused at the other" << std::endl;
+    std::cout << "--threads <n>: Run cores on n worker threads (default: serial loop)" << std::endl;
+    std::cout << "--quantum <q>: Cycles cores run between bus syncs; 1 is bit-exact with serial, larger values"
+              << " see other cores' snoops up to q cycles late (default: 1)" << std::endl;
+    std::cout << "--bus-slices <n>: Number of address-interleaved bus slices, at most " << Bus::maxSlices
+              << " (default: 1)" << std::endl;
+    std::cout << "--slice-hash <mod|xor>: Block address to bus slice hash (default: mod)" << std::endl;
+    std::cout << "--coalesce: Merge bus reads of a block that is already being read" << std::endl;
+    std::cout << "--fill-memory <full|early|cwf>: Miss restart for blocks from memory (default: full)" << std::endl;
+    std::cout << "--fill-cache <full|early|cwf>: Miss restart for cache-to-cache transfers (default: full)" << std::endl;
+    std::cout << "--interconnect <bus|ring|mesh>: Coherence fabric (default: bus)" << std::endl;
+    std::cout << "--mesh-width <n>: Mesh columns (default: ceil(sqrt(cores)))" << std::endl;
+    std::cout << "--mem-controllers <n>: Memory controllers on the ring/mesh (default: 1)" << std::endl;
+    std::cout << "--hop-latency <n>: Router + link cycles per hop (default: 2)" << std::endl;
+    std::cout << "--link-width <n>: Link width in bytes per cycle (default: 16)" << std::endl;
+    std::cout << "--dram: Model banked DRAM instead of a fixed 100-cycle memory" << std::endl;
+    std::cout << "--dram-org <channels,ranks,banks>: DRAM organization (default: 1,1,8)" << std::endl;
+    std::cout << "--dram-row-size <bytes>: DRAM row buffer size (default: 2048)" << std::endl;
+    std::cout << "--dram-page <open|closed>: Row buffer policy (default: open)" << std::endl;
+    std::cout << "--dram-sched <fcfs|frfcfs>: Memory scheduling policy (default: frfcfs)" << std::endl;
+    std::cout << "--dram-timing <tRCD,tCAS,tRP,tBurst>: DRAM timing in cycles (default: 30,30,30,8)" << std::endl;
+    std::cout << "-d, --debug: Enable debug output (trace events as text on stdout)" << std::endl;
+    std::cout << "--trace-out <file>: Write the debug trace to a binary file instead (implies -d; see L1tracedecode)" << std::endl;
+    std::cout << "--trace-categories <list>: Trace only these of coherence,bus,core,lru (default: all)" << std::endl;
     std::cout << "-h, --help: Print this help message" << std::endl;
 }
 
+// Tables (sweeps, miss-ratio curves) are JSON with --format json, or with the default format
+// if the output file name ends in .json; CSV otherwise
+static bool isJsonOutput(OutputFormat format, const std::string& outfile) {
+    bool jsonName = outfile.size() >= 5 && outfile.compare(outfile.size() - 5, 5, ".json") == 0;
+    return format == OutputFormat::Json || (format == OutputFormat::Text && jsonName);
+}
+
+// The stream a mode writes its results to: stdout, or outfile when one is given.
+// Returns nullptr, after printing an error, if the file cannot be opened.
+static std::ostream* openOutput(const std::string& outfile, std::ofstream& file) {
+    if (outfile.empty()) {
+        return &std::cout;
+    }
+    file.open(outfile);
+    if (!file.is_open()) {
+        std::cerr << "Error opening output file: " << outfile << std::endl;
+        return nullptr;
+    }
+    return &file;
+}
+
+// Call fn(core) for every core on up to jobs worker threads, each thread taking every
+// threads-th core; returns the number of threads used
+template <typename Function>
+static int forEachTrace(int numCores, int jobs, const Function& fn) {
+    int threads = std::max(1, std::min(jobs, numCores));
+    std::vector<std::thread> workers;
+    for (int worker = 0; worker < threads; worker++) {
+        workers.emplace_back([&, worker]() {
+            for (int core = worker; core < numCores; core += threads) {
+                fn(core);
+            }
+        });
+    }
+    for (std::thread& thread : workers) {
+        thread.join();
+    }
+    return threads;
+}
+
+// Replay mode: re-drive the caches and interconnect from a bus log (see BusReplay)
+static int runReplay(const std::string& logFile, const SimulatorConfig& config, int s, int E, int b,
+                     const std::string& outfile) {
+    BusReplay replay(logFile, config, s, E, b);
+    replay.run();
+    
+    Tracer::flush();
+    std::ofstream file;
+    std::ostream* output = openOutput(outfile, file);
+    if (output == nullptr) {
+        return 1;
+    }
+    if (config.outputFormat == OutputFormat::Json) {
+        replay.writeJson(*output);
+    } else if (config.outputFormat == OutputFormat::Csv) {
+        replay.writeCsv(*output);
+    } else {
+        replay.printReport(*output);
+    }
+    return 0;
+}
+
+// Parse a miss restart policy name; returns false if the name is unknown
+static bool parseFillPolicy(const std::string& name, FillPolicy& policy) {
+    if (name == "full") {
+        policy = FillPolicy::Full;
+    } else if (name == "early") {
+        policy = FillPolicy::EarlyRestart;
+    } else if (name == "cwf") {
+        policy = FillPolicy::CriticalWordFirst;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// Parse a sweep parameter: a single value, a list ("4,5,6") or an inclusive range ("4:8", "1:16:2")
+static std::vector<int> parseSweepValues(const std::string& text) {
+    std::vector<int> values;
+    size_t colon = text.find(':');
+    if (colon == std::string::npos) {
+        std::stringstream stream(text);
+        std::string item;
+        while (std::getline(stream, item, ',')) {
+            values.push_back(std::stoi(item));
+        }
+        return values;
+    }
+    
+    int first = std::stoi(text.substr(0, colon));
+    size_t secondColon = text.find(':', colon + 1);
+    int last = std::stoi(text.substr(colon + 1, secondColon == std::string::npos ? std::string::npos : secondColon - colon - 1));
+    int step = secondColon == std::string::npos ? 1 : std::stoi(text.substr(secondColon + 1));
+    if (step <= 0) {
+        throw std::invalid_argument("range step must be positive");
+    }
+    for (int value = first; value <= last; value += step) {
+        values.push_back(value);
+    }
+    return values;
+}
+
+// Sweep mode: decode the traces once and simulate every (s, E, b) combination in parallel.
+// With functional set, all combinations run in lockstep in one pass of the tag-only model.
+static int runSweep(const std::string& tracePrefix, const std::vector<int>& sValues, const std::vector<int>& EValues,
+                    const std::vector<int>& bValues, const SimulatorConfig& config, int jobs,
+                    bool functional, InterleavePolicy interleave, const std::string& outfile) {
+    std::vector<SweepPoint> points;
+    for (int s : sValues) {
+        for (int E : EValues) {
+            for (int b : bValues) {
+                SweepPoint point = {s, E, b};
+                points.push_back(point);
+            }
+        }
+    }
+    
+    SweepRunner sweep(tracePrefix, config, jobs);
+    
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    uint64_t records = sweep.loadTraces();
+    double decodeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    std::unique_ptr<FunctionalSimulator> functionalSimulator;
+    start = std::chrono::steady_clock::now();
+    if (functional) {
+        functionalSimulator.reset(new FunctionalSimulator(sweep.getTraces(), points, jobs, interleave));
+        functionalSimulator->run();
+    } else {
+        sweep.run(points);
+    }
+    double sweepSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    bool json = isJsonOutput(config.outputFormat, outfile);
+    std::ofstream file;
+    std::ostream* output = openOutput(outfile, file);
+    if (output == nullptr) {
+        return 1;
+    }
+    std::ostream& out = *output;
+    if (functional) {
+        if (json) {
+            functionalSimulator->writeJson(out, tracePrefix);
+        } else {
+            functionalSimulator->writeCsv(out);
+        }
+    } else if (json) {
+        sweep.writeJson(out);
+    } else {
+        sweep.writeCsv(out);
+    }
+    
+    std::cerr << "Sweep: decoded " << records << " trace records from " << sweep.getNumCores() << " cores in "
+              << decodeSeconds << " s; simulated " << points.size() << (functional ? " functional" : "")
+              << " configurations on " << sweep.getJobs() << " threads in " << sweepSeconds << " s";
+    if (functional && sweepSeconds > 0.0) {
+        std::cerr << " (" << std::fixed << std::setprecision(1)
+                  << (records * points.size() / sweepSeconds / 1e6) << "M accesses/s)";
+    }
+    std::cerr << std::endl;
+    return 0;
+}
+
+// Functional mode: one configuration on the tag-only model, no timing
+static int runFunctional(const std::string& tracePrefix, int numCores, int s, int E, int b,
+                         InterleavePolicy interleave, OutputFormat format, const std::string& outfile) {
+    if (numCores == 0) {
+        numCores = Simulator::detectCoreCount(tracePrefix);
+    }
+    if (numCores == 0) {
+        throw std::runtime_error("no trace files found (expected " + tracePrefix + "_proc0.trace)");
+    }
+    
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::vector<std::shared_ptr<const DecodedTrace>> traces = TraceReader::decodeTraces(tracePrefix, numCores, numCores);
+    double decodeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    SweepPoint point = {s, E, b};
+    FunctionalSimulator simulator(traces, std::vector<SweepPoint>(1, point), 1, interleave);
+    start = std::chrono::steady_clock::now();
+    simulator.run();
+    double runSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    std::ofstream file;
+    std::ostream* output = openOutput(outfile, file);
+    if (output == nullptr) {
+        return 1;
+    }
+    if (format == OutputFormat::Json) {
+        simulator.writeJson(*output, tracePrefix);
+    } else if (format == OutputFormat::Csv) {
+        simulator.writeCsv(*output);
+    } else {
+        simulator.printReport(*output, tracePrefix, decodeSeconds, runSeconds);
+    }
+    return 0;
+}
+
+// Stack-distance mode: exact LRU miss-ratio curves of every core's trace, one core per thread
+static int runMissRatioCurves(const std::string& tracePrefix, int numCores, int s, int E, int b, int jobs,
+                              OutputFormat format, const std::string& outfile) {
+    if (numCores == 0) {
+        numCores = Simulator::detectCoreCount(tracePrefix);
+    }
+    if (numCores == 0) {
+        throw std::runtime_error("no trace files found (expected " + tracePrefix + "_proc0.trace)");
+    }
+    
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::vector<std::shared_ptr<const DecodedTrace>> traces = TraceReader::decodeTraces(tracePrefix, numCores, jobs);
+    double decodeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    start = std::chrono::steady_clock::now();
+    std::vector<StackDistanceProfiler> profilers(numCores, StackDistanceProfiler(b, s, E));
+    int threads = forEachTrace(numCores, jobs, [&](int core) {
+        profilers[core].profile(*traces[core]);
+    });
+    double profileSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    bool json = isJsonOutput(format, outfile);
+    std::ofstream file;
+    std::ostream* output = openOutput(outfile, file);
+    if (output == nullptr) {
+        return 1;
+    }
+    std::ostream& out = *output;
+    uint64_t records = 0;
+    if (json) {
+        out << "{" << std::endl;
+        out << "  \"trace\": \"" << tracePrefix << "\"," << std::endl;
+        out << "  \"block_bytes\": " << (1ULL << b) << "," << std::endl;
+        out << "  \"cores\": [" << std::endl;
+    } else {
+        out << "core,organization,sets,ways,capacity_lines,capacity_bytes,accesses,misses,miss_ratio" << std::endl;
+    }
+    for (int core = 0; core < numCores; core++) {
+        records += profilers[core].getAccesses();
+        if (json) {
+            profilers[core].writeJson(out, core);
+            out << (core + 1 < numCores ? "," : "") << std::endl;
+        } else {
+            profilers[core].writeCsvRows(out, core);
+        }
+    }
+    if (json) {
+        out << "  ]" << std::endl;
+        out << "}" << std::endl;
+    }
+    
+    std::cerr << "Stack distance: decoded " << records << " trace records from " << numCores << " cores in "
+              << decodeSeconds << " s; profiled in " << profileSeconds << " s on " << threads << " threads"
+              << std::endl;
+    return 0;
+}
+
+// Sampled stack-distance mode (SHARDS): fully-associative miss-ratio curves with a standard
+// error, optionally checked against the exact profiler
+static int runSampledMissRatioCurves(const std::string& tracePrefix, int numCores, int b, int jobs,
+                                     double rate, size_t maxBlocks, bool validate, OutputFormat format,
+                                     const std::string& outfile) {
+    if (numCores == 0) {
+        numCores = Simulator::detectCoreCount(tracePrefix);
+    }
+    if (numCores == 0) {
+        throw std::runtime_error("no trace files found (expected " + tracePrefix + "_proc0.trace)");
+    }
+    
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::vector<std::shared_ptr<const DecodedTrace>> traces = TraceReader::decodeTraces(tracePrefix, numCores, jobs);
+    double decodeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    start = std::chrono::steady_clock::now();
+    std::vector<ShardsProfiler> profilers(numCores, ShardsProfiler(b, rate, maxBlocks));
+    int threads = forEachTrace(numCores, jobs, [&](int core) {
+        profilers[core].profile(*traces[core]);
+    });
+    double profileSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    // Exact curves for validation (set-associative part unused)
+    std::vector<StackDistanceProfiler> exact;
+    if (validate) {
+        exact.assign(numCores, StackDistanceProfiler(b, 0, 1));
+        forEachTrace(numCores, jobs, [&](int core) {
+            exact[core].profile(*traces[core]);
+        });
+    }
+    
+    std::ofstream file;
+    std::ostream* output = openOutput(outfile, file);
+    if (output == nullptr) {
+        return 1;
+    }
+    std::ostream& out = *output;
+    bool json = isJsonOutput(format, outfile);
+    if (json) {
+        out << "{" << std::endl;
+        out << "  \"trace\": \"" << tracePrefix << "\"," << std::endl;
+        out << "  \"block_bytes\": " << (1ULL << b) << "," << std::endl;
+        out << "  \"columns\": [\"capacity_lines\", \"miss_ratio\", \"std_error\""
+            << (validate ? ", \"exact_miss_ratio\"" : "") << "]," << std::endl;
+        out << "  \"cores\": [" << std::endl;
+    } else {
+        out << "core,capacity_lines,capacity_bytes,miss_ratio,std_error" << (validate ? ",exact_miss_ratio" : "") << std::endl;
+    }
+    
+    std::cerr << "SHARDS: decoded " << numCores << " cores in " << decodeSeconds << " s; profiled in "
+              << profileSeconds << " s on " << threads << " threads" << std::endl;
+    for (int core = 0; core < numCores; core++) {
+        const ShardsProfiler& profiler = profilers[core];
+        const std::vector<uint64_t>& capacities = profiler.getCapacities();
+        double absoluteError = 0.0;
+        double maxError = 0.0;
+        double standardError = 0.0;
+        size_t points = 0;
+        if (json) {
+            out << "    {\"core\": " << core << ", \"accesses\": " << profiler.getAccesses()
+                << ", \"sampled_references\": " << profiler.getSample().getSampledReferences()
+                << ", \"rate\": " << std::defaultfloat << profiler.getSample().getRate() << "," << std::endl;
+            out << "     \"curve\": [";
+        }
+        for (size_t i = 0; i < capacities.size(); i++) {
+            double missRatio = profiler.getMissRatio(i);
+            if (json) {
+                out << (i > 0 ? ", " : "") << "[" << capacities[i] << ", "
+                    << std::fixed << std::setprecision(6) << missRatio << ", " << profiler.getStandardError(i);
+            } else {
+                out << core << "," << capacities[i] << "," << (capacities[i] << b) << ","
+                    << std::fixed << std::setprecision(6) << missRatio << "," << profiler.getStandardError(i);
+            }
+            // Distances below 1/R lines are not resolved by the sample, so only larger
+            // capacities enter the summary
+            bool resolved = capacities[i] * profiler.getSample().getRate() >= 1.0;
+            if (validate) {
+                double exactRatio = static_cast<double>(exact[core].getFullyAssociativeMisses(capacities[i])) /
+                                    std::max<uint64_t>(1, exact[core].getAccesses());
+                out << (json ? ", " : ",") << exactRatio;
+                if (resolved) {
+                    absoluteError += std::fabs(missRatio - exactRatio);
+                    maxError = std::max(maxError, std::fabs(missRatio - exactRatio));
+                }
+            }
+            if (json) {
+                out << "]";
+            } else {
+                out << std::endl;
+            }
+            if (resolved) {
+                standardError += profiler.getStandardError(i);
+                points++;
+            }
+            // Beyond twice the estimated distinct blocks the curve is flat at the cold-miss ratio
+            if (capacities[i] > 2 * profiler.getSample().getEstimatedBlocks()) {
+                break;
+            }
+        }
+        if (json) {
+            out << "]}" << (core + 1 < numCores ? "," : "") << std::endl;
+        }
+        
+        std::cerr << "Core " << core << ": " << profiler.getAccesses() << " references, "
+                  << profiler.getSample().getSampledReferences() << " sampled, final rate "
+                  << std::setprecision(6) << profiler.getSample().getRate() << ", "
+                  << profiler.getSample().getSampledBlocks() << " sampled blocks; from "
+                  << static_cast<uint64_t>(std::ceil(1.0 / profiler.getSample().getRate())) << " lines: mean standard error "
+                  << (points > 0 ? standardError / points : 0.0);
+        if (validate) {
+            std::cerr << ", mean absolute error vs exact " << (points > 0 ? absoluteError / points : 0.0)
+                      << " (max " << maxError << ")";
+        }
+        std::cerr << std::endl;
+    }
+    if (json) {
+        out << "  ]" << std::endl;
+        out << "}" << std::endl;
+    }
+    return 0;
+}
+
+// Parse a comma-separated list of integers ("1,2,8")
+static std::vector<int> parseIntList(const std::string& text) {
+    std::vector<int> values;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        values.push_back(std::stoi(item));
+    }
+    return values;
+}
+
+// Parse two cycle counts separated by separator ("1000:5000"); the second may be empty
+static bool parseCyclePair(const std::string& text, char separator, cycle_t& first, cycle_t& second) {
+    size_t split = text.find(separator);
+    if (split == std::string::npos || split == 0) {
+        return false;
+    }
+    first = std::stoull(text.substr(0, split));
+    second = split + 1 < text.size() ? std::stoull(text.substr(split + 1)) : 0;
+    return true;
+}
+
 int main(int argc, char* argv[]) {
     // Default parameters
     std::string tracePrefix = "";
@@ -24,6 +500,27 @@ int main(int argc, char* argv[]) {
     int b = 6;          // Block offset bits: default 6 -> 64 byte blocks
     std::string outfile = "";
     bool debug = false;  // Debug output: default disabled
+    std::string traceFile;      // Binary trace output (empty = text on stdout)
+    unsigned traceCategories = 0xf;
+    bool traceCategoriesSet = false;
+    SimulatorConfig config;
+    bool sweep = false;
+    bool functional = false;
+    InterleavePolicy interleave = InterleavePolicy::RoundRobin;
+    bool interleaveSet = false;
+    int setSampleRatio = 1;     // Simulate one set in every setSampleRatio
+    bool checkpointAtSet = false;
+    std::string replayFile;     // Bus log to replay (empty = run the traces)
+    bool intervalSet = false;   // --interval or --interval-instructions given
+    bool organizationSet[3] = {false, false, false}; // -s, -E, -b given
+    bool stackDistance = false;
+    double shardsRate = 0.0;
+    long long shardsSize = 0;
+    bool shardsValidate = false;
+    int jobs = static_cast<int>(std::thread::hardware_concurrency());
+    std::vector<int> sValues(1, s);
+    std::vector<int> EValues(1, E);
+    std::vector<int> bValues(1, b);
     
     // Parse command line arguments
     for (int i = 1; i < argc; i++) {
@@ -36,23 +533,37 @@ int main(int argc, char* argv[]) {
                 std::cerr << "Error: -t requires a trace name argument" << std::endl;
                 return 1;
             }
+        } else if (arg == "-n") {
+            if (i + 1 < argc) {
+                config.numCores = std::stoi(argv[++i]);
+                if (config.numCores <= 0) {
+                    std::cerr << "Error: -n must be a positive integer." << std::endl;
+                    return 1;
+                }
+            } else {
+                std::cerr << "Error: -n requires a core count argument" << std::endl;
+                return 1;
+            }
         } else if (arg == "-s") {
             if (i + 1 < argc) {
-                s = std::stoi(argv[++i]);
+                sValues = parseSweepValues(argv[++i]);
+                organizationSet[0] = true;
             } else {
                 std::cerr << "Error: -s requires a set index bits argument" << std::endl;
                 return 1;
             }
         } else if (arg == "-E") {
             if (i + 1 < argc) {
-                E = std::stoi(argv[++i]);
+                EValues = parseSweepValues(argv[++i]);
+                organizationSet[1] = true;
             } else {
                 std::cerr << "Error: -E requires an associativity argument" << std::endl;
                 return 1;
             }
         } else if (arg == "-b") {
             if (i + 1 < argc) {
-                b = std::stoi(argv[++i]);
+                bValues = parseSweepValues(argv[++i]);
+                organizationSet[2] = true;
             } else {
                 std::cerr << "Error: -b requires a block bits argument" << std::endl;
                 return 1;
@@ -64,8 +575,372 @@ int main(int argc, char* argv[]) {
                 std::cerr << "Error: -o requires an output file name argument" << std::endl;
                 return 1;
             }
+        } else if (arg == "--bus-slices") {
+            if (i + 1 < argc) {
+                std::string value = argv[++i];
+                size_t parsed = 0;
+                try {
+                    config.busSlices = std::stoi(value, &parsed);
+                } catch (const std::exception&) {
+                    parsed = 0;
+                }
+                if (parsed == 0 || parsed != value.size()) {
+                    std::cerr << "Error: --bus-slices expects an integer, got '" << value << "'" << std::endl;
+                    return 1;
+                }
+            } else {
+                std::cerr << "Error: --bus-slices requires a slice count argument" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--slice-hash") {
+            if (i + 1 < argc) {
+                std::string hash = argv[++i];
+                if (hash == "mod") {
+                    config.sliceHash = SliceHashFunction::Modulo;
+                } else if (hash == "xor") {
+                    config.sliceHash = SliceHashFunction::XorFold;
+                } else {
+                    std::cerr << "Error: --slice-hash must be 'mod' or 'xor'" << std::endl;
+                    return 1;
+                }
+            } else {
+                std::cerr << "Error: --slice-hash requires a hash name argument" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--sweep") {
+            sweep = true;
+        } else if (arg == "--functional") {
+            functional = true;
+        } else if (arg == "--interleave") {
+            if (i + 1 < argc) {
+                std::string policy = argv[++i];
+                interleaveSet = true;
+                if (policy == "rr" || policy == "round-robin") {
+                    interleave = InterleavePolicy::RoundRobin;
+                } else if (policy == "proportional") {
+                    interleave = InterleavePolicy::Proportional;
+                } else {
+                    std::cerr << "Error: --interleave must be 'rr' or 'proportional'" << std::endl;
+                    return 1;
+                }
+            } else {
+                std::cerr << "Error: --interleave requires a policy argument" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--mrc") {
+            stackDistance = true;
+        } else if (arg == "--shards-rate") {
+            if (i + 1 < argc) {
+                shardsRate = std::stod(argv[++i]);
+            } else {
+                std::cerr << "Error: --shards-rate requires a sampling rate argument" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--shards-size") {
+            if (i + 1 < argc) {
+                shardsSize = std::stoll(argv[++i]);
+            } else {
+                std::cerr << "Error: --shards-size requires a block count argument" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--shards-validate") {
+            shardsValidate = true;
+        } else if (arg == "--jobs") {
+            if (i + 1 < argc) {
+                jobs = std::stoi(argv[++i]);
+            } else {
+                std::cerr << "Error: --jobs requires a thread count argument" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--sample") {
+            if (i + 1 < argc) {
+                std::vector<int> sampling = parseIntList(argv[++i]);
+                if (sampling.size() != 3 || sampling[0] <= 0 || sampling[1] < 0 || sampling[2] <= 0) {
+                    std::cerr << "Error: --sample expects interval,warmup,window (e.g. 100000,2000,1000)" << std::endl;
+                    return 1;
+                }
+                config.sampling.interval = sampling[0];
+                config.sampling.warmup = sampling[1];
+                config.sampling.window = sampling[2];
+            } else {
+                std::cerr << "Error: --sample requires an interval,warmup,window argument" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--set-sample") {
+            if (i + 1 < argc) {
+                setSampleRatio = std::stoi(argv[++i]);
+            } else {
+                std::cerr << "Error: --set-sample requires a set ratio argument" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--max-cycles") {
+            if (i + 1 < argc) {
+                config.maxCycles = std::stoull(argv[++i]);
+            } else {
+                std::cerr << "Error: --max-cycles requires a cycle count argument" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--checkpoint") {
+            if (i + 1 < argc) {
+                config.checkpointFile = argv[++i];
+            } else {
+                std::cerr << "Error: --checkpoint requires a file argument" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--checkpoint-at") {
+            if (i + 1 < argc) {
+                config.checkpointCycle = std::stoull(argv[++i]);
+                checkpointAtSet = true;
+            } else {
+                std::cerr << "Error: --checkpoint-at requires a cycle argument" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--restore") {
+            if (i + 1 < argc) {
+                config.restoreFile = argv[++i];
+            } else {
+                std::cerr << "Error: --restore requires a checkpoint file argument" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--bus-log") {
+            if (i + 1 < argc) {
+                config.busLogFile = argv[++i];
+            } else {
+                std::cerr << "Error: --bus-log requires a file argument" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--timeline") {
+            if (i + 1 < argc) {
+                config.timelineFile = argv[++i];
+            } else {
+                std::cerr << "Error: --timeline requires a file argument" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--timeline-window") {
+            if (i + 1 >= argc || !parseCyclePair(argv[++i], ':', config.timelineStart, config.timelineEnd) ||
+                (config.timelineEnd > 0 && config.timelineEnd <= config.timelineStart)) {
+                std::cerr << "Error: --timeline-window expects start:end cycles (e.g. 1000000:2000000)" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--timeline-sample") {
+            if (i + 1 >= argc || !parseCyclePair(argv[++i], ',', config.timelinePeriod, config.timelineLength) ||
+                config.timelineLength == 0 || config.timelineLength > config.timelinePeriod) {
+                std::cerr << "Error: --timeline-sample expects period,length cycles with 0 < length <= period" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--format") {
+            if (i + 1 >= argc || !parseOutputFormat(argv[++i], config.outputFormat)) {
+                std::cerr << "Error: --format expects text, json or csv" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--intervals") {
+            if (i + 1 < argc) {
+                config.intervalFile = argv[++i];
+            } else {
+                std::cerr << "Error: --intervals requires a file argument" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--interval") {
+            if (i + 1 < argc) {
+                config.intervalCycles = std::stoull(argv[++i]);
+                intervalSet = true;
+            } else {
+                std::cerr << "Error: --interval requires a cycle count argument" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--interval-instructions") {
+            if (i + 1 < argc) {
+                config.intervalInstructions = std::stoull(argv[++i]);
+                intervalSet = true;
+            } else {
+                std::cerr << "Error: --interval-instructions requires an instruction count argument" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--latency-histograms") {
+            config.latencyHistograms = true;
+        } else if (arg == "--stall-breakdown") {
+            config.stallBreakdown = true;
+        } else if (arg == "--classify-misses") {
+            config.classifyMisses = true;
+        } else if (arg == "--interaction-matrix") {
+            config.interactionMatrix = true;
+        } else if (arg == "--hot-lines") {
+            if (i + 1 >= argc || (config.hotLines = std::stoi(argv[++i])) <= 0) {
+                std::cerr << "Error: --hot-lines requires a positive line count" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--replay") {
+            if (i + 1 < argc) {
+                replayFile = argv[++i];
+            } else {
+                std::cerr << "Error: --replay requires a bus log file argument" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--threads") {
+            if (i + 1 < argc) {
+                config.threads = std::stoi(argv[++i]);
+            } else {
+                std::cerr << "Error: --threads requires a thread count argument" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--quantum") {
+            if (i + 1 < argc) {
+                config.quantum = std::stoi(argv[++i]);
+            } else {
+                std::cerr << "Error: --quantum requires a cycle count argument" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--coalesce") {
+            config.coalesceReads = true;
+        } else if (arg == "--fill-memory" || arg == "--fill-cache") {
+            if (i + 1 < argc) {
+                FillPolicy& policy = (arg == "--fill-memory") ? config.memoryFillPolicy : config.cacheFillPolicy;
+                if (!parseFillPolicy(argv[++i], policy)) {
+                    std::cerr << "Error: " << arg << " must be 'full', 'early' or 'cwf'" << std::endl;
+                    return 1;
+                }
+            } else {
+                std::cerr << "Error: " << arg << " requires a policy argument" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--interconnect") {
+            if (i + 1 < argc) {
+                std::string kind = argv[++i];
+                if (kind == "bus") {
+                    config.interconnect = InterconnectType::Bus;
+                } else if (kind == "ring") {
+                    config.interconnect = InterconnectType::Network;
+                    config.network.topology = NetworkTopology::Ring;
+                } else if (kind == "mesh") {
+                    config.interconnect = InterconnectType::Network;
+                    config.network.topology = NetworkTopology::Mesh;
+                } else {
+                    std::cerr << "Error: --interconnect must be 'bus', 'ring' or 'mesh'" << std::endl;
+                    return 1;
+                }
+            } else {
+                std::cerr << "Error: --interconnect requires a topology argument" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--mesh-width") {
+            if (i + 1 < argc) {
+                config.network.meshWidth = std::stoi(argv[++i]);
+            } else {
+                std::cerr << "Error: --mesh-width requires a column count argument" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--mem-controllers") {
+            if (i + 1 < argc) {
+                config.network.memoryControllers = std::stoi(argv[++i]);
+            } else {
+                std::cerr << "Error: --mem-controllers requires a controller count argument" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--hop-latency") {
+            if (i + 1 < argc) {
+                config.network.hopLatency = std::stoi(argv[++i]);
+            } else {
+                std::cerr << "Error: --hop-latency requires a cycle count argument" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--link-width") {
+            if (i + 1 < argc) {
+                config.network.linkWidthBytes = std::stoi(argv[++i]);
+            } else {
+                std::cerr << "Error: --link-width requires a byte count argument" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--dram") {
+            config.dramModel = true;
+        } else if (arg == "--dram-org") {
+            if (i + 1 < argc) {
+                std::vector<int> org = parseIntList(argv[++i]);
+                if (org.size() != 3) {
+                    std::cerr << "Error: --dram-org expects <channels,ranks,banks>" << std::endl;
+                    return 1;
+                }
+                config.dramModel = true;
+                config.dram.channels = org[0];
+                config.dram.ranks = org[1];
+                config.dram.banksPerRank = org[2];
+            } else {
+                std::cerr << "Error: --dram-org requires an organization argument" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--dram-row-size") {
+            if (i + 1 < argc) {
+                config.dramModel = true;
+                config.dram.rowSizeBytes = std::stoi(argv[++i]);
+            } else {
+                std::cerr << "Error: --dram-row-size requires a byte count argument" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--dram-page") {
+            if (i + 1 < argc) {
+                std::string policy = argv[++i];
+                config.dramModel = true;
+                if (policy == "open") {
+                    config.dram.rowPolicy = RowBufferPolicy::Open;
+                } else if (policy == "closed") {
+                    config.dram.rowPolicy = RowBufferPolicy::Closed;
+                } else {
+                    std::cerr << "Error: --dram-page must be 'open' or 'closed'" << std::endl;
+                    return 1;
+                }
+            } else {
+                std::cerr << "Error: --dram-page requires a policy argument" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--dram-sched") {
+            if (i + 1 < argc) {
+                std::string policy = argv[++i];
+                config.dramModel = true;
+                if (policy == "fcfs") {
+                    config.dram.scheduling = MemorySchedulingPolicy::FCFS;
+                } else if (policy == "frfcfs") {
+                    config.dram.scheduling = MemorySchedulingPolicy::FRFCFS;
+                } else {
+                    std::cerr << "Error: --dram-sched must be 'fcfs' or 'frfcfs'" << std::endl;
+                    return 1;
+                }
+            } else {
+                std::cerr << "Error: --dram-sched requires a policy argument" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--dram-timing") {
+            if (i + 1 < argc) {
+                std::vector<int> timing = parseIntList(argv[++i]);
+                if (timing.size() != 4) {
+                    std::cerr << "Error: --dram-timing expects <tRCD,tCAS,tRP,tBurst>" << std::endl;
+                    return 1;
+                }
+                config.dramModel = true;
+                config.dram.tRCD = timing[0];
+                config.dram.tCAS = timing[1];
+                config.dram.tRP = timing[2];
+                config.dram.tBurst = timing[3];
+            } else {
+                std::cerr << "Error: --dram-timing requires a timing argument" << std::endl;
+                return 1;
+            }
         } else if (arg == "-d" || arg == "--debug") {
             debug = true;
+        } else if (arg == "--trace-out") {
+            if (i + 1 < argc) {
+                traceFile = argv[++i];
+                debug = true;
+            } else {
+                std::cerr << "Error: --trace-out requires a file argument" << std::endl;
+                return 1;
+            }
+        } else if (arg == "--trace-categories") {
+            if (i + 1 < argc && Tracer::parseCategories(argv[i + 1], traceCategories)) {
+                i++;
+                traceCategoriesSet = true;
+            } else {
+                std::cerr << "Error: --trace-categories expects a list of coherence, bus, core, lru or all" << std::endl;
+                return 1;
+            }
         } else if (arg == "-h" || arg == "--help") {
             printUsage(argv[0]);
             return 0;
@@ -77,36 +952,254 @@ int main(int argc, char* argv[]) {
     }
     
     // Check required arguments
-    if (tracePrefix.empty()) {
+    if (tracePrefix.empty() && replayFile.empty()) {
         std::cerr << "Error: Trace file name (-t) is required" << std::endl;
         printUsage(argv[0]);
         return 1;
     }
     
     // Validate parameters
+    if (sValues.empty() || EValues.empty() || bValues.empty()) {
+        std::cerr << "Error: -s, -E and -b need at least one value." << std::endl;
+        return 1;
+    }
+    if (!sweep && (sValues.size() > 1 || EValues.size() > 1 || bValues.size() > 1)) {
+        std::cerr << "Error: lists and ranges of -s/-E/-b require --sweep." << std::endl;
+        return 1;
+    }
+    s = *std::min_element(sValues.begin(), sValues.end());
+    E = *std::min_element(EValues.begin(), EValues.end());
+    b = *std::min_element(bValues.begin(), bValues.end());
     if (s <= 0 || E <= 0 || b <= 0) {
         std::cerr << "Error: s, E, and b must be positive integers." << std::endl;
         return 1;
     }
+    if (traceCategoriesSet && !debug) {
+        std::cerr << "Error: --trace-categories requires -d or --trace-out." << std::endl;
+        return 1;
+    }
+    if (sweep && (config.threads > 0 || debug)) {
+        std::cerr << "Error: --sweep cannot be combined with --threads or -d." << std::endl;
+        return 1;
+    }
+    if (jobs <= 0) {
+        jobs = 1;
+    }
+    if (stackDistance && (sweep || config.threads > 0 || debug)) {
+        std::cerr << "Error: --mrc cannot be combined with --sweep, --threads or -d." << std::endl;
+        return 1;
+    }
+    bool sampledCurves = shardsRate > 0.0 || shardsSize > 0 || shardsValidate;
+    if (sampledCurves && !stackDistance) {
+        std::cerr << "Error: --shards-rate, --shards-size and --shards-validate require --mrc." << std::endl;
+        return 1;
+    }
+    if (shardsRate < 0.0 || shardsRate > 1.0 || shardsSize < 0 || (shardsRate > 0.0 && shardsSize > 0)) {
+        std::cerr << "Error: give either --shards-rate in (0, 1] or a positive --shards-size." << std::endl;
+        return 1;
+    }
+    if (sampledCurves && shardsRate == 0.0 && shardsSize == 0) {
+        shardsRate = 0.01;
+    }
+    if (functional && (stackDistance || config.threads > 0 || config.sampling.interval > 0 || debug)) {
+        std::cerr << "Error: --functional cannot be combined with --mrc, --threads, --sample or -d." << std::endl;
+        return 1;
+    }
+    if (interleaveSet && !functional) {
+        std::cerr << "Error: --interleave requires --functional." << std::endl;
+        return 1;
+    }
+    if (config.sampling.interval > 0 && (sweep || stackDistance || config.threads > 0)) {
+        std::cerr << "Error: --sample cannot be combined with --sweep, --mrc or --threads." << std::endl;
+        return 1;
+    }
+    if (config.sampling.warmup + config.sampling.window > config.sampling.interval) {
+        std::cerr << "Error: --sample warm-up and window must fit in the interval." << std::endl;
+        return 1;
+    }
+    if (setSampleRatio <= 0 || (setSampleRatio & (setSampleRatio - 1)) != 0 || setSampleRatio > (1 << s)) {
+        std::cerr << "Error: --set-sample must be a power of two no larger than the number of sets." << std::endl;
+        return 1;
+    }
+    while ((1 << config.setSampleBits) < setSampleRatio) {
+        config.setSampleBits++;
+    }
+    if (config.setSampleBits > 0 && (sweep || stackDistance || functional || config.sampling.interval > 0)) {
+        std::cerr << "Error: --set-sample cannot be combined with --sweep, --mrc, --functional or --sample." << std::endl;
+        return 1;
+    }
+    if (config.checkpointFile.empty() != !checkpointAtSet) {
+        std::cerr << "Error: --checkpoint and --checkpoint-at must be given together." << std::endl;
+        return 1;
+    }
+    bool checkpointing = !config.checkpointFile.empty() || !config.restoreFile.empty();
+    if (checkpointing && (sweep || stackDistance || functional || config.sampling.interval > 0)) {
+        std::cerr << "Error: --checkpoint and --restore cannot be combined with --sweep, --mrc, --functional or --sample." << std::endl;
+        return 1;
+    }
+    if (!config.checkpointFile.empty() && config.threads > 0) {
+        std::cerr << "Error: --checkpoint requires the serial engine (no --threads)." << std::endl;
+        return 1;
+    }
+    if (!config.busLogFile.empty() && (sweep || stackDistance || functional)) {
+        std::cerr << "Error: --bus-log cannot be combined with --sweep, --mrc or --functional." << std::endl;
+        return 1;
+    }
+    if (config.latencyHistograms && (sweep || stackDistance || functional || !replayFile.empty() ||
+                                     !config.restoreFile.empty())) {
+        std::cerr << "Error: --latency-histograms cannot be combined with --sweep, --mrc, --functional, --replay or --restore."
+                  << std::endl;
+        return 1;
+    }
+    if (config.stallBreakdown && (sweep || stackDistance || functional || !replayFile.empty())) {
+        std::cerr << "Error: --stall-breakdown cannot be combined with --sweep, --mrc, --functional or --replay."
+                  << std::endl;
+        return 1;
+    }
+    if (config.classifyMisses && (sweep || stackDistance || functional || !replayFile.empty() ||
+                                  !config.restoreFile.empty())) {
+        std::cerr << "Error: --classify-misses cannot be combined with --sweep, --mrc, --functional, --replay or --restore."
+                  << std::endl;
+        return 1;
+    }
+    if (config.interactionMatrix && (sweep || stackDistance || functional || !replayFile.empty())) {
+        std::cerr << "Error: --interaction-matrix cannot be combined with --sweep, --mrc, --functional or --replay."
+                  << std::endl;
+        return 1;
+    }
+    if (config.hotLines > 0 && (sweep || stackDistance || functional || !replayFile.empty() ||
+                                !config.restoreFile.empty())) {
+        std::cerr << "Error: --hot-lines cannot be combined with --sweep, --mrc, --functional, --replay or --restore."
+                  << std::endl;
+        return 1;
+    }
+    if (config.intervalFile.empty() && intervalSet) {
+        std::cerr << "Error: --interval and --interval-instructions require --intervals." << std::endl;
+        return 1;
+    }
+    if (!config.intervalFile.empty()) {
+        if (config.intervalCycles > 0 && config.intervalInstructions > 0) {
+            std::cerr << "Error: use either --interval or --interval-instructions, not both." << std::endl;
+            return 1;
+        }
+        if (intervalSet && config.intervalCycles == 0 && config.intervalInstructions == 0) {
+            std::cerr << "Error: the interval length must be positive." << std::endl;
+            return 1;
+        }
+        if (config.intervalInstructions == 0 && config.intervalCycles == 0) {
+            config.intervalCycles = 100000;
+        }
+        if (sweep || stackDistance || functional || !replayFile.empty() || config.sampling.interval > 0) {
+            std::cerr << "Error: --intervals cannot be combined with --sweep, --mrc, --functional, --replay or --sample."
+                      << std::endl;
+            return 1;
+        }
+    }
+    bool timelineOptions = config.timelineStart > 0 || config.timelineEnd > 0 || config.timelinePeriod > 0;
+    if (config.timelineFile.empty() && timelineOptions) {
+        std::cerr << "Error: --timeline-window and --timeline-sample require --timeline." << std::endl;
+        return 1;
+    }
+    if (!config.timelineFile.empty() && (sweep || stackDistance || functional || !replayFile.empty() ||
+                                         config.sampling.interval > 0)) {
+        std::cerr << "Error: --timeline cannot be combined with --sweep, --mrc, --functional, --replay or --sample."
+                  << std::endl;
+        return 1;
+    }
+    if (!replayFile.empty() && (!tracePrefix.empty() || sweep || stackDistance || functional || checkpointing ||
+                                config.sampling.interval > 0 || config.setSampleBits > 0 || config.threads > 0)) {
+        std::cerr << "Error: --replay cannot be combined with -t, --sweep, --mrc, --functional, --sample, "
+                  << "--set-sample, --checkpoint, --restore or --threads." << std::endl;
+        return 1;
+    }
+    if (config.threads < 0 || config.quantum <= 0) {
+        std::cerr << "Error: --threads and --quantum must be positive integers." << std::endl;
+        return 1;
+    }
+    if (config.busSlices <= 0 || config.busSlices > Bus::maxSlices) {
+        std::cerr << "Error: --bus-slices must be between 1 and " << Bus::maxSlices << "." << std::endl;
+        return 1;
+    }
+    if (config.coalesceReads && config.interconnect != InterconnectType::Bus) {
+        std::cerr << "Error: --coalesce is only supported with the bus interconnect." << std::endl;
+        return 1;
+    }
+    if ((config.memoryFillPolicy != FillPolicy::Full || config.cacheFillPolicy != FillPolicy::Full) &&
+        config.interconnect != InterconnectType::Bus) {
+        std::cerr << "Error: --fill-memory and --fill-cache are only supported with the bus interconnect." << std::endl;
+        return 1;
+    }
+    if (config.network.meshWidth < 0 || config.network.memoryControllers <= 0 ||
+        config.network.hopLatency < 0 || config.network.linkWidthBytes <= 0) {
+        std::cerr << "Error: network parameters must be positive integers." << std::endl;
+        return 1;
+    }
+    if (config.dram.channels <= 0 || config.dram.ranks <= 0 || config.dram.banksPerRank <= 0 ||
+        config.dram.rowSizeBytes <= 0 || config.dram.tRCD < 0 || config.dram.tCAS < 0 ||
+        config.dram.tRP < 0 || config.dram.tBurst < 0) {
+        std::cerr << "Error: DRAM parameters must be positive integers." << std::endl;
+        return 1;
+    }
     
     try {
-        // Set debug mode
+        // Set debug mode; trace events go to stdout as text, or to the binary trace file
         Simulator::setDebugEnabled(debug);
+        if (debug && traceFile.empty()) {
+            Tracer::startText(std::cout, traceCategories);
+        } else if (debug && !Tracer::startBinary(traceFile, traceCategories)) {
+            std::cerr << "Error: cannot create trace file: " << traceFile << std::endl;
+            return 1;
+        }
+        if (debug && TRACE_LEVEL == 0) {
+            std::cerr << "WARNING: Tracing was compiled out (TRACE_LEVEL=0); -d only adds the debug summary." << std::endl;
+        }
+        
+        if (stackDistance && sampledCurves) {
+            return runSampledMissRatioCurves(tracePrefix, config.numCores, b, jobs, shardsRate,
+                                             static_cast<size_t>(shardsSize), shardsValidate, config.outputFormat,
+                                             outfile);
+        }
+        if (stackDistance) {
+            return runMissRatioCurves(tracePrefix, config.numCores, s, E, b, jobs, config.outputFormat, outfile);
+        }
+        if (sweep) {
+            return runSweep(tracePrefix, sValues, EValues, bValues, config, jobs, functional, interleave, outfile);
+        }
+        if (functional) {
+            return runFunctional(tracePrefix, config.numCores, s, E, b, interleave, config.outputFormat, outfile);
+        }
+        if (!replayFile.empty()) {
+            int status = runReplay(replayFile, config, organizationSet[0] ? s : 0, organizationSet[1] ? E : 0,
+                                   organizationSet[2] ? b : 0, outfile);
+            Tracer::stop();
+            return status;
+        }
         
         if (debug) {
             std::cout << "Debug mode enabled" << std::endl;
         }
         
+        // A sampled run is otherwise bound by parsing the trace text line by line,
+        // so its traces are decoded up front
+        if (config.sampling.interval > 0) {
+            int traceCores = config.numCores > 0 ? config.numCores : Simulator::detectCoreCount(tracePrefix);
+            if (traceCores > 0) {
+                config.traces = TraceReader::decodeTraces(tracePrefix, traceCores, jobs);
+            }
+        }
+        
         // Create simulator with the full trace path
-        Simulator simulator(tracePrefix, s, E, b);
+        Simulator simulator(tracePrefix, s, E, b, config);
         
         // Run simulation
         simulator.run();
         
         // Print statistics
         simulator.printStats(outfile);
+        Tracer::stop();
         
     } catch (const std::exception& e) {
+        Tracer::stop();
         std::cerr << "Error: " << e.what() << std::endl;
         return 1;
     }